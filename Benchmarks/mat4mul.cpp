@@ -0,0 +1,139 @@
+#include "Matrix4.h"
+#include "MathExpression.h"
+#include "MathDispatch.h"
+#include "MathKernels.h"
+#include "MathMemoryManager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Times Matrix4 multiplication on every math tier the CPU supports, in ns per multiply.
+//"kernel" calls the kernel of the tier directly on raw arrays, "Matrix4" is c = a * b with dispatch and element storage included,
+//"expr" is (Math::expr(a) * b).assignTo(c) of MathExpression.h.
+//Run a Release build, e.g. "mat4mul 2000000". MATH_FORCE_TIER can be set to check the tier picked at startup.
+
+typedef void(*Mat4MulFn)(const F32* a, const F32* b, F32* out);
+
+static const U32 matrixCount = 256;
+
+static F32 lhs[matrixCount * 16];
+static F32 rhs[matrixCount * 16];
+static F32 res[matrixCount * 16];
+
+static F64 nanosecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<F64, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//Multiplies every pair of lhs and rhs to res, rounds times over. Returns ns per multiply
+static F64 timeKernel(Mat4MulFn mul, U32 rounds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (U32 r = 0; r < rounds; ++r) {
+		for (U32 i = 0; i < matrixCount; ++i) mul(lhs + i * 16, rhs + i * 16, res + i * 16);
+	}
+
+	return nanosecondsSince(start) / (F64(rounds) * matrixCount);
+}
+
+//Same as timeKernel, but through Matrix4 and the kernels of the current tier
+static F64 timeMatrix4(const Matrix4* a, const Matrix4* b, Matrix4* c, U32 rounds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (U32 r = 0; r < rounds; ++r) {
+		for (U32 i = 0; i < matrixCount; ++i) c[i] = a[i] * b[i];
+	}
+
+	return nanosecondsSince(start) / (F64(rounds) * matrixCount);
+}
+
+//Same as timeMatrix4, but through an expression evaluated straight to c
+static F64 timeExpression(const Matrix4* a, const Matrix4* b, Matrix4* c, U32 rounds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (U32 r = 0; r < rounds; ++r) {
+		for (U32 i = 0; i < matrixCount; ++i) (Math::expr(a[i]) * b[i]).assignTo(c[i]);
+	}
+
+	return nanosecondsSince(start) / (F64(rounds) * matrixCount);
+}
+
+int main(int argc, char** argv)
+{
+	const U32 rounds = argc > 1 ? U32(atoi(argv[1])) / matrixCount + 1 : 4000;
+
+#ifdef MATH_CUSTOM_MEMORY
+	MathMemoryManager::init(4 * matrixCount, matrixCount, 0, 16);
+#endif
+
+	srand(1);
+	for (U32 i = 0; i < matrixCount * 16; ++i) {
+		lhs[i] = F32(rand()) / RAND_MAX - 0.5f;
+		rhs[i] = F32(rand()) / RAND_MAX - 0.5f;
+	}
+
+	using namespace Math::dispatch;
+
+	printf("Startup tier %s, detected %s, %u multiplies per run\n", tierName(tier()), tierName(detectedTier()), rounds * matrixCount);
+
+	const Mat4MulFn tierKernels[] = {
+		Math::kernels::mat4MulScalar,
+#ifdef MATH_SSE2
+		Math::kernels::mat4MulSSE2,
+		Math::kernels::mat4MulSSE2,
+		Math::kernels::mat4MulAVX2,
+		Math::kernels::mat4MulAVX512,
+#endif
+	};
+	const U32 tierCount = sizeof(tierKernels) / sizeof(tierKernels[0]);
+
+	F64 scalarNs = 0.0;
+	F32 checksum = 0.0f;
+
+	for (U32 t = 0; t < tierCount && Tier(t) <= detectedTier(); ++t) {
+		//SSE4.1 has no kernel of its own
+		if (Tier(t) == SSE41) continue;
+
+		setTier(Tier(t));
+
+		//Warm up caches and clocks before timing
+		timeKernel(tierKernels[t], rounds / 10 + 1);
+		const F64 kernelNs = timeKernel(tierKernels[t], rounds);
+		checksum += res[matrixCount * 16 - 1];
+
+		Matrix4* a = new Matrix4[matrixCount];
+		Matrix4* b = new Matrix4[matrixCount];
+		Matrix4* c = new Matrix4[matrixCount];
+		for (U32 i = 0; i < matrixCount; ++i) {
+			a[i] = Matrix4(lhs + i * 16);
+			b[i] = Matrix4(rhs + i * 16);
+		}
+
+		timeMatrix4(a, b, c, rounds / 10 + 1);
+		const F64 matrixNs = timeMatrix4(a, b, c, rounds);
+		checksum += c[0].getElement(0, 0);
+
+		timeExpression(a, b, c, rounds / 10 + 1);
+		const F64 expressionNs = timeExpression(a, b, c, rounds);
+		checksum += c[0].getElement(0, 0);
+		delete[] a;
+		delete[] b;
+		delete[] c;
+
+		if (t == 0) scalarNs = kernelNs;
+
+		printf("%-7s kernel %6.2f ns/op (%4.2fx scalar)   Matrix4 %6.2f ns/op   expr %6.2f ns/op\n", tierName(Tier(t)), kernelNs, scalarNs / kernelNs, matrixNs, expressionNs);
+	}
+
+	//Printed so the compiler cannot drop the multiplications
+	printf("checksum %g\n", checksum);
+
+#ifdef MATH_CUSTOM_MEMORY
+	MathMemoryManager::free();
+#endif
+
+	return 0;
+}
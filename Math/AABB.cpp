@@ -0,0 +1,49 @@
+#include "AABB.h"
+#include "BoundingSphere.h"
+#include "Affine3x4.h"
+#include "Matrix4.h"
+#include "MathKernels.h"
+#include <limits>
+
+AABB::AABB() : min(std::numeric_limits<F32>::infinity()), max(-std::numeric_limits<F32>::infinity())
+{
+
+}
+
+AABB::AABB(const Vector3* points, U32 count) : AABB()
+{
+	for (U32 i = 0; i < count; ++i) merge(points[i]);
+}
+
+AABB::AABB(const BoundingSphere& s) : AABB()
+{
+	if (s.isEmpty()) return;
+
+	min = s.center - Vector3(s.radius);
+	max = s.center + Vector3(s.radius);
+}
+
+bool AABB::contains(const AABB& b) const
+{
+	if (b.isEmpty()) return true;
+
+	return b.min.x >= min.x && b.max.x <= max.x && b.min.y >= min.y && b.max.y <= max.y && b.min.z >= min.z && b.max.z <= max.z;
+}
+
+AABB AABB::transformed(const Affine3x4& m) const
+{
+	if (isEmpty()) return AABB();
+
+	AABB res;
+	Math::kernels::aabbTransformScalar(m.toArray(), 0, this, &res, 1);
+	return res;
+}
+
+AABB AABB::transformed(const Matrix4& m) const
+{
+	if (isEmpty()) return AABB();
+
+	AABB res;
+	Math::kernels::aabbTransformScalar(m.toArray(), 0, this, &res, 1);
+	return res;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <iostream>
+#include "DataTypedefs.h"
+#include "Vector3.h"
+
+class Matrix4;
+class Affine3x4;
+class BoundingSphere;
+
+//Class that represents an axis-aligned bounding box by its minimum and maximum corners. Takes 6 F32s.
+//A box with min > max on any axis is empty, the default constructor makes one with min = +inf and max = -inf,
+//so that merging anything into it gives the bounds of what was merged.
+//For arrays of boxes, see Math::transformBounds and Math::merge in MathBatch.h.
+class AABB {
+public:
+
+	//Empty box
+	AABB();
+
+	//Constructs a box from its corners
+	AABB(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+	//Constructs the bounds of count points. Empty if count is 0
+	AABB(const Vector3* points, U32 count);
+
+	//Constructs the bounds of s
+	explicit AABB(const BoundingSphere& s);
+
+
+	//Equality operator
+	bool operator ==(const AABB& b) const {
+		return min == b.min && max == b.max;
+	}
+
+	//Inverted equality operator
+	bool operator !=(const AABB& b) const {
+		return !(this->operator==(b));
+	}
+
+
+	//Returns true if the box is empty
+	bool isEmpty() const {
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	//Returns the center
+	Vector3 getCenter() const { return (min + max) * 0.5f; }
+
+	//Returns the half size on each axis
+	Vector3 getExtents() const { return (max - min) * 0.5f; }
+
+	//Returns the size on each axis
+	Vector3 getSize() const { return max - min; }
+
+
+	//Grows the box to contain p
+	void merge(const Vector3& p) {
+		if (p.x < min.x) min.x = p.x;
+		if (p.y < min.y) min.y = p.y;
+		if (p.z < min.z) min.z = p.z;
+
+		if (p.x > max.x) max.x = p.x;
+		if (p.y > max.y) max.y = p.y;
+		if (p.z > max.z) max.z = p.z;
+	}
+
+	//Grows the box to contain b
+	void merge(const AABB& b) {
+		if (b.min.x < min.x) min.x = b.min.x;
+		if (b.min.y < min.y) min.y = b.min.y;
+		if (b.min.z < min.z) min.z = b.min.z;
+
+		if (b.max.x > max.x) max.x = b.max.x;
+		if (b.max.y > max.y) max.y = b.max.y;
+		if (b.max.z > max.z) max.z = b.max.z;
+	}
+
+	//Returns the bounds of this box and b
+	AABB merged(const AABB& b) const {
+		AABB res(*this);
+		res.merge(b);
+		return res;
+	}
+
+	//Returns true if p is inside the box or on its surface
+	bool contains(const Vector3& p) const {
+		return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+	}
+
+	//Returns true if b is inside the box. An empty b is inside every box
+	bool contains(const AABB& b) const;
+
+	//Returns true if the boxes intersect or touch. Empty boxes overlap nothing
+	bool overlaps(const AABB& b) const {
+		return min.x <= b.max.x && b.min.x <= max.x && min.y <= b.max.y && b.min.y <= max.y && min.z <= b.max.z && b.min.z <= max.z;
+	}
+
+
+	//Returns the bounds of this box transformed by affine m. Transforms the center, and gets the new extents by multiplying
+	//the extents by the absolute values of the 3x3 part (Arvo), instead of transforming 8 corners. The result is exact.
+	//An empty box stays empty
+	AABB transformed(const Affine3x4& m) const;
+
+	//Returns the bounds of this box transformed by m. m must have a bottom row of (0, 0, 0, 1)
+	AABB transformed(const Matrix4& m) const;
+
+
+	//Operator for printing AABBs
+	friend std::ostream& operator <<(std::ostream& os, const AABB& b) {
+		os << std::fixed << "AABB: (" << b.min.x << ", " << b.min.y << ", " << b.min.z << ") - ("
+			<< b.max.x << ", " << b.max.y << ", " << b.max.z << ")" << std::endl;
+		return os;
+	}
+
+
+	Vector3 min, max;
+};
@@ -0,0 +1,128 @@
+#include "Affine3x4.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "MathKernels.h"
+#include <cstring>
+#include <string>
+
+static_assert(sizeof(Affine3x4) == 12 * sizeof(F32), "Affine3x4 must be 12 F32s, so arrays of them can be passed to the batch operations");
+
+static const F32 identityAffine[12] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 };
+
+Affine3x4::Affine3x4()
+{
+	memcpy(elements, identityAffine, sizeof(elements));
+}
+
+Affine3x4::Affine3x4(F32 f0, F32 f1, F32 f2, F32 f3, F32 f4, F32 f5, F32 f6, F32 f7, F32 f8, F32 f9, F32 f10, F32 f11)
+{
+	elements[0] = f0; elements[1] = f1; elements[2] = f2; elements[3] = f3;
+	elements[4] = f4; elements[5] = f5; elements[6] = f6; elements[7] = f7;
+	elements[8] = f8; elements[9] = f9; elements[10] = f10; elements[11] = f11;
+}
+
+Affine3x4::Affine3x4(const F32* f)
+{
+	memcpy(elements, f, sizeof(elements));
+}
+
+Affine3x4::Affine3x4(const Matrix4& m)
+{
+	memcpy(elements, m.toArray(), sizeof(elements));
+}
+
+Affine3x4::Affine3x4(const Quaternion& rotation, const Vector3& translation, const Vector3& scale)
+{
+	const F32 x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+
+	elements[0] = (1 - 2 * (y * y + z * z)) * scale.x;
+	elements[1] = 2 * (x * y - z * w) * scale.y;
+	elements[2] = 2 * (x * z + y * w) * scale.z;
+	elements[3] = translation.x;
+
+	elements[4] = 2 * (x * y + z * w) * scale.x;
+	elements[5] = (1 - 2 * (x * x + z * z)) * scale.y;
+	elements[6] = 2 * (y * z - x * w) * scale.z;
+	elements[7] = translation.y;
+
+	elements[8] = 2 * (x * z - y * w) * scale.x;
+	elements[9] = 2 * (y * z + x * w) * scale.y;
+	elements[10] = (1 - 2 * (x * x + y * y)) * scale.z;
+	elements[11] = translation.z;
+}
+
+bool Affine3x4::operator ==(const Affine3x4& m) const
+{
+	for (U32 i = 0; i < 12; ++i) {
+		if (elements[i] != m.elements[i]) return false;
+	}
+	return true;
+}
+
+void Affine3x4::identity()
+{
+	memcpy(elements, identityAffine, sizeof(elements));
+}
+
+bool Affine3x4::isIdentity() const
+{
+	return memcmp(elements, identityAffine, sizeof(elements)) == 0;
+}
+
+void Affine3x4::invert()
+{
+	*this = inverse();
+}
+
+Affine3x4 Affine3x4::inverse() const
+{
+	Affine3x4 res(NO_INIT);
+
+	if (!Math::kernels::affineInverse(elements, res.elements)) {
+		Math::mathError("ERROR: Tried to invert singular Affine3x4\n");
+		return Affine3x4();
+	}
+
+	return res;
+}
+
+Affine3x4 Affine3x4::inverseRigid() const
+{
+	const F32* m = elements;
+
+	//Inverse of a rotation is its transpose
+	return Affine3x4(m[0], m[4], m[8], -(m[0] * m[3] + m[4] * m[7] + m[8] * m[11]),
+		m[1], m[5], m[9], -(m[1] * m[3] + m[5] * m[7] + m[9] * m[11]),
+		m[2], m[6], m[10], -(m[2] * m[3] + m[6] * m[7] + m[10] * m[11]));
+}
+
+Matrix4 Affine3x4::toMatrix() const
+{
+	const F32* m = elements;
+
+	return Matrix4(m[0], m[1], m[2], m[3],
+		m[4], m[5], m[6], m[7],
+		m[8], m[9], m[10], m[11],
+		0.f, 0.f, 0.f, 1.f);
+}
+
+F32 Affine3x4::getElement(U32 r, U32 c) const
+{
+	if (r < 3 && c < 4) {
+		return elements[(r * 4) + c];
+	}
+	else {
+		Math::mathError("ERROR: Tried to access element (" + std::to_string(r) + ", " + std::to_string(c) + ") in Affine3x4\n");
+		return 0.f;
+	}
+}
+
+void Affine3x4::setElement(U32 r, U32 c, F32 val)
+{
+	if (r < 3 && c < 4) {
+		elements[(r * 4) + c] = val;
+	}
+	else {
+		Math::mathError("ERROR: Tried to set element (" + std::to_string(r) + ", " + std::to_string(c) + ") in Affine3x4\n");
+	}
+}
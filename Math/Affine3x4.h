@@ -0,0 +1,162 @@
+#pragma once
+#include <iostream>
+#include "MathError.h"
+#include "MathSIMD.h"
+#include "DataTypedefs.h"
+#include "Vector3.h"
+
+class Matrix4;
+class Quaternion;
+
+//Class that represents an affine transform as the top 3 rows of a 4x4 matrix. The bottom row is always (0, 0, 0, 1) and is not stored,
+//so the matrix takes 12 F32s inside the object and products skip the multiplies by the constant row.
+//Elements are row-major, the same layout as the first 12 elements of Matrix4.
+class Affine3x4 {
+public:
+
+	//Inits matrix to identity
+	Affine3x4();
+
+	//Constructs matrix from 12 elements(row-major)
+	Affine3x4(F32, F32, F32, F32, F32, F32, F32, F32, F32, F32, F32, F32);
+
+	//Constructs matrix from an array of 12 F32s(row-major). Copies the array
+	explicit Affine3x4(const F32* f);
+
+	//Constructs matrix from the top 3 rows of m. The bottom row of m is ignored
+	explicit Affine3x4(const Matrix4& m);
+
+	//Constructs matrix that scales by scale, then rotates by normalized rotation, then translates by translation
+	Affine3x4(const Quaternion& rotation, const Vector3& translation, const Vector3& scale = Vector3(1.f, 1.f, 1.f));
+
+
+	//Matrix multiplication, applies m first and then this. 36 multiplies.
+	//Row i of the product is a[i][0] * row 0 of m + a[i][1] * row 1 + a[i][2] * row 2 + a[i][3] * (0, 0, 0, 1),
+	//so the missing bottom row only adds a[i][3] to the translation
+	Affine3x4 operator *(const Affine3x4& m) const {
+		Affine3x4 res(NO_INIT);
+		const F32* a = elements;
+		const F32* b = m.elements;
+		F32* r = res.elements;
+
+#ifdef MATH_SSE2
+		const __m128 b0 = _mm_loadu_ps(b);
+		const __m128 b1 = _mm_loadu_ps(b + 4);
+		const __m128 b2 = _mm_loadu_ps(b + 8);
+		const __m128 lastColumn = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+		__m128 rows[3];
+		for (U32 i = 0; i < 3; ++i) {
+			const __m128 row = _mm_loadu_ps(a + i * 4);
+			rows[i] = _mm_and_ps(row, lastColumn);
+			rows[i] = Math::simd::madd(Math::simd::splat<0>(row), b0, rows[i]);
+			rows[i] = Math::simd::madd(Math::simd::splat<1>(row), b1, rows[i]);
+			rows[i] = Math::simd::madd(Math::simd::splat<2>(row), b2, rows[i]);
+		}
+
+		_mm_storeu_ps(r, rows[0]);
+		_mm_storeu_ps(r + 4, rows[1]);
+		_mm_storeu_ps(r + 8, rows[2]);
+#else
+		for (U32 i = 0; i < 12; i += 4) {
+			r[i] = a[i] * b[0] + a[i + 1] * b[4] + a[i + 2] * b[8];
+			r[i + 1] = a[i] * b[1] + a[i + 1] * b[5] + a[i + 2] * b[9];
+			r[i + 2] = a[i] * b[2] + a[i + 1] * b[6] + a[i + 2] * b[10];
+			r[i + 3] = a[i] * b[3] + a[i + 1] * b[7] + a[i + 2] * b[11] + a[i + 3];
+		}
+#endif
+
+		return res;
+	}
+
+	//Compound matrix multiplication
+	void operator *=(const Affine3x4& m) {
+		*this = this->operator*(m);
+	}
+
+	//Equal operator
+	bool operator ==(const Affine3x4& m) const;
+
+	//Non-equal operator
+	bool operator !=(const Affine3x4& m) const {
+		return !(this->operator==(m));
+	}
+
+	//Returns a pointer to start of row i
+	F32* operator [](U32 i) { return elements + (i * 4); }
+
+	//Returns a pointer to start of row i
+	const F32* operator [](U32 i) const { return elements + (i * 4); }
+
+
+	//Transforms point p
+	Vector3 transformPoint(const Vector3& p) const {
+		return Vector3(elements[0] * p.x + elements[1] * p.y + elements[2] * p.z + elements[3],
+			elements[4] * p.x + elements[5] * p.y + elements[6] * p.z + elements[7],
+			elements[8] * p.x + elements[9] * p.y + elements[10] * p.z + elements[11]);
+	}
+
+	//Transforms direction v, translation is ignored
+	Vector3 transformDirection(const Vector3& v) const {
+		return Vector3(elements[0] * v.x + elements[1] * v.y + elements[2] * v.z,
+			elements[4] * v.x + elements[5] * v.y + elements[6] * v.z,
+			elements[8] * v.x + elements[9] * v.y + elements[10] * v.z);
+	}
+
+
+	//Sets this matrix to identity
+	void identity();
+
+	//Returns true if matrix is identity matrix
+	bool isIdentity() const;
+
+	//Inverts this matrix
+	void invert();
+
+	//Returns an inverse of this matrix. Returns identity if the matrix is singular
+	Affine3x4 inverse() const;
+
+	//Returns an inverse of this matrix, that must only rotate and translate. Transposes the rotation instead of inverting it
+	Affine3x4 inverseRigid() const;
+
+
+	//Returns Matrix4 with these rows and a bottom row of (0, 0, 0, 1)
+	Matrix4 toMatrix() const;
+
+	//Returns the translation
+	Vector3 getTranslation() const { return Vector3(elements[3], elements[7], elements[11]); }
+
+	//Sets the translation
+	void setTranslation(const Vector3& t) { elements[3] = t.x; elements[7] = t.y; elements[11] = t.z; }
+
+	//Returns pointer to array of 12 elements of this matrix
+	const F32* toArray() const { return elements; }
+
+	//Returns pointer to array of 12 elements of this matrix
+	F32* toArray() { return elements; }
+
+	//Returns element at row r and column c
+	F32 getElement(U32 r, U32 c) const;
+
+	//Sets element at row r and column c to value val
+	void setElement(U32 r, U32 c, F32 val);
+
+
+	friend std::ostream& operator <<(std::ostream& os, const Affine3x4& m) {
+		os << std::fixed << "Affine3x4: [" << m.elements[0] << ", " << m.elements[1] << ", " << m.elements[2] << ", " << m.elements[3] << "]\n";
+		os << std::fixed << "           [" << m.elements[4] << ", " << m.elements[5] << ", " << m.elements[6] << ", " << m.elements[7] << "]\n";
+		os << std::fixed << "           [" << m.elements[8] << ", " << m.elements[9] << ", " << m.elements[10] << ", " << m.elements[11] << "]\n";
+
+		return os;
+	}
+
+private:
+	//Tag for the constructor that leaves elements uninitialized
+	enum NoInit { NO_INIT };
+
+	//Leaves elements uninitialized. For operators that set every element
+	explicit Affine3x4(NoInit) {}
+
+	//Not over-aligned, so arrays from new[] and std::vector are valid before C++17. Loads and stores are unaligned
+	F32 elements[12];
+};
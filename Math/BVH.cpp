@@ -0,0 +1,527 @@
+#include "BVH.h"
+#include "MathError.h"
+#include <algorithm>
+#include <limits>
+
+//Range of primitives of a node still to be built, and the node whose second child it becomes, or NONE for first children
+struct BuildTask {
+	U32 first, count, parent, depth;
+};
+
+//Primitive of the build, partitioned with the nodes so that every node reads its primitives in one piece
+struct BuildPrimitive {
+	AABB bounds;
+	F32 center[3];
+	U32 index;
+};
+
+//Bin of the split search: bounds and amount of the primitives whose centers fall in it.
+//Plain F32s, so that the bins on the stack of every node are not constructed
+struct BuildBin {
+	F32 min[3], max[3];
+	U32 count;
+};
+
+static const U32 NONE = 0xFFFFFFFF;
+
+//Cost of visiting an inner node, relative to testing one primitive
+static const F32 TRAVERSAL_COST = 1.f;
+
+//Ray of a query, with the reciprocals of the direction for the slab tests
+struct QueryRay {
+	F32 o[3], inv[3];
+	Vector3 origin, direction;
+};
+
+//Returns half the surface area of b, 0 for empty boxes
+static inline F32 halfArea(const AABB& b)
+{
+	if (b.isEmpty()) return 0.f;
+
+	const Vector3 s = b.getSize();
+	return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+//Returns the bin of center c on an axis whose centers start at min, scale is binCount / extent of the centers
+static inline U32 binOf(F32 c, F32 min, F32 scale, U32 binCount)
+{
+	const U32 b = U32((c - min) * scale);
+	return b < binCount ? b : binCount - 1;
+}
+
+static inline void resetBin(BuildBin& b)
+{
+	b.min[0] = b.min[1] = b.min[2] = std::numeric_limits<F32>::infinity();
+	b.max[0] = b.max[1] = b.max[2] = -std::numeric_limits<F32>::infinity();
+	b.count = 0;
+}
+
+//Grows the bounds of b to contain min - max
+static inline void growBin(BuildBin& b, const F32* min, const F32* max)
+{
+	for (U32 k = 0; k < 3; ++k) {
+		b.min[k] = min[k] < b.min[k] ? min[k] : b.min[k];
+		b.max[k] = max[k] > b.max[k] ? max[k] : b.max[k];
+	}
+}
+
+//Returns half the surface area of the bounds of b, 0 if they are empty
+static inline F32 binArea(const BuildBin& b)
+{
+	if (b.min[0] > b.max[0] || b.min[1] > b.max[1] || b.min[2] > b.max[2]) return 0.f;
+
+	const F32 x = b.max[0] - b.min[0], y = b.max[1] - b.min[1], z = b.max[2] - b.min[2];
+	return x * y + y * z + z * x;
+}
+
+static inline void setBounds(BVH::Node& n, const AABB& b)
+{
+	n.min[0] = b.min.x; n.min[1] = b.min.y; n.min[2] = b.min.z;
+	n.max[0] = b.max.x; n.max[1] = b.max.y; n.max[2] = b.max.z;
+}
+
+static inline AABB triangleBounds(const Vector3* v)
+{
+	AABB b(v[0], v[0]);
+	b.merge(v[1]);
+	b.merge(v[2]);
+	return b;
+}
+
+//Slab test: returns true if the ray is inside min - max at some distance in [0, maxT], and the first such distance in t.
+//The comparisons keep the range when a ray parallel to a slab starts on its plane and gives 0 * infinity = NaN
+static inline bool intersectBox(const F32* min, const F32* max, const QueryRay& r, F32 maxT, F32& t)
+{
+	F32 tmin = 0.f, tmax = maxT;
+	for (U32 k = 0; k < 3; ++k) {
+		const F32 t0 = (min[k] - r.o[k]) * r.inv[k];
+		const F32 t1 = (max[k] - r.o[k]) * r.inv[k];
+		const F32 tNear = r.inv[k] < 0.f ? t1 : t0;
+		const F32 tFar = r.inv[k] < 0.f ? t0 : t1;
+		if (tNear > tmin) tmin = tNear;
+		if (tFar < tmax) tmax = tFar;
+	}
+
+	t = tmin;
+	return tmin <= tmax;
+}
+
+//Moller-Trumbore: solves origin + t * direction = v0 + u * (v1 - v0) + v * (v2 - v0) with Cramer's rule
+static inline bool intersectTriangle(const Vector3* v, const QueryRay& r, F32 maxT, F32& t, F32& u, F32& w)
+{
+	const Vector3 e1 = v[1] - v[0], e2 = v[2] - v[0];
+	const Vector3 p = r.direction.cross(e2);
+	const F32 det = e1.dot(p);
+	if (det == 0.f) return false;
+
+	const F32 inv = 1.f / det;
+	const Vector3 s = r.origin - v[0];
+	u = s.dot(p) * inv;
+	if (u < 0.f || u > 1.f) return false;
+
+	const Vector3 q = s.cross(e1);
+	w = r.direction.dot(q) * inv;
+	if (w < 0.f || u + w > 1.f) return false;
+
+	t = e2.dot(q) * inv;
+	return t >= 0.f && t <= maxT;
+}
+
+
+BVH::BVH() : triangleCount(0)
+{
+
+}
+
+void BVH::build(const Vector3* vertices, const U32* idx, U32 count)
+{
+	clear();
+	triangleCount = count;
+	if (idx) indices.assign(idx, idx + size_t(count) * 3);
+
+	std::vector<AABB> bounds(count);
+	for (U32 i = 0; i < count; ++i) {
+		const Vector3 v[3] = {
+			vertices[idx ? idx[i * 3] : i * 3],
+			vertices[idx ? idx[i * 3 + 1] : i * 3 + 1],
+			vertices[idx ? idx[i * 3 + 2] : i * 3 + 2]
+		};
+		bounds[i] = triangleBounds(v);
+	}
+
+	buildNodes(bounds);
+	storeTriangles(vertices);
+}
+
+void BVH::build(const AABB* b, U32 count)
+{
+	clear();
+
+	buildNodes(std::vector<AABB>(b, b + count));
+	storeBoxes(b);
+}
+
+void BVH::refit(const Vector3* vertices)
+{
+	if (empty()) return;
+	if (triangleCount == 0) {
+		Math::mathError("ERROR: Tried to refit a BVH of boxes with vertices\n");
+		return;
+	}
+
+	storeTriangles(vertices);
+	refitNodes();
+}
+
+void BVH::refit(const AABB* b)
+{
+	if (empty()) return;
+	if (triangleCount != 0) {
+		Math::mathError("ERROR: Tried to refit a BVH of triangles with boxes\n");
+		return;
+	}
+
+	storeBoxes(b);
+	refitNodes();
+}
+
+void BVH::clear()
+{
+	nodes.clear();
+	primitives.clear();
+	triangles.clear();
+	boxes.clear();
+	indices.clear();
+	triangleCount = 0;
+}
+
+//Depth-first from a stack: a split pushes the second child first, so the first child is built next and lands right after
+//its parent. The second child learns its index when it is popped, and writes it to the parent.
+//For every axis the centers are sorted to BINS bins, or as many as there are primitives if fewer, and the split between bins with the lowest SAH cost,
+//area(left) * count(left) + area(right) * count(right), is compared to the cost of a leaf, area * count
+void BVH::buildNodes(const std::vector<AABB>& bounds)
+{
+	const U32 count = U32(bounds.size());
+	if (count == 0) return;
+
+	std::vector<BuildPrimitive> prims(count);
+	for (U32 i = 0; i < count; ++i) {
+		prims[i].bounds = bounds[i];
+		prims[i].index = i;
+
+		//Empty boxes have no center, they are put at the origin so that they do not spread the centers
+		const Vector3 c = bounds[i].isEmpty() ? Vector3(0.f, 0.f, 0.f) : bounds[i].getCenter();
+		prims[i].center[0] = c.x; prims[i].center[1] = c.y; prims[i].center[2] = c.z;
+	}
+
+	nodes.reserve(size_t(count) * 2 - 1);
+
+	std::vector<BuildTask> stack;
+	BuildTask root = { 0, count, NONE, 1 };
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		const BuildTask task = stack.back();
+		stack.pop_back();
+
+		const U32 index = U32(nodes.size());
+		nodes.push_back(Node());
+		if (task.parent != NONE) nodes[task.parent].first = index;
+
+		BuildPrimitive* p = prims.data() + task.first;
+
+		AABB box;
+		F32 cmin[3] = { p[0].center[0], p[0].center[1], p[0].center[2] };
+		F32 cmax[3] = { cmin[0], cmin[1], cmin[2] };
+		for (U32 i = 0; i < task.count; ++i) {
+			box.merge(p[i].bounds);
+			for (U32 k = 0; k < 3; ++k) {
+				if (p[i].center[k] < cmin[k]) cmin[k] = p[i].center[k];
+				if (p[i].center[k] > cmax[k]) cmax[k] = p[i].center[k];
+			}
+		}
+		setBounds(nodes[index], box);
+
+		//Split search, all axes binned in one pass. Axes where all centers are the same get scale 0, and all go to bin 0
+		F32 bestCost = -1.f;
+		U32 bestAxis = 0, bestBin = 0;
+		F32 scale[3];
+		const U32 binCount = task.count < BINS ? task.count : BINS;
+		if (task.count > 1 && task.depth < MAX_DEPTH) {
+			BuildBin bins[3][BINS];
+			for (U32 k = 0; k < 3; ++k) {
+				const F32 extent = cmax[k] - cmin[k];
+				scale[k] = extent > 0.f ? F32(binCount) / extent : 0.f;
+				for (U32 b = 0; b < binCount; ++b) resetBin(bins[k][b]);
+			}
+
+			for (U32 i = 0; i < task.count; ++i) {
+				for (U32 k = 0; k < 3; ++k) {
+					BuildBin& bin = bins[k][binOf(p[i].center[k], cmin[k], scale[k], binCount)];
+					growBin(bin, &p[i].bounds.min.x, &p[i].bounds.max.x);
+					++bin.count;
+				}
+			}
+
+			for (U32 k = 0; k < 3; ++k) {
+				if (scale[k] == 0.f) continue;
+
+				//Areas and counts of the right sides, bins b to binCount - 1
+				F32 rightArea[BINS];
+				U32 rightCount[BINS];
+				BuildBin acc;
+				resetBin(acc);
+				for (U32 b = binCount - 1; b > 0; --b) {
+					growBin(acc, bins[k][b].min, bins[k][b].max);
+					acc.count += bins[k][b].count;
+					rightArea[b] = binArea(acc);
+					rightCount[b] = acc.count;
+				}
+
+				resetBin(acc);
+				for (U32 b = 0; b < binCount - 1; ++b) {
+					growBin(acc, bins[k][b].min, bins[k][b].max);
+					acc.count += bins[k][b].count;
+					if (acc.count == 0 || rightCount[b + 1] == 0) continue;
+
+					const F32 cost = binArea(acc) * F32(acc.count) + rightArea[b + 1] * F32(rightCount[b + 1]);
+					if (bestCost < 0.f || cost < bestCost) {
+						bestCost = cost;
+						bestAxis = k;
+						bestBin = b;
+					}
+				}
+			}
+		}
+
+		const F32 area = halfArea(box);
+		const bool fits = task.count <= MAX_LEAF_SIZE;
+		U32 mid;
+
+		if (task.count == 1 || task.depth >= MAX_DEPTH || (fits && (bestCost < 0.f || area * F32(task.count) <= area * TRAVERSAL_COST + bestCost))) {
+			nodes[index].first = task.first;
+			nodes[index].count = task.count;
+			continue;
+		}
+		else if (bestCost < 0.f) {
+			//All centers are the same, the primitives are split in half as they are
+			mid = task.first + task.count / 2;
+		}
+		else {
+			const F32 min = cmin[bestAxis], s = scale[bestAxis];
+			const U32 axis = bestAxis, bin = bestBin;
+			mid = U32(std::partition(p, p + task.count, [=](const BuildPrimitive& b) { return binOf(b.center[axis], min, s, binCount) <= bin; }) - prims.data());
+		}
+
+		nodes[index].count = 0;
+
+		const BuildTask second = { mid, task.first + task.count - mid, index, task.depth + 1 };
+		const BuildTask first = { task.first, mid - task.first, NONE, task.depth + 1 };
+		stack.push_back(second);
+		stack.push_back(first);
+	}
+
+	primitives.resize(count);
+	for (U32 i = 0; i < count; ++i) primitives[i] = prims[i].index;
+}
+
+void BVH::storeTriangles(const Vector3* vertices)
+{
+	const U32 count = size();
+	triangles.resize(size_t(count) * 3);
+
+	for (U32 i = 0; i < count; ++i) {
+		const U32 p = primitives[i];
+		for (U32 k = 0; k < 3; ++k) {
+			triangles[i * 3 + k] = vertices[indices.empty() ? p * 3 + k : indices[p * 3 + k]];
+		}
+	}
+}
+
+void BVH::storeBoxes(const AABB* b)
+{
+	const U32 count = size();
+	boxes.resize(count);
+
+	for (U32 i = 0; i < count; ++i) {
+		boxes[i] = b[primitives[i]];
+	}
+}
+
+//Children come after their parents, so going through the nodes backwards visits the children first
+void BVH::refitNodes()
+{
+	for (U32 i = getNodeCount(); i-- > 0;) {
+		Node& n = nodes[i];
+		AABB box;
+
+		if (n.count != 0) {
+			for (U32 j = n.first; j < n.first + n.count; ++j) {
+				box.merge(triangleCount ? triangleBounds(triangles.data() + size_t(j) * 3) : boxes[j]);
+			}
+		}
+		else {
+			const Node& a = nodes[i + 1];
+			const Node& b = nodes[n.first];
+			box = AABB(Vector3(a.min[0], a.min[1], a.min[2]), Vector3(a.max[0], a.max[1], a.max[2]));
+			box.merge(AABB(Vector3(b.min[0], b.min[1], b.min[2]), Vector3(b.max[0], b.max[1], b.max[2])));
+		}
+
+		setBounds(n, box);
+	}
+}
+
+//Visits the nearer child first and pushes the other with its entry distance, which is skipped when popped if a closer hit
+//was found meanwhile
+bool BVH::traverse(const Vector3& origin, const Vector3& direction, F32 maxDistance, bool any, Hit& hit) const
+{
+	if (nodes.empty()) return false;
+
+	QueryRay r;
+	r.origin = origin;
+	r.direction = direction;
+	r.o[0] = origin.x; r.o[1] = origin.y; r.o[2] = origin.z;
+	r.inv[0] = 1.f / direction.x; r.inv[1] = 1.f / direction.y; r.inv[2] = 1.f / direction.z;
+
+	F32 best = maxDistance;
+	bool found = false;
+
+	U32 stack[MAX_DEPTH];
+	F32 stackDistance[MAX_DEPTH];
+	U32 top = 0;
+
+	F32 t;
+	if (!intersectBox(nodes[0].min, nodes[0].max, r, best, t)) return false;
+
+	U32 node = 0;
+	for (;;) {
+		const Node& n = nodes[node];
+
+		if (n.count == 0) {
+			U32 a = node + 1, b = n.first;
+			F32 ta, tb;
+			const bool hitA = intersectBox(nodes[a].min, nodes[a].max, r, best, ta);
+			const bool hitB = intersectBox(nodes[b].min, nodes[b].max, r, best, tb);
+
+			if (hitA && hitB) {
+				if (tb < ta) {
+					std::swap(a, b);
+					std::swap(ta, tb);
+				}
+				stack[top] = b;
+				stackDistance[top] = tb;
+				++top;
+				node = a;
+				continue;
+			}
+			if (hitA) {
+				node = a;
+				continue;
+			}
+			if (hitB) {
+				node = b;
+				continue;
+			}
+		}
+		else {
+			for (U32 i = n.first; i < n.first + n.count; ++i) {
+				F32 u = 0.f, v = 0.f;
+				const bool h = triangleCount ? intersectTriangle(triangles.data() + size_t(i) * 3, r, best, t, u, v)
+					: intersectBox(&boxes[i].min.x, &boxes[i].max.x, r, best, t);
+				if (!h) continue;
+
+				found = true;
+				if (any) return true;
+
+				best = t;
+				hit.primitive = primitives[i];
+				hit.distance = t;
+				hit.u = u;
+				hit.v = v;
+			}
+		}
+
+		//Next node from the stack, skipping those entered beyond the closest hit
+		do {
+			if (top == 0) return found;
+			--top;
+		} while (stackDistance[top] > best);
+		node = stack[top];
+	}
+}
+
+bool BVH::raycast(const Vector3& origin, const Vector3& direction, F32 maxDistance, Hit& hit) const
+{
+	Hit h;
+	if (!traverse(origin, direction, maxDistance, false, h)) return false;
+
+	hit = h;
+	return true;
+}
+
+bool BVH::raycastAny(const Vector3& origin, const Vector3& direction, F32 maxDistance) const
+{
+	Hit h;
+	return traverse(origin, direction, maxDistance, true, h);
+}
+
+U32 BVH::overlaps(const AABB& box, std::vector<U32>& out) const
+{
+	if (nodes.empty() || box.isEmpty()) return 0;
+
+	const size_t start = out.size();
+	U32 stack[MAX_DEPTH + 1];
+	U32 top = 0;
+	stack[top++] = 0;
+
+	while (top != 0) {
+		const Node& n = nodes[stack[--top]];
+		const AABB bounds(Vector3(n.min[0], n.min[1], n.min[2]), Vector3(n.max[0], n.max[1], n.max[2]));
+		if (!bounds.overlaps(box)) continue;
+
+		if (n.count == 0) {
+			stack[top++] = n.first;
+			stack[top++] = U32(&n - nodes.data()) + 1;
+			continue;
+		}
+
+		for (U32 i = n.first; i < n.first + n.count; ++i) {
+			const AABB b = triangleCount ? triangleBounds(triangles.data() + size_t(i) * 3) : boxes[i];
+			if (b.overlaps(box)) out.push_back(primitives[i]);
+		}
+	}
+
+	return U32(out.size() - start);
+}
+
+AABB BVH::getBounds() const
+{
+	if (nodes.empty()) return AABB();
+
+	return AABB(Vector3(nodes[0].min[0], nodes[0].min[1], nodes[0].min[2]), Vector3(nodes[0].max[0], nodes[0].max[1], nodes[0].max[2]));
+}
+
+U32 BVH::getDepth() const
+{
+	if (nodes.empty()) return 0;
+
+	U32 depth = 0;
+	U32 stack[MAX_DEPTH * 2][2];
+	U32 top = 0;
+	stack[top][0] = 0;
+	stack[top][1] = 1;
+	++top;
+
+	while (top != 0) {
+		--top;
+		const U32 node = stack[top][0], d = stack[top][1];
+		if (d > depth) depth = d;
+
+		if (nodes[node].count == 0) {
+			stack[top][0] = node + 1; stack[top][1] = d + 1; ++top;
+			stack[top][0] = nodes[node].first; stack[top][1] = d + 1; ++top;
+		}
+	}
+
+	return depth;
+}
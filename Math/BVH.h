@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <iostream>
+#include "DataTypedefs.h"
+#include "MathAligned.h"
+#include "Vector3.h"
+#include "AABB.h"
+
+//Bounding volume hierarchy over triangles or AABBs, for ray and overlap queries in O(log n) instead of testing every primitive.
+//Built top-down with the surface area heuristic (SAH) over binned centroids. Nodes are 32 bytes, stored depth-first in one
+//array, so the first child of a node is the next node and a ray walking down the tree mostly reads forward.
+//Primitives are copied in leaf order. After the primitives move, refit() updates the bounds without rebuilding, which keeps
+//queries correct but slows them down if the primitives move far from their neighbours of the build.
+class BVH {
+public:
+
+	//32 bytes: the bounds, and for leaves the range of primitives, for inner nodes the index of the second child
+	struct Node {
+		F32 min[3];
+
+		//First primitive of a leaf, second child of an inner node
+		U32 first;
+
+		F32 max[3];
+
+		//Amount of primitives of a leaf, 0 for inner nodes
+		U32 count;
+	};
+
+	//Result of a ray query
+	struct Hit {
+		//Index of the primitive, as given to build()
+		U32 primitive;
+
+		//The hit point is origin + distance * direction
+		F32 distance;
+
+		//Barycentric coordinates of the hit point on a triangle, the point is v0 + u * (v1 - v0) + v * (v2 - v0). 0 for boxes
+		F32 u, v;
+	};
+
+	//Most primitives in a leaf, unless the leaf is MAX_DEPTH levels deep
+	static const U32 MAX_LEAF_SIZE = 8;
+
+	//Most levels in the tree. The builder makes leaves at this depth, which bounds the stack of the queries
+	static const U32 MAX_DEPTH = 64;
+
+	//Amount of bins per axis the builder sorts centroids to
+	static const U32 BINS = 16;
+
+	//Empty hierarchy
+	BVH();
+
+
+	//Builds the hierarchy over count triangles. Triangle i has vertices vertices[indices[3 * i]], vertices[indices[3 * i + 1]]
+	//and vertices[indices[3 * i + 2]]. indices may be null, then the vertices of triangle i are vertices[3 * i] to vertices[3 * i + 2]
+	void build(const Vector3* vertices, const U32* indices, U32 count);
+
+	//Builds the hierarchy over count boxes. Empty boxes are never hit
+	void build(const AABB* boxes, U32 count);
+
+	//Updates the triangles and bounds to new vertex positions. The indices and the amount of triangles are those of build()
+	void refit(const Vector3* vertices);
+
+	//Updates the boxes and bounds, boxes must hold as many boxes as build() got
+	void refit(const AABB* boxes);
+
+	//Removes all nodes and primitives
+	void clear();
+
+
+	//Finds the closest primitive hit by the ray from origin along direction, at most maxDistance lengths of direction away.
+	//Triangles are hit from both sides. Boxes are hit where the ray enters them, or at distance 0 if origin is inside.
+	//Returns false if nothing is hit, and leaves hit unchanged
+	bool raycast(const Vector3& origin, const Vector3& direction, F32 maxDistance, Hit& hit) const;
+
+	//Returns true if the ray hits any primitive, same as raycast(), but stops at the first hit found. For line of sight and occlusion
+	bool raycastAny(const Vector3& origin, const Vector3& direction, F32 maxDistance) const;
+
+	//Appends the indices of the primitives whose bounds overlap box to out, and returns their amount
+	U32 overlaps(const AABB& box, std::vector<U32>& out) const;
+
+
+	//Returns the bounds of all primitives
+	AABB getBounds() const;
+
+	//Returns the amount of primitives
+	inline U32 size() const { return U32(primitives.size()); }
+
+	//Returns true if there are no primitives
+	inline bool empty() const { return primitives.empty(); }
+
+	//Returns the nodes, the root first
+	inline const Node* getNodes() const { return nodes.data(); }
+
+	//Returns the amount of nodes
+	inline U32 getNodeCount() const { return U32(nodes.size()); }
+
+	//Returns the amount of levels, 0 when empty
+	U32 getDepth() const;
+
+
+	//Operator for printing BVHs
+	friend std::ostream& operator <<(std::ostream& os, const BVH& b) {
+		os << "BVH: " << b.size() << (b.triangleCount ? " triangles, " : " boxes, ") << b.getNodeCount() << " nodes, depth " << b.getDepth() << std::endl;
+		return os;
+	}
+
+private:
+
+	//Builds the nodes over primitives with bounds, and copies the order to primitives
+	void buildNodes(const std::vector<AABB>& bounds);
+
+	//Copies the primitive data in leaf order
+	void storeTriangles(const Vector3* vertices);
+	void storeBoxes(const AABB* boxes);
+
+	//Recomputes the bounds of all nodes from the stored primitives, children first
+	void refitNodes();
+
+	//Closest and any hit traversal, shared by raycast() and raycastAny()
+	bool traverse(const Vector3& origin, const Vector3& direction, F32 maxDistance, bool any, Hit& hit) const;
+
+
+	//Aligned to 64 bytes, so that no node is split across two cache lines
+	std::vector<Node, AlignedAllocator<Node, 64> > nodes;
+
+	//Index of the primitive as given to build(), in leaf order
+	std::vector<U32> primitives;
+
+	//Vertices of the triangles in leaf order, 3 per triangle
+	std::vector<Vector3> triangles;
+
+	//Boxes in leaf order
+	std::vector<AABB> boxes;
+
+	//Copy of the indices of build(), empty if build() got null indices
+	std::vector<U32> indices;
+
+	//Amount of triangles, 0 for a hierarchy of boxes
+	U32 triangleCount;
+};
@@ -0,0 +1,132 @@
+#include "BoundingSphere.h"
+#include "AABB.h"
+#include "Affine3x4.h"
+#include "Matrix4.h"
+#include "MathKernels.h"
+#include <math.h>
+
+BoundingSphere::BoundingSphere(const Vector3* points, U32 count) : radius(-1.f)
+{
+	if (count == 0) return;
+
+	//Points with the smallest and largest x, y and z
+	U32 lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+	for (U32 i = 1; i < count; ++i) {
+		for (U32 k = 0; k < 3; ++k) {
+			if (points[i].getElement(k) < points[lo[k]].getElement(k)) lo[k] = i;
+			if (points[i].getElement(k) > points[hi[k]].getElement(k)) hi[k] = i;
+		}
+	}
+
+	//The pair farthest apart gives the first sphere
+	U32 axis = 0;
+	F32 best = -1.f;
+	for (U32 k = 0; k < 3; ++k) {
+		const F32 d = (points[hi[k]] - points[lo[k]]).lenght2();
+		if (d > best) {
+			best = d;
+			axis = k;
+		}
+	}
+
+	center = (points[lo[axis]] + points[hi[axis]]) * 0.5f;
+	radius = sqrtf(best) * 0.5f;
+
+	for (U32 i = 0; i < count; ++i) merge(points[i]);
+}
+
+BoundingSphere::BoundingSphere(const AABB& b) : radius(-1.f)
+{
+	if (b.isEmpty()) return;
+
+	center = b.getCenter();
+	radius = b.getExtents().lenght();
+}
+
+void BoundingSphere::merge(const Vector3& p)
+{
+	if (isEmpty()) {
+		center = p;
+		radius = 0.f;
+		return;
+	}
+
+	const Vector3 d = p - center;
+	const F32 dist2 = d.lenght2();
+	if (dist2 <= radius * radius) return;
+
+	//The new sphere touches p and the far side of the old one
+	const F32 dist = sqrtf(dist2);
+	const F32 r = (radius + dist) * 0.5f;
+	center += d * ((r - radius) / dist);
+	radius = r;
+}
+
+void BoundingSphere::merge(const BoundingSphere& s)
+{
+	if (s.isEmpty()) return;
+	if (isEmpty()) {
+		*this = s;
+		return;
+	}
+
+	const Vector3 d = s.center - center;
+	const F32 dist = d.lenght();
+
+	if (dist + s.radius <= radius) return;
+	if (dist + radius <= s.radius) {
+		*this = s;
+		return;
+	}
+
+	//The new sphere spans from the far side of this one to the far side of s
+	const F32 r = (dist + radius + s.radius) * 0.5f;
+	center += d * ((r - radius) / dist);
+	radius = r;
+}
+
+bool BoundingSphere::contains(const BoundingSphere& s) const
+{
+	if (s.isEmpty()) return true;
+	if (isEmpty()) return false;
+
+	return (s.center - center).lenght() + s.radius <= radius;
+}
+
+bool BoundingSphere::overlaps(const BoundingSphere& s) const
+{
+	if (isEmpty() || s.isEmpty()) return false;
+
+	const F32 r = radius + s.radius;
+	return (s.center - center).lenght2() <= r * r;
+}
+
+//The point of b closest to the center is the center clamped to b
+bool BoundingSphere::overlaps(const AABB& b) const
+{
+	if (isEmpty() || b.isEmpty()) return false;
+
+	const F32 x = center.x < b.min.x ? b.min.x : (center.x > b.max.x ? b.max.x : center.x);
+	const F32 y = center.y < b.min.y ? b.min.y : (center.y > b.max.y ? b.max.y : center.y);
+	const F32 z = center.z < b.min.z ? b.min.z : (center.z > b.max.z ? b.max.z : center.z);
+
+	return (Vector3(x, y, z) - center).lenght2() <= radius * radius;
+}
+
+BoundingSphere BoundingSphere::transformed(const Affine3x4& m) const
+{
+	if (isEmpty()) return BoundingSphere();
+
+	BoundingSphere res;
+	Math::kernels::sphereTransformScalar(m.toArray(), 0, this, &res, 1);
+	return res;
+}
+
+BoundingSphere BoundingSphere::transformed(const Matrix4& m) const
+{
+	if (isEmpty()) return BoundingSphere();
+
+	BoundingSphere res;
+	Math::kernels::sphereTransformScalar(m.toArray(), 0, this, &res, 1);
+	return res;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <iostream>
+#include "DataTypedefs.h"
+#include "Vector3.h"
+
+class Matrix4;
+class Affine3x4;
+class AABB;
+
+//Class that represents a bounding sphere. Takes 4 F32s, center x, y, z and radius.
+//A sphere with negative radius is empty, the default constructor makes one, so that merging anything into it
+//gives bounds of what was merged. For arrays of spheres, see Math::transformBounds in MathBatch.h.
+class BoundingSphere {
+public:
+
+	//Empty sphere
+	BoundingSphere() : radius(-1.f) {}
+
+	//Constructs a sphere from center and radius
+	BoundingSphere(const Vector3& center, F32 radius) : center(center), radius(radius) {}
+
+	//Constructs a sphere that contains count points with Ritter's method: a sphere through the two points farthest apart
+	//along an axis, grown to each point outside it. Up to about 20% larger than the smallest one. Empty if count is 0
+	BoundingSphere(const Vector3* points, U32 count);
+
+	//Constructs the sphere through the corners of b
+	explicit BoundingSphere(const AABB& b);
+
+
+	//Equality operator
+	bool operator ==(const BoundingSphere& s) const {
+		return center == s.center && radius == s.radius;
+	}
+
+	//Inverted equality operator
+	bool operator !=(const BoundingSphere& s) const {
+		return !(this->operator==(s));
+	}
+
+
+	//Returns true if the sphere is empty
+	bool isEmpty() const { return radius < 0.f; }
+
+
+	//Grows the sphere to contain p, moving the center as little as possible
+	void merge(const Vector3& p);
+
+	//Grows the sphere to the smallest one that contains this sphere and s
+	void merge(const BoundingSphere& s);
+
+	//Returns the smallest sphere that contains this sphere and s
+	BoundingSphere merged(const BoundingSphere& s) const {
+		BoundingSphere res(*this);
+		res.merge(s);
+		return res;
+	}
+
+	//Returns true if p is inside the sphere or on its surface
+	bool contains(const Vector3& p) const {
+		return (p - center).lenght2() <= radius * radius && radius >= 0.f;
+	}
+
+	//Returns true if s is inside the sphere. An empty s is inside every sphere
+	bool contains(const BoundingSphere& s) const;
+
+	//Returns true if the spheres intersect or touch. Empty spheres overlap nothing
+	bool overlaps(const BoundingSphere& s) const;
+
+	//Returns true if the sphere intersects or touches b. Empty bounds overlap nothing
+	bool overlaps(const AABB& b) const;
+
+
+	//Returns the sphere transformed by affine m. The radius is scaled by the largest scale of m,
+	//so a non-uniform scale gives a sphere that is larger than needed. An empty sphere stays empty
+	BoundingSphere transformed(const Affine3x4& m) const;
+
+	//Returns the sphere transformed by m. m must have a bottom row of (0, 0, 0, 1)
+	BoundingSphere transformed(const Matrix4& m) const;
+
+
+	//Operator for printing BoundingSpheres
+	friend std::ostream& operator <<(std::ostream& os, const BoundingSphere& s) {
+		os << std::fixed << "BoundingSphere: (" << s.center.x << ", " << s.center.y << ", " << s.center.z << "), " << s.radius << std::endl;
+		return os;
+	}
+
+
+	Vector3 center;
+	F32 radius;
+};
@@ -0,0 +1,60 @@
+#include "DualQuaternion.h"
+#include "Matrix4.h"
+
+static_assert(sizeof(DualQuaternion) == 8 * sizeof(F32), "The skinning kernels read DualQuaternions as 8 F32s");
+
+DualQuaternion::DualQuaternion(const Quaternion& rotation, const Vector3& translation) : real(rotation)
+{
+	dual = 0.5f * (Quaternion(translation.x, translation.y, translation.z, 0.f) * rotation);
+}
+
+DualQuaternion::DualQuaternion(const Matrix4& m) : real(m)
+{
+	dual = 0.5f * (Quaternion(m.getElement(0, 3), m.getElement(1, 3), m.getElement(2, 3), 0.f) * real);
+}
+
+void DualQuaternion::normalize()
+{
+	const F32 l = real.lenght();
+	if (l == 0.f) {
+		Math::mathError("ERROR: Tried to normalize DualQuaternion with zero real part\n");
+		return;
+	}
+
+	real = (1.f / l) * real;
+	dual = (1.f / l) * dual;
+	dual = dual + (-real.dot(dual)) * real;
+}
+
+Vector3 DualQuaternion::getTranslation() const
+{
+	return (2.f * (dual * real.conjugate())).axis();
+}
+
+Matrix4 DualQuaternion::toMatrix() const
+{
+	Matrix4 m = real.toMatrix();
+	const Vector3 t = getTranslation();
+
+	m.setElement(0, 3, t.x);
+	m.setElement(1, 3, t.y);
+	m.setElement(2, 3, t.z);
+
+	return m;
+}
+
+//For normalized real part r and dual part d, with vector parts rv and dv:
+//p + 2 * rv x (rv x p + r.w * p) + 2 * (r.w * dv - d.w * rv + rv x dv)
+Vector3 DualQuaternion::transformPoint(const Vector3& p) const
+{
+	const Vector3 rv(real.x, real.y, real.z);
+	const Vector3 dv(dual.x, dual.y, dual.z);
+
+	const Vector3 t = (dv * real.w - rv * dual.w + rv.cross(dv)) * 2.f;
+	return transformDirection(p) + t;
+}
+
+Vector3 DualQuaternion::transformDirection(const Vector3& v) const
+{
+	return real.rotate(v);
+}
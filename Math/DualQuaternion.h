@@ -0,0 +1,105 @@
+#pragma once
+#include <iostream>
+#include "DataTypedefs.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+class Matrix4;
+
+//Class that represents a rigid transform, rotation followed by translation, as a dual quaternion real + e * dual.
+//Takes 8 F32s, half of a Matrix4, and blends without the volume loss of blended matrices (see Math::skin in Skinning.h).
+//Products compose like matrices: (a * b).transformPoint(p) == a.transformPoint(b.transformPoint(p)).
+class DualQuaternion {
+public:
+
+	//Identity
+	DualQuaternion() : real(0.f, 0.f, 0.f, 1.f), dual(0.f, 0.f, 0.f, 0.f) {}
+
+	//Constructs a DualQuaternion from its parts
+	DualQuaternion(const Quaternion& real, const Quaternion& dual) : real(real), dual(dual) {}
+
+	//Constructs a DualQuaternion that rotates by normalized rotation, then translates by translation
+	DualQuaternion(const Quaternion& rotation, const Vector3& translation);
+
+	//Constructs a DualQuaternion from the rotation and translation of m. m must not have scale or shear
+	explicit DualQuaternion(const Matrix4& m);
+
+
+	//Multiplication operator, applies d first and then this
+	DualQuaternion operator *(const DualQuaternion& d) const {
+		return DualQuaternion(real * d.real, real * d.dual + dual * d.real);
+	}
+
+	//Multiplication assignment operator
+	void operator *=(const DualQuaternion& d) {
+		*this = this->operator*(d);
+	}
+
+	//Addition operator, used for blending
+	DualQuaternion operator +(const DualQuaternion& d) const {
+		return DualQuaternion(real + d.real, dual + d.dual);
+	}
+
+	//Scaling operator, used for blending
+	DualQuaternion operator *(F32 f) const {
+		return DualQuaternion(f * real, f * dual);
+	}
+
+	//Equality operator
+	bool operator ==(const DualQuaternion& d) const {
+		return real == d.real && dual == d.dual;
+	}
+
+	//Inverted equality operator
+	bool operator !=(const DualQuaternion& d) const {
+		return !(this->operator==(d));
+	}
+
+
+	//Normalizes the DualQuaternion: the real part gets length 1 and the dual part is made orthogonal to it
+	void normalize();
+
+	//Returns the normalized version of this DualQuaternion
+	DualQuaternion normalized() const {
+		DualQuaternion d(*this);
+		d.normalize();
+		return d;
+	}
+
+	//Returns the conjugate, which is the inverse of a normalized DualQuaternion
+	DualQuaternion conjugate() const {
+		return DualQuaternion(real.conjugate(), dual.conjugate());
+	}
+
+	//Returns the rotation
+	Quaternion getRotation() const { return real; }
+
+	//Returns the translation, 2 * dual * real.conjugate()
+	Vector3 getTranslation() const;
+
+	//Returns Matrix4 that represents the same transform
+	Matrix4 toMatrix() const;
+
+	//Rotates and translates p
+	Vector3 transformPoint(const Vector3& p) const;
+
+	//Rotates v, translation is ignored
+	Vector3 transformDirection(const Vector3& v) const;
+
+	//Returns the variables as an array of 8 F32s, real x, y, z, w and dual x, y, z, w
+	const F32* toArray() const { return real.toArray(); }
+
+	//Returns the variables as an array of 8 F32s, real x, y, z, w and dual x, y, z, w
+	F32* toArray() { return real.toArray(); }
+
+
+	//Operator for printing DualQuaternions
+	friend std::ostream& operator <<(std::ostream& os, const DualQuaternion& d) {
+		os << std::fixed << "DualQuaternion: (" << d.real.x << ", " << d.real.y << ", " << d.real.z << ", " << d.real.w << ") + e("
+			<< d.dual.x << ", " << d.dual.y << ", " << d.dual.z << ", " << d.dual.w << ")" << std::endl;
+		return os;
+	}
+
+
+	Quaternion real, dual;
+};
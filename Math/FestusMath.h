@@ -10,7 +10,22 @@
 #include "Matrix4.h"
 #include "Matrix3.h"
 #include "Matrix2.h"
+#include "Affine3x4.h"
 #include "Quaternion.h"
+#include "DualQuaternion.h"
+#include "Transform.h"
+#include "AABB.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "BVH.h"
+#include "MathExpression.h"
+#include "MathBatch.h"
+#include "MathParallel.h"
+#include "Vector3Stream.h"
+#include "TransformHierarchy.h"
+#include "MathPacket.h"
+#include "Skinning.h"
+#include "MathFast.h"
 
 #include "DataTypedefs.h"
 #include "MathError.h"
@@ -83,8 +98,8 @@ namespace Math {
 	inline VectorT<s> lerp(const VectorT<s>& v1, const VectorT<s>& v2, F32 t) {
 		VectorT<s> res;
 
-		for (U32 i = 0; i < size; ++i)
-			res.setElement(i, lerp(v1[i], v2[i], t));
+		for (U32 i = 0; i < s; ++i)
+			res[i] = lerp(v1[i], v2[i], t);
 
 		return res;
 	}
@@ -141,13 +156,16 @@ namespace Math {
 		//If dot is negative, invert q2 so interpolation will follow the shortest path
 		if (dot < 0.f) {
 			q22 = -1 * q2;
-
+			dot = -dot;
 		}
 
+		//Account for floating-point errors
+		dot = min(dot, 1.f);
+
 
-		F32 angle = acosf(dot);
+		F32 angle = Math::trig::acos(dot);
 
-		F32 sina = sinf(angle);
+		F32 sina = Math::trig::sin(angle);
 
 		//Avoid dividing by 0, If they are pararell, just nlerp it
 		if (sina == 0.f) {
@@ -155,8 +173,8 @@ namespace Math {
 		}
 
 
-		F32 sinta = sinf(t * angle);
-		F32 sinomta = sinf((1.f - t) * angle);
+		F32 sinta = Math::trig::sin(t * angle);
+		F32 sinomta = Math::trig::sin((1.f - t) * angle);
 
 		Quaternion qq1 = (sinomta / sina) * q1;
 
@@ -180,40 +198,40 @@ namespace Math {
 	//Spherical interpolation of two vectors
 	inline Vector4 slerp(const Vector4& v1, const Vector4& v2, F32 t) {
 		F32 angle = Math::angle(v1, v2);
-		F32 sina = sinf(angle);
+		F32 sina = Math::trig::sin(angle);
 
 		if (sina == 0) {
 			return lerp(v1, v2, t);
 		}
 
 
-		return (sinf((1 - t) * angle) / sina) * v1 + (sinf(t * angle) / sina) * v2;
+		return (Math::trig::sin((1 - t) * angle) / sina) * v1 + (Math::trig::sin(t * angle) / sina) * v2;
 	}
 
 	//Spherical interpolation of two vectors
 	inline Vector3 slerp(const Vector3& v1, const Vector3& v2, F32 t) {
 		F32 angle = Math::angle(v1, v2);
-		F32 sina = sinf(angle);
+		F32 sina = Math::trig::sin(angle);
 
 		if (sina == 0) {
 			return lerp(v1, v2, t);
 		}
 
 
-		return (sinf((1 - t) * angle) / sina) * v1 + (sinf(t * angle) / sina) * v2;
+		return (Math::trig::sin((1 - t) * angle) / sina) * v1 + (Math::trig::sin(t * angle) / sina) * v2;
 	}
 
 	//Spherical interpolation of two vectors
 	inline Vector2 slerp(const Vector2& v1, const Vector2& v2, F32 t) {
 		F32 angle = Math::angle(v1, v2);
-		F32 sina = sinf(angle);
+		F32 sina = Math::trig::sin(angle);
 
 		if (sina == 0) {
 			return lerp(v1, v2, t);
 		}
 
 
-		return (sinf((1 - t) * angle) / sina) * v1 + (sinf(t * angle) / sina) * v2;
+		return (Math::trig::sin((1 - t) * angle) / sina) * v1 + (Math::trig::sin(t * angle) / sina) * v2;
 	}
 
 
@@ -221,14 +239,14 @@ namespace Math {
 	template<U32 size>
 	inline VectorT<size> slerp(const VectorT<size>& v1, const VectorT<size>& v2, F32 t) {
 		F32 angle = Math::angle(v1, v2);
-		F32 sina = sinf(angle);
+		F32 sina = Math::trig::sin(angle);
 
 		if (sina == 0) {
 			return lerp(v1, v2, t);
 		}
 
 
-		return (sinf((1 - t) * angle) / sina) * v1 + (sinf(t * angle) / sina) * v2;
+		return (Math::trig::sin((1 - t) * angle) / sina) * v1 + (Math::trig::sin(t * angle) / sina) * v2;
 	}
 
 
@@ -249,7 +267,7 @@ namespace Math {
 		F32 dot = v1.dot(v2);
 		//Account for F32ing-point errors
 		dot = clamp(dot, -1.f, 1.f);
-		return acosf(dot / v1.lenght() / v2.lenght());
+		return Math::trig::acos(dot / v1.lenght() / v2.lenght());
 
 	}
 
@@ -261,7 +279,7 @@ namespace Math {
 		F32 dot = v1.dot(v2);
 		//Account for F32ing-point errors
 		dot = clamp(dot, -1.f, 1.f);
-		return acosf(dot / v1.lenght() / v2.lenght());
+		return Math::trig::acos(dot / v1.lenght() / v2.lenght());
 	}
 
 	inline F32 angle(const Vector3& v1, const Vector3& v2) {
@@ -272,7 +290,7 @@ namespace Math {
 		F32 dot = v1.dot(v2);
 		//Account for F32ing-point errors
 		dot = clamp(dot, -1.f, 1.f);
-		return acosf(dot / v1.lenght() / v2.lenght());
+		return Math::trig::acos(dot / v1.lenght() / v2.lenght());
 	}
 
 	inline F32 angle(const Vector4& v1, const Vector4& v2) {
@@ -283,7 +301,7 @@ namespace Math {
 		F32 dot = v1.dot(v2);
 		//Account for F32ing-point errors
 		dot = clamp(dot, -1.f, 1.f);
-		return acosf(dot / v1.lenght() / v2.lenght());
+		return Math::trig::acos(dot / v1.lenght() / v2.lenght());
 	}
 
 
@@ -469,7 +487,7 @@ namespace Math {
 		//If they are not aligned, rotate them to align.
 		if (dot < 0.9999f) {
 
-			look.axisAngle(Vector3::WORLD_FORW.cross(forw), acosf(dot));
+			look.axisAngle(Vector3::WORLD_FORW.cross(forw), Math::trig::acos(dot));
 
 
 
@@ -479,7 +497,7 @@ namespace Math {
 
 		if (dot < 0.9999f) {
 
-			rot.axisAngle(Vector3::WORLD_UP.cross(up), acosf(dot));
+			rot.axisAngle(Vector3::WORLD_UP.cross(up), Math::trig::acos(dot));
 
 
 
@@ -503,10 +521,13 @@ namespace Math {
 		inline Matrix3 rotate(F32 angle) {
 			Matrix3 res;
 
-			res.setElement(0, 0, cosf(angle));
-			res.setElement(0, 1, -sinf(angle));
-			res.setElement(1, 0, sinf(angle));
-			res.setElement(1, 1, cosf(angle));
+			F32 s, c;
+			Math::trig::sincos(angle, s, c);
+
+			res.setElement(0, 0, c);
+			res.setElement(0, 1, -s);
+			res.setElement(1, 0, s);
+			res.setElement(1, 1, c);
 
 			return res;
 		}
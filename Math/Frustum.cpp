@@ -0,0 +1,92 @@
+#include "Frustum.h"
+#include "AABB.h"
+#include "BoundingSphere.h"
+#include "Matrix4.h"
+#include "Vector3Stream.h"
+#include "MathDispatch.h"
+#include "MathKernels.h"
+#include "MathError.h"
+#include <math.h>
+
+Frustum::Frustum()
+{
+	for (U32 i = 0; i < 24; ++i) planes[i] = i % 4 == 3 ? 1.f : 0.f;
+}
+
+//Gribb and Hartmann: clip space x, y, z and w of a point are the dot products of rows 0 to 3 of m with it,
+//so -w <= x becomes (row 3 + row 0) . p >= 0, x <= w becomes (row 3 - row 0) . p >= 0 and so on
+Frustum::Frustum(const Matrix4& m)
+{
+	for (U32 i = 0; i < PLANE_COUNT; ++i) {
+		const F32* row = m[i / 2];
+		const F32 sign = i % 2 == 0 ? 1.f : -1.f;
+		F32* p = planes + i * 4;
+
+		for (U32 c = 0; c < 4; ++c) p[c] = m[3][c] + sign * row[c];
+
+		const F32 len = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		if (len > 0.f) {
+			for (U32 c = 0; c < 4; ++c) p[c] /= len;
+		}
+	}
+}
+
+Vector4 Frustum::getPlane(U32 i) const
+{
+	if (i >= PLANE_COUNT) {
+		Math::mathError("ERROR: Tried to get plane other than 0 - 5 in Frustum\n");
+		return Vector4();
+	}
+
+	return Vector4(planes[i * 4], planes[i * 4 + 1], planes[i * 4 + 2], planes[i * 4 + 3]);
+}
+
+bool Frustum::contains(const Vector3& p) const
+{
+	for (U32 i = 0; i < 24; i += 4) {
+		if (planes[i] * p.x + planes[i + 1] * p.y + planes[i + 2] * p.z + planes[i + 3] < 0.f) return false;
+	}
+
+	return true;
+}
+
+bool Frustum::overlaps(const BoundingSphere& s) const
+{
+	if (s.isEmpty()) return false;
+
+	U32 index;
+	return Math::kernels::cullSpheresScalar(planes, &s.center.x, &s.center.y, &s.center.z, &s.radius, 1, &index) == 1;
+}
+
+bool Frustum::overlaps(const AABB& b) const
+{
+	if (b.isEmpty()) return false;
+
+	U32 index;
+	return Math::kernels::cullAABBsScalar(planes, &b.min.x, &b.min.y, &b.min.z, &b.max.x, &b.max.y, &b.max.z, 1, &index) == 1;
+}
+
+U32 Frustum::cullSpheres(const F32* x, const F32* y, const F32* z, const F32* radius, U32 count, U32* visible) const
+{
+	return Math::dispatch::kernels().cullSpheres(planes, x, y, z, radius, count, visible);
+}
+
+U32 Frustum::cullSpheres(const Vector3Stream& centers, const F32* radius, U32* visible) const
+{
+	return cullSpheres(centers.x(), centers.y(), centers.z(), radius, centers.size(), visible);
+}
+
+U32 Frustum::cullAABBs(const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible) const
+{
+	return Math::dispatch::kernels().cullAABBs(planes, minX, minY, minZ, maxX, maxY, maxZ, count, visible);
+}
+
+U32 Frustum::cullAABBs(const Vector3Stream& min, const Vector3Stream& max, U32* visible) const
+{
+	if (min.size() != max.size()) {
+		Math::mathError("ERROR: Tried to cull AABBs with different amounts of minimum and maximum corners in Frustum\n");
+		return 0;
+	}
+
+	return cullAABBs(min.x(), min.y(), min.z(), max.x(), max.y(), max.z(), min.size(), visible);
+}
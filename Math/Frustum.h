@@ -0,0 +1,74 @@
+#pragma once
+#include <iostream>
+#include "DataTypedefs.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+class Matrix4;
+class AABB;
+class BoundingSphere;
+class Vector3Stream;
+
+//Class that represents a view frustum as 6 planes. Takes 24 F32s, (a, b, c, d) of each plane.
+//The normals (a, b, c) have length 1 and point inside, so a * x + b * y + c * z + d is the signed distance of (x, y, z)
+//from the plane, and points with a non-negative distance from every plane are inside.
+//Objects are tested against each plane separately, so large objects near the corners can pass without touching the frustum.
+//That never culls anything visible.
+class Frustum {
+public:
+
+	//Indices of the planes
+	enum Plane { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+	//Frustum that contains everything
+	Frustum();
+
+	//Constructs the frustum of view-projection matrix m, whose clip space has -w <= x, y, z <= w as with
+	//Math::perspectiveMatrix and orthographicMatrix. A far plane at infinity contains everything
+	explicit Frustum(const Matrix4& m);
+
+
+	//Returns plane i as (a, b, c, d), see Plane
+	Vector4 getPlane(U32 i) const;
+
+	//Returns pointer to array of 24 elements, (a, b, c, d) of each plane
+	const F32* toArray() const { return planes; }
+
+
+	//Returns true if p is inside the frustum or on its surface
+	bool contains(const Vector3& p) const;
+
+	//Returns true if s is not fully outside any plane. Empty spheres overlap nothing
+	bool overlaps(const BoundingSphere& s) const;
+
+	//Returns true if b is not fully outside any plane. Empty boxes overlap nothing
+	bool overlaps(const AABB& b) const;
+
+
+	//Culls count spheres given as separate center x, y, z and radius arrays. Writes the indices of the spheres that
+	//overlap the frustum to visible in increasing order, and returns their amount. visible must have room for count indices
+	U32 cullSpheres(const F32* x, const F32* y, const F32* z, const F32* radius, U32 count, U32* visible) const;
+
+	//Culls the spheres of centers and radius, radius holds centers.size() F32s
+	U32 cullSpheres(const Vector3Stream& centers, const F32* radius, U32* visible) const;
+
+	//Culls count boxes given as separate arrays of the x, y and z of their minimum and maximum corners, same as cullSpheres()
+	U32 cullAABBs(const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible) const;
+
+	//Culls the boxes of corners min and max, which must be of the same size
+	U32 cullAABBs(const Vector3Stream& min, const Vector3Stream& max, U32* visible) const;
+
+
+	//Operator for printing Frustums
+	friend std::ostream& operator <<(std::ostream& os, const Frustum& f) {
+		for (U32 i = 0; i < PLANE_COUNT; ++i) {
+			const F32* p = f.planes + i * 4;
+			os << std::fixed << (i == 0 ? "Frustum: [" : "         [") << p[0] << ", " << p[1] << ", " << p[2] << ", " << p[3] << "]\n";
+		}
+
+		return os;
+	}
+
+private:
+	alignas(16) F32 planes[24];
+};
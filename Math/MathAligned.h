@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include "DataTypedefs.h"
+
+namespace Math {
+
+	//Returns size bytes aligned to alignment, a power of 2, or null if out of memory. Free with alignedFree.
+	//The block is allocated with malloc and over-allocated by alignment bytes. The pointer from malloc is stored right
+	//before the aligned data. Needed for over-aligned heap arrays, since new only aligns them from C++17
+	inline void* alignedMalloc(size_t size, size_t alignment)
+	{
+		void* raw = malloc(size + alignment + sizeof(void*));
+		if (!raw) return nullptr;
+
+		uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~uintptr_t(alignment - 1);
+		reinterpret_cast<void**>(p)[-1] = raw;
+		return reinterpret_cast<void*>(p);
+	}
+
+	//Frees a block of alignedMalloc. Null does nothing
+	inline void alignedFree(void* p)
+	{
+		if (p) free(reinterpret_cast<void**>(p)[-1]);
+	}
+
+}
+
+
+//Allocator for standard containers whose blocks are aligned to Alignment bytes, e.g. 64 so that arrays of 32-byte
+//objects never put one across two cache lines. Throws std::bad_alloc if out of memory
+template<class T, size_t Alignment>
+class AlignedAllocator {
+public:
+	typedef T value_type;
+
+	template<class U>
+	struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator() {}
+
+	template<class U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(size_t n) {
+		void* p = Math::alignedMalloc(sizeof(T) * n, Alignment);
+		if (!p) throw std::bad_alloc();
+		return static_cast<T*>(p);
+	}
+
+	void deallocate(T* p, size_t) {
+		Math::alignedFree(p);
+	}
+
+	template<class U>
+	bool operator ==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+	template<class U>
+	bool operator !=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
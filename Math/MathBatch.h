@@ -0,0 +1,301 @@
+#pragma once
+#include <vector>
+#include "DataTypedefs.h"
+#include "MathDispatch.h"
+#include "MathParallel.h"
+#include "Matrix4.h"
+#include "Affine3x4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "AABB.h"
+#include "BoundingSphere.h"
+
+//Operations on arrays of math types. They run on the best kernels the CPU supports, see MathDispatch.h.
+//The versions in Math::parallel split the arrays into chunks and run them on several threads, see MathParallel.h.
+
+namespace Math {
+
+	//Sets out[i] = a[i] * b[i] for count Quaternions. out may be a or b
+	inline void multiply(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+	{
+		dispatch::kernels().quatMul(a, b, out, count);
+	}
+
+	//Normalizes count Vector3s. Uses Math::rsqrt, relative error up to 2.7e-7
+	inline void normalize(Vector3* v, U32 count)
+	{
+		dispatch::kernels().vec3Normalize(v, count);
+	}
+
+	//Normalizes count Quaternions. The SIMD kernels use Math::rsqrt, relative error up to 2.7e-7
+	inline void normalize(Quaternion* q, U32 count)
+	{
+		dispatch::kernels().quatNormalize(q, count);
+	}
+
+	//Sets out[i] to nlerp(a[i], b[i], t[i]) for count Quaternions. out may be a or b
+	inline void nlerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+	{
+		dispatch::kernels().quatNlerp(a, b, t, out, count);
+	}
+
+	//Sets out[i] to slerp(a[i], b[i], t[i]) for count normalized Quaternions. out may be a or b.
+	//The SIMD kernels use the polynomials of Math::fast
+	inline void slerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+	{
+		dispatch::kernels().quatSlerp(a, b, t, out, count);
+	}
+
+	//Transforms count points by m, out[i] = m * (in[i], 1). out may be in
+	inline void transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+	{
+		dispatch::kernels().vec3TransformPoint(m.toArray(), in, out, count);
+	}
+
+	//Transforms count directions by m, out[i] = m * (in[i], 0). Translation is ignored. out may be in
+	inline void transformDirections(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+	{
+		dispatch::kernels().vec3TransformDir(m.toArray(), in, out, count);
+	}
+
+	//Transforms count points by affine m. out may be in
+	inline void transformPoints(const Affine3x4& m, const Vector3* in, Vector3* out, U32 count)
+	{
+		dispatch::kernels().vec3TransformPoint(m.toArray(), in, out, count);
+	}
+
+	//Transforms count directions by affine m. Translation is ignored. out may be in
+	inline void transformDirections(const Affine3x4& m, const Vector3* in, Vector3* out, U32 count)
+	{
+		dispatch::kernels().vec3TransformDir(m.toArray(), in, out, count);
+	}
+
+	//Transforms count points by m and divides them by the resulting w, e.g. to normalized device coordinates.
+	//Points with w = 0 become infinite or NaN. out may be in
+	inline void transformPointsProjective(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+	{
+		dispatch::kernels().vec3TransformProj(m.toArray(), in, out, count);
+	}
+
+	//Writes the rotations of count Quaternions to out as matrices of 16 row-major F32s.
+	//out must have room for 16 * count F32s
+	inline void toMatrices(const Quaternion* q, F32* out, U32 count)
+	{
+		dispatch::kernels().quatToMat4(q, nullptr, nullptr, out, count);
+	}
+
+	//Writes count affine matrices translation t[i] * rotation q[i] * scale s[i] to out as 16 row-major F32s each.
+	//t or s may be null for no translation or scale. out must have room for 16 * count F32s
+	inline void toMatrices(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count)
+	{
+		dispatch::kernels().quatToMat4(q, t, s, out, count);
+	}
+
+	//Writes the rotations of count matrices of 16 row-major F32s to out as normalized Quaternions.
+	//The matrices must not have scale or shear, translation is ignored
+	inline void toQuaternions(const F32* m, Quaternion* out, U32 count)
+	{
+		dispatch::kernels().mat4ToQuat(m, out, count);
+	}
+
+
+	//Transforms count boxes by affine m with Arvo's method, see AABB::transformed(). The boxes must not be empty. out may be in
+	inline void transformBounds(const Affine3x4& m, const AABB* in, AABB* out, U32 count)
+	{
+		dispatch::kernels().aabbTransform(m.toArray(), 0, in, out, count);
+	}
+
+	//Transforms count boxes by m, that must have a bottom row of (0, 0, 0, 1). The boxes must not be empty. out may be in
+	inline void transformBounds(const Matrix4& m, const AABB* in, AABB* out, U32 count)
+	{
+		dispatch::kernels().aabbTransform(m.toArray(), 0, in, out, count);
+	}
+
+	//Transforms box i by m[i] for count boxes, e.g. local bounds to world bounds. The boxes must not be empty. out may be in.
+	//m may be null if count is 0
+	inline void transformBounds(const Affine3x4* m, const AABB* in, AABB* out, U32 count)
+	{
+		if (count == 0) return;
+		dispatch::kernels().aabbTransform(m->toArray(), 12, in, out, count);
+	}
+
+	//Transforms count spheres by affine m, see BoundingSphere::transformed(). out may be in
+	inline void transformBounds(const Affine3x4& m, const BoundingSphere* in, BoundingSphere* out, U32 count)
+	{
+		dispatch::kernels().sphereTransform(m.toArray(), 0, in, out, count);
+	}
+
+	//Transforms count spheres by m, that must have a bottom row of (0, 0, 0, 1). out may be in
+	inline void transformBounds(const Matrix4& m, const BoundingSphere* in, BoundingSphere* out, U32 count)
+	{
+		dispatch::kernels().sphereTransform(m.toArray(), 0, in, out, count);
+	}
+
+	//Transforms sphere i by m[i] for count spheres. out may be in. m may be null if count is 0
+	inline void transformBounds(const Affine3x4* m, const BoundingSphere* in, BoundingSphere* out, U32 count)
+	{
+		if (count == 0) return;
+		dispatch::kernels().sphereTransform(m->toArray(), 12, in, out, count);
+	}
+
+	//Returns the bounds of count boxes. Empty if count is 0
+	inline AABB merge(const AABB* boxes, U32 count)
+	{
+		AABB res;
+		dispatch::kernels().aabbMerge(boxes, count, &res);
+		return res;
+	}
+
+	namespace fast {
+
+		//Approximate slerp for count normalized Quaternions: nlerp with t corrected by a polynomial, so that the rotation
+		//moves at nearly constant speed. The rotations differ from slerp by up to 8e-4 radians. out may be a or b
+		inline void slerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			dispatch::kernels().quatSlerpApprox(a, b, t, out, count);
+		}
+
+	}
+
+
+	//The operations above split into chunks of PARALLEL_CHUNK elements and run on the executor of Math::parallelFor.
+	//The results are bitwise the same as from the serial versions.
+	namespace parallel {
+
+		inline void multiply(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.quatMul(a + first, b + first, out + first, n); });
+		}
+
+		inline void normalize(Vector3* v, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3Normalize(v + first, n); });
+		}
+
+		inline void normalize(Quaternion* q, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.quatNormalize(q + first, n); });
+		}
+
+		inline void nlerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.quatNlerp(a + first, b + first, t + first, out + first, n); });
+		}
+
+		inline void slerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.quatSlerp(a + first, b + first, t + first, out + first, n); });
+		}
+
+		inline void transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3TransformPoint(e, in + first, out + first, n); });
+		}
+
+		inline void transformDirections(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3TransformDir(e, in + first, out + first, n); });
+		}
+
+		inline void transformPoints(const Affine3x4& m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3TransformPoint(e, in + first, out + first, n); });
+		}
+
+		inline void transformDirections(const Affine3x4& m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3TransformDir(e, in + first, out + first, n); });
+		}
+
+		inline void transformPointsProjective(const Matrix4& m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.vec3TransformProj(e, in + first, out + first, n); });
+		}
+
+		inline void toMatrices(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) {
+				k.quatToMat4(q + first, t ? t + first : nullptr, s ? s + first : nullptr, out + size_t(first) * 16, n);
+			});
+		}
+
+		inline void toMatrices(const Quaternion* q, F32* out, U32 count)
+		{
+			toMatrices(q, nullptr, nullptr, out, count);
+		}
+
+		inline void toQuaternions(const F32* m, Quaternion* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.mat4ToQuat(m + size_t(first) * 16, out + first, n); });
+		}
+
+		inline void transformBounds(const Affine3x4& m, const AABB* in, AABB* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.aabbTransform(e, 0, in + first, out + first, n); });
+		}
+
+		inline void transformBounds(const Affine3x4* m, const AABB* in, AABB* out, U32 count)
+		{
+			if (count == 0) return;
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.aabbTransform(m[first].toArray(), 12, in + first, out + first, n); });
+		}
+
+		inline void transformBounds(const Affine3x4& m, const BoundingSphere* in, BoundingSphere* out, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			const F32* e = m.toArray();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.sphereTransform(e, 0, in + first, out + first, n); });
+		}
+
+		inline void transformBounds(const Affine3x4* m, const BoundingSphere* in, BoundingSphere* out, U32 count)
+		{
+			if (count == 0) return;
+			const dispatch::Kernels& k = dispatch::kernels();
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.sphereTransform(m[first].toArray(), 12, in + first, out + first, n); });
+		}
+
+		//Merges each chunk on its own, then the bounds of the chunks
+		inline AABB merge(const AABB* boxes, U32 count)
+		{
+			const dispatch::Kernels& k = dispatch::kernels();
+			std::vector<AABB> chunks((count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK);
+			parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.aabbMerge(boxes + first, n, &chunks[first / PARALLEL_CHUNK]); });
+
+			AABB res;
+			k.aabbMerge(chunks.data(), U32(chunks.size()), &res);
+			return res;
+		}
+
+		namespace fast {
+
+			inline void slerp(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+			{
+				const dispatch::Kernels& k = dispatch::kernels();
+				parallelFor(count, PARALLEL_CHUNK, [&](U32 first, U32 n) { k.quatSlerpApprox(a + first, b + first, t + first, out + first, n); });
+			}
+
+		}
+
+	}
+
+}
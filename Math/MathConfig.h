@@ -0,0 +1,31 @@
+#pragma once
+
+//Build configuration of Math. Comment or uncomment the defines below to change how the library is built.
+
+
+//Matrix4 and Matrix3 get their elements from the MathMemoryManager pools instead of new[]
+#define MATH_CUSTOM_MEMORY
+
+//Matrix4 and Matrix3 store their elements inside the object instead of behind a pointer.
+//Matrices become trivially copyable and can be stored contiguously (std::vector<Matrix4>).
+//Takes precedence over MATH_CUSTOM_MEMORY for matrices, the memory pools stay usable on their own.
+//#define MATH_INLINE_MATRICES
+
+//Every thread allocates Matrix4 and Matrix3 elements from its own pools, without locking.
+//Blocks can be freed from any thread. Needs MATH_CUSTOM_MEMORY.
+//#define MATH_THREAD_LOCAL_POOLS
+
+//MathMemoryManager keeps counters of allocations, pool growth and reserved memory, and can sample allocation call stacks.
+//Adds atomic operations to every allocation. Needs MATH_CUSTOM_MEMORY.
+//#define MATH_MEMORY_STATS
+
+//Vector4 and Quaternion store their elements in an SSE register (__m128) and do their arithmetic with SIMD instructions.
+//x, y, z and w stay accessible as before. Both types become 16-byte aligned. Needs SSE2, ignored without it.
+//#define MATH_SIMD_VECTORS
+
+//Rotations, slerp and lookAt compute sin, cos and acos with the polynomials of Math::fast instead of the C library.
+//Faster, with absolute errors up to 3e-7 (see MathFast.h)
+//#define MATH_FAST_TRIG
+
+//Disables SSE/AVX code paths, everything runs on the scalar implementations
+//#define MATH_NO_SIMD
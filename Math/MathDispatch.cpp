@@ -0,0 +1,250 @@
+#include "MathDispatch.h"
+#include "MathKernels.h"
+#include "MathError.h"
+#include <cstdlib>
+#include <cstring>
+
+#ifdef MATH_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Math {
+	namespace dispatch {
+
+		using namespace Math::kernels;
+
+		//Kernels of every tier. Tiers without their own version of a kernel use the one of the tier below:
+		//the inverse gains nothing from wider registers, AVX-512 is not worth it for the normalize, transform, trigonometry, SoA, bounds and culling kernels,
+		//and SSE4.1 adds nothing the current kernels need.
+#ifdef MATH_SSE2
+		static const Kernels tierKernels[] = {
+			//SCALAR
+			{
+				mat4MulScalar, mat4MulIndexedScalar, mat4InverseScalar, quatMulScalar,
+				vec3NormalizeScalar, quatNormalizeScalar,
+				quatNlerpScalar, quatSlerpScalar, quatSlerpApproxScalar,
+				vec3TransformPointScalar, vec3TransformDirScalar, vec3TransformProjScalar,
+				quatToMat4Scalar, mat4ToQuatScalar,
+				skinScalar, skinDualQuatScalar,
+				fastSinCosScalar, fastAcosScalar, fastAtan2Scalar,
+				soaAddScalar, soaScaleScalar, soaLerpScalar, soaDot3Scalar, soaCross3Scalar, soaNormalize3Scalar,
+				aabbTransformScalar, sphereTransformScalar, aabbMergeScalar,
+				cullSpheresScalar, cullAABBsScalar,
+			},
+			//SSE2
+			{
+				mat4MulSSE2, mat4MulIndexedSSE2, mat4InverseSSE2, quatMulSSE2,
+				vec3NormalizeSSE2, quatNormalizeSSE2,
+				quatNlerpSSE2, quatSlerpSSE2, quatSlerpApproxSSE2,
+				vec3TransformPointSSE2, vec3TransformDirSSE2, vec3TransformProjSSE2,
+				quatToMat4SSE2, mat4ToQuatSSE2,
+				skinSSE2, skinDualQuatSSE2,
+				fastSinCosSSE2, fastAcosSSE2, fastAtan2SSE2,
+				soaAddSSE2, soaScaleSSE2, soaLerpSSE2, soaDot3SSE2, soaCross3SSE2, soaNormalize3SSE2,
+				aabbTransformSSE2, sphereTransformSSE2, aabbMergeSSE2,
+				cullSpheresSSE2, cullAABBsSSE2,
+			},
+			//SSE41
+			{
+				mat4MulSSE2, mat4MulIndexedSSE2, mat4InverseSSE2, quatMulSSE2,
+				vec3NormalizeSSE2, quatNormalizeSSE2,
+				quatNlerpSSE2, quatSlerpSSE2, quatSlerpApproxSSE2,
+				vec3TransformPointSSE2, vec3TransformDirSSE2, vec3TransformProjSSE2,
+				quatToMat4SSE2, mat4ToQuatSSE2,
+				skinSSE2, skinDualQuatSSE2,
+				fastSinCosSSE2, fastAcosSSE2, fastAtan2SSE2,
+				soaAddSSE2, soaScaleSSE2, soaLerpSSE2, soaDot3SSE2, soaCross3SSE2, soaNormalize3SSE2,
+				aabbTransformSSE2, sphereTransformSSE2, aabbMergeSSE2,
+				cullSpheresSSE2, cullAABBsSSE2,
+			},
+			//AVX2
+			{
+				mat4MulAVX2, mat4MulIndexedAVX2, mat4InverseSSE2, quatMulAVX2,
+				vec3NormalizeAVX2, quatNormalizeAVX2,
+				quatNlerpAVX2, quatSlerpAVX2, quatSlerpApproxAVX2,
+				vec3TransformPointAVX2, vec3TransformDirAVX2, vec3TransformProjAVX2,
+				quatToMat4AVX2, mat4ToQuatAVX2,
+				skinAVX2, skinDualQuatAVX2,
+				fastSinCosAVX2, fastAcosAVX2, fastAtan2AVX2,
+				soaAddAVX2, soaScaleAVX2, soaLerpAVX2, soaDot3AVX2, soaCross3AVX2, soaNormalize3AVX2,
+				aabbTransformAVX2, sphereTransformAVX2, aabbMergeAVX2,
+				cullSpheresAVX2, cullAABBsAVX2,
+			},
+			//AVX512
+			{
+				mat4MulAVX512, mat4MulIndexedAVX512, mat4InverseSSE2, quatMulAVX512,
+				vec3NormalizeAVX2, quatNormalizeAVX2,
+				quatNlerpAVX2, quatSlerpAVX2, quatSlerpApproxAVX2,
+				vec3TransformPointAVX2, vec3TransformDirAVX2, vec3TransformProjAVX2,
+				quatToMat4AVX2, mat4ToQuatAVX2,
+				skinAVX2, skinDualQuatAVX2,
+				fastSinCosAVX2, fastAcosAVX2, fastAtan2AVX2,
+				soaAddAVX2, soaScaleAVX2, soaLerpAVX2, soaDot3AVX2, soaCross3AVX2, soaNormalize3AVX2,
+				aabbTransformAVX2, sphereTransformAVX2, aabbMergeAVX2,
+				cullSpheresAVX2, cullAABBsAVX2,
+			},
+		};
+#else
+		static const Kernels tierKernels[] = {
+			//SCALAR
+			{
+				mat4MulScalar, mat4MulIndexedScalar, mat4InverseScalar, quatMulScalar,
+				vec3NormalizeScalar, quatNormalizeScalar,
+				quatNlerpScalar, quatSlerpScalar, quatSlerpApproxScalar,
+				vec3TransformPointScalar, vec3TransformDirScalar, vec3TransformProjScalar,
+				quatToMat4Scalar, mat4ToQuatScalar,
+				skinScalar, skinDualQuatScalar,
+				fastSinCosScalar, fastAcosScalar, fastAtan2Scalar,
+				soaAddScalar, soaScaleScalar, soaLerpScalar, soaDot3Scalar, soaCross3Scalar, soaNormalize3Scalar,
+				aabbTransformScalar, sphereTransformScalar, aabbMergeScalar,
+				cullSpheresScalar, cullAABBsScalar,
+			},
+		};
+#endif
+
+		static const U32 TIER_COUNT = 5;
+
+		static const char* const tierNames[TIER_COUNT] = { "scalar", "sse2", "sse41", "avx2", "avx512" };
+
+		std::atomic<const Kernels*> currentKernels(nullptr);
+
+		static std::atomic<Tier> currentTier(SCALAR);
+
+
+#ifdef MATH_SSE2
+
+		//Returns eax, ebx, ecx and edx of cpuid leaf and subleaf
+		static void cpuid(U32 leaf, U32 subleaf, U32 regs[4])
+		{
+#if defined(_MSC_VER)
+			int r[4];
+			__cpuidex(r, int(leaf), int(subleaf));
+			for (U32 i = 0; i < 4; ++i) regs[i] = U32(r[i]);
+#else
+			unsigned int a = 0, b = 0, c = 0, d = 0;
+			__cpuid_count(leaf, subleaf, a, b, c, d);
+			regs[0] = a; regs[1] = b; regs[2] = c; regs[3] = d;
+#endif
+		}
+
+		//Returns the register states the OS saves on context switches (XCR0)
+		static U64 xgetbv0()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			U32 a, d;
+			__asm__ volatile("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+			return (U64(d) << 32) | a;
+#endif
+		}
+
+#endif
+
+		Tier detectedTier()
+		{
+#ifdef MATH_SSE2
+			U32 regs[4];
+
+			cpuid(0, 0, regs);
+			const U32 maxLeaf = regs[0];
+
+			cpuid(1, 0, regs);
+			const bool sse2 = (regs[3] & (1u << 26)) != 0;
+			const bool sse41 = (regs[2] & (1u << 19)) != 0;
+			const bool fma = (regs[2] & (1u << 12)) != 0;
+			const bool osxsave = (regs[2] & (1u << 27)) != 0;
+			const bool avx = (regs[2] & (1u << 28)) != 0;
+
+			bool avx2 = false, avx512 = false;
+			if (maxLeaf >= 7) {
+				cpuid(7, 0, regs);
+				avx2 = (regs[1] & (1u << 5)) != 0;
+				avx512 = (regs[1] & (1u << 16)) != 0;
+			}
+
+			//AVX registers are only usable if the OS saves them: XMM and YMM state, and for AVX-512 also opmask and ZMM state
+			const U64 xcr0 = osxsave ? xgetbv0() : 0;
+			const bool osAVX = (xcr0 & 0x6) == 0x6;
+			const bool osAVX512 = (xcr0 & 0xE6) == 0xE6;
+
+			if (avx && avx2 && fma && avx512 && osAVX512) return AVX512;
+			if (avx && avx2 && fma && osAVX) return AVX2;
+			if (sse41) return SSE41;
+			if (sse2) return SSE2;
+#endif
+			return SCALAR;
+		}
+
+		//Returns the kernels of t
+		static const Kernels* kernelsOf(Tier t)
+		{
+#ifdef MATH_SSE2
+			return &tierKernels[t];
+#else
+			(void)t;
+			return &tierKernels[0];
+#endif
+		}
+
+		void setTier(Tier t)
+		{
+			const Tier best = detectedTier();
+			if (t > best) {
+				Math::mathError(std::string("ERROR: CPU does not support math tier ") + tierName(t) + ", using " + tierName(best) + "\n");
+				t = best;
+			}
+
+			currentTier.store(t, std::memory_order_relaxed);
+			currentKernels.store(kernelsOf(t), std::memory_order_release);
+		}
+
+		const Kernels& selectKernels()
+		{
+			Tier t = detectedTier();
+
+			char* forced = nullptr;
+#if defined(_MSC_VER)
+			size_t len;
+			_dupenv_s(&forced, &len, "MATH_FORCE_TIER");
+#else
+			forced = getenv("MATH_FORCE_TIER");
+#endif
+
+			if (forced && forced[0]) {
+				U32 i = 0;
+				while (i < TIER_COUNT && strcmp(forced, tierNames[i]) != 0) ++i;
+
+				if (i < TIER_COUNT) {
+					t = Tier(i);
+				}
+				else {
+					Math::mathError(std::string("ERROR: Unknown MATH_FORCE_TIER ") + forced + "\n");
+				}
+			}
+
+#if defined(_MSC_VER)
+			free(forced);
+#endif
+
+			setTier(t);
+			return *currentKernels.load(std::memory_order_acquire);
+		}
+
+		Tier tier()
+		{
+			kernels();
+			return currentTier.load(std::memory_order_relaxed);
+		}
+
+		const char* tierName(Tier t)
+		{
+			return U32(t) < TIER_COUNT ? tierNames[t] : "unknown";
+		}
+
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include "MathConfig.h"
+#include "DataTypedefs.h"
+
+class Quaternion;
+class Vector3;
+class AABB;
+class BoundingSphere;
+
+//Runtime selection of the math kernels. On first use the CPU is checked with cpuid, and every kernel is routed to
+//the best implementation the CPU supports, so one binary runs well on all x86 hosts.
+//Environment variable MATH_FORCE_TIER (scalar, sse2, sse41, avx2 or avx512) limits the tier, e.g. for benchmarking.
+//With MATH_NO_SIMD, or on other CPUs than x86, everything runs on the scalar kernels.
+namespace Math {
+	namespace dispatch {
+
+		//Instruction set levels, each includes the ones below it. AVX2 also requires FMA, AVX512 means AVX-512F.
+		enum Tier { SCALAR, SSE2, SSE41, AVX2, AVX512 };
+
+		//Kernels of one tier. Matrices are 16 row-major F32s.
+		struct Kernels {
+			//Multiplies a and b to out. out may be a or b
+			void (*mat4Mul)(const F32* a, const F32* b, F32* out);
+
+			//Sets matrix i of out to matrix aIdx[i] of a times matrix i of b, for count matrices in order.
+			//a may be out, as long as aIdx[i] refers to a matrix before i
+			void (*mat4MulIndexed)(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count);
+
+			//Inverts m to out. Returns false if m is singular. out may not be m
+			bool (*mat4Inverse)(const F32* m, F32* out);
+
+			//Sets out[i] = a[i] * b[i] for count Quaternions. out may be a or b
+			void (*quatMul)(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count);
+
+			//Normalizes count Vector3s
+			void (*vec3Normalize)(Vector3* v, U32 count);
+
+			//Normalizes count Quaternions
+			void (*quatNormalize)(Quaternion* q, U32 count);
+
+			//Blend a[i] and b[i] by t[i] to out[i] for count Quaternions, see Math::nlerp, slerp and fast::slerp in MathBatch.h.
+			//out may be a or b
+			void (*quatNlerp)(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+			void (*quatSlerp)(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+			void (*quatSlerpApprox)(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+
+			//Transforms count Vector3s by matrix m as points (w = 1), directions (w = 0), or points with division by
+			//the resulting w. Points and directions read only the top 3 rows of m. out may be in
+			void (*vec3TransformPoint)(const F32* m, const Vector3* in, Vector3* out, U32 count);
+			void (*vec3TransformDir)(const F32* m, const Vector3* in, Vector3* out, U32 count);
+			void (*vec3TransformProj)(const F32* m, const Vector3* in, Vector3* out, U32 count);
+
+			//Writes count matrices translation t[i] * rotation q[i] * scale s[i] to out, 16 F32s each. t and s may be null
+			void (*quatToMat4)(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count);
+
+			//Writes the rotations of count matrices as Quaternions to out
+			void (*mat4ToQuat)(const F32* m, Quaternion* out, U32 count);
+
+			//Linear blend skinning of count vertices with influences bones each, see Math::skin in Skinning.h.
+			//palette holds 16 F32s per bone, the bone matrix transposed. nrm and outNrm may be null. Outputs may be inputs
+			void (*skin)(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+
+			//Dual quaternion skinning, the same as skin, but palette holds DualQuaternions, 8 F32s per bone
+			void (*skinDualQuat)(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+
+			//Math::fast::sincos, acos and atan2 for count values
+			void (*fastSinCos)(const F32* x, F32* s, F32* c, U32 count);
+			void (*fastAcos)(const F32* x, F32* out, U32 count);
+			void (*fastAtan2)(const F32* y, const F32* x, F32* out, U32 count);
+
+			//Structure-of-arrays kernels on arrays of count F32s, used by Vector3Stream. Outputs may be inputs.
+			//out = a + b, out = a * s, out = (1 - t) * a + t * b
+			void (*soaAdd)(const F32* a, const F32* b, F32* out, U32 count);
+			void (*soaScale)(const F32* a, F32 s, F32* out, U32 count);
+			void (*soaLerp)(const F32* a, const F32* b, F32 t, F32* out, U32 count);
+
+			//Dot and cross products of Vector3s given as separate x, y and z arrays
+			void (*soaDot3)(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count);
+			void (*soaCross3)(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count);
+
+			//Normalizes Vector3s given as separate x, y and z arrays
+			void (*soaNormalize3)(F32* x, F32* y, F32* z, U32 count);
+
+			//Transforms count boxes or spheres by the top 3 rows of affine matrices, see Math::transformBounds in MathBatch.h.
+			//Object i uses the matrix at m + i * mStride, so mStride 0 transforms all by one matrix. out may be in
+			void (*aabbTransform)(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count);
+			void (*sphereTransform)(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count);
+
+			//Writes the bounds of count boxes to out
+			void (*aabbMerge)(const AABB* in, U32 count, AABB* out);
+
+			//Frustum culling of count spheres or boxes given as separate arrays of their components, see Frustum.
+			//planes holds (a, b, c, d) of 6 planes with normals pointing inside. Writes the indices of the objects not fully outside
+			//any plane to visible in increasing order and returns their amount
+			U32 (*cullSpheres)(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible);
+			U32 (*cullAABBs)(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible);
+		};
+
+		//Kernels in use, null until the first call to kernels()
+		extern std::atomic<const Kernels*> currentKernels;
+
+		//Detects the tier, applies MATH_FORCE_TIER and returns the kernels
+		const Kernels& selectKernels();
+
+		//Returns the kernels of the current tier
+		inline const Kernels& kernels()
+		{
+			const Kernels* k = currentKernels.load(std::memory_order_acquire);
+			return k ? *k : selectKernels();
+		}
+
+		//Returns the tier in use
+		Tier tier();
+
+		//Returns the best tier the CPU and the OS support
+		Tier detectedTier();
+
+		//Uses tier t, or the detected tier if the CPU does not support t. Kernels already running on other threads finish on the old tier
+		void setTier(Tier t);
+
+		//Returns the name of t, as used in MATH_FORCE_TIER
+		const char* tierName(Tier t);
+
+	}
+}
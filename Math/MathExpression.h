@@ -0,0 +1,328 @@
+#pragma once
+#include <cstring>
+#include "DataTypedefs.h"
+#include "Matrix4.h"
+#include "Matrix3.h"
+#include "Vector4.h"
+#include "Vector3.h"
+#include "MathDispatch.h"
+#include "MathKernels.h"
+
+//Lazy arithmetic for Matrix4, Matrix3, Vector4 and Vector3. Start an expression with Math::expr(x).
+//Element-wise chains (+, -, scaling) are evaluated in one pass without temporary matrices, and a chain of matrix products
+//multiplied by a vector is evaluated right to left as matrix-vector products, so no 4x4 product is ever built for it.
+//Products that are built use the dispatched Matrix4 kernel (Math::dispatch) and read existing matrices in place.
+//Expressions refer to their operands, so evaluate them in the same statement instead of storing them with auto.
+//
+//	Vector4 p = Math::expr(proj) * view * model * v;
+//	Matrix4 m = Math::expr(a) + Math::expr(b) * 2.f - c;
+//	Math::expr(a).assignTo(a);
+
+namespace Math {
+	namespace expression {
+
+		//Dimensions of the types expressions work with. Vectors are columns.
+		template<class T> struct Traits;
+		template<> struct Traits<Matrix4> { static const U32 ROWS = 4, COLS = 4, SIZE = 16; };
+		template<> struct Traits<Matrix3> { static const U32 ROWS = 3, COLS = 3, SIZE = 9; };
+		template<> struct Traits<Vector4> { static const U32 ROWS = 4, COLS = 1, SIZE = 4; };
+		template<> struct Traits<Vector3> { static const U32 ROWS = 3, COLS = 1, SIZE = 3; };
+
+
+		//Base of all expressions. E is the node type and T the type the expression evaluates to.
+		template<class E, class T>
+		class Expr {
+		public:
+			typedef T Type;
+
+			const E& self() const { return static_cast<const E&>(*this); }
+
+			//Evaluates the expression
+			T eval() const
+			{
+				T res;
+				self().evalTo(res.toArray());
+				return res;
+			}
+
+			//Evaluates the expression straight to target. Target may be an operand of the expression.
+			void assignTo(T& target) const
+			{
+				self().evalTo(target.toArray());
+			}
+
+			operator T() const { return eval(); }
+		};
+
+
+		//Multiplies row-major matrix m by vector v
+		template<U32 N>
+		inline void multiplyVector(const F32* m, const F32* v, F32* out)
+		{
+			for (U32 r = 0; r < N; ++r) {
+				F32 sum = 0.f;
+				for (U32 c = 0; c < N; ++c) {
+					sum += m[r * N + c] * v[c];
+				}
+				out[r] = sum;
+			}
+		}
+
+		//Multiplies row-major NxN matrices a and b. out may be a or b
+		template<U32 N>
+		inline void multiplyMatrix(const F32* a, const F32* b, F32* out);
+
+		template<>
+		inline void multiplyMatrix<4>(const F32* a, const F32* b, F32* out) { Math::dispatch::kernels().mat4Mul(a, b, out); }
+
+		template<>
+		inline void multiplyMatrix<3>(const F32* a, const F32* b, F32* out) { Math::kernels::mat3MulScalar(a, b, out); }
+
+		//Matrix-vector product of an element-wise expression, reading its elements one by one
+		template<class E>
+		inline void elementwiseMulVector(const E& e, const F32* v, F32* out)
+		{
+			const U32 N = Traits<typename E::Type>::COLS;
+			for (U32 r = 0; r < N; ++r) {
+				F32 sum = 0.f;
+				for (U32 c = 0; c < N; ++c) {
+					sum += e.element(r * N + c) * v[c];
+				}
+				out[r] = sum;
+			}
+		}
+
+
+		//Operand of an element-wise node. Element-wise expressions are read lazily,
+		//others (products) are evaluated once into a local buffer.
+		template<class E, bool = E::ELEMENTWISE>
+		class Operand {
+		public:
+			explicit Operand(const E& e) : e(e) {}
+
+			F32 element(U32 i) const { return e.element(i); }
+
+		private:
+			E e;
+		};
+
+		template<class E>
+		class Operand<E, false> {
+		public:
+			explicit Operand(const E& e) { e.evalTo(data); }
+
+			F32 element(U32 i) const { return data[i]; }
+
+		private:
+			F32 data[Traits<typename E::Type>::SIZE];
+		};
+
+
+		//Existing Matrix4, Matrix3, Vector4 or Vector3
+		template<class T>
+		class Leaf : public Expr<Leaf<T>, T> {
+		public:
+			static const bool ELEMENTWISE = true;
+
+			explicit Leaf(const T& t) : data(t.toArray()) {}
+
+			F32 element(U32 i) const { return data[i]; }
+
+			//Returns the elements of the operand
+			const F32* elements() const { return data; }
+
+			void evalTo(F32* out) const
+			{
+				if (out != data) memcpy(out, data, sizeof(F32) * Traits<T>::SIZE);
+			}
+
+			void mulVector(const F32* v, F32* out) const { multiplyVector<Traits<T>::COLS>(data, v, out); }
+
+		private:
+			const F32* data;
+		};
+
+
+		//Returns the elements of e: existing matrices are read in place, other expressions are evaluated to buffer
+		template<class E>
+		inline const F32* evalOperand(const E& e, F32* buffer)
+		{
+			e.evalTo(buffer);
+			return buffer;
+		}
+
+		template<class T>
+		inline const F32* evalOperand(const Leaf<T>& e, F32*) { return e.elements(); }
+
+
+		struct Add { static F32 apply(F32 a, F32 b) { return a + b; } };
+		struct Sub { static F32 apply(F32 a, F32 b) { return a - b; } };
+
+		//Element-wise addition or subtraction
+		template<class L, class R, class Op, class T>
+		class Binary : public Expr<Binary<L, R, Op, T>, T> {
+		public:
+			static const bool ELEMENTWISE = true;
+
+			Binary(const L& l, const R& r) : l(l), r(r) {}
+
+			F32 element(U32 i) const { return Op::apply(l.element(i), r.element(i)); }
+
+			void evalTo(F32* out) const
+			{
+				for (U32 i = 0; i < Traits<T>::SIZE; ++i) {
+					out[i] = element(i);
+				}
+			}
+
+			void mulVector(const F32* v, F32* out) const { elementwiseMulVector(*this, v, out); }
+
+		private:
+			Operand<L> l;
+			Operand<R> r;
+		};
+
+		//Expression multiplied by a scalar
+		template<class E, class T>
+		class Scaled : public Expr<Scaled<E, T>, T> {
+		public:
+			static const bool ELEMENTWISE = true;
+
+			Scaled(const E& e, F32 f) : e(e), f(f) {}
+
+			F32 element(U32 i) const { return e.element(i) * f; }
+
+			void evalTo(F32* out) const
+			{
+				for (U32 i = 0; i < Traits<T>::SIZE; ++i) {
+					out[i] = element(i);
+				}
+			}
+
+			void mulVector(const F32* v, F32* out) const { elementwiseMulVector(*this, v, out); }
+
+		private:
+			Operand<E> e;
+			F32 f;
+		};
+
+		//Matrix product. Evaluated when it is needed as a matrix; multiplied by a vector it becomes two matrix-vector products.
+		template<class L, class R, class T>
+		class Product : public Expr<Product<L, R, T>, T> {
+		public:
+			static const bool ELEMENTWISE = false;
+
+			static_assert(Traits<T>::COLS > 1, "Product of expressions needs matrices");
+
+			Product(const L& l, const R& r) : l(l), r(r) {}
+
+			void evalTo(F32* out) const
+			{
+				F32 a[Traits<T>::SIZE], b[Traits<T>::SIZE];
+				const F32* pa = evalOperand(l, a);
+				const F32* pb = evalOperand(r, b);
+				multiplyMatrix<Traits<T>::COLS>(pa, pb, out);
+			}
+
+			void mulVector(const F32* v, F32* out) const
+			{
+				F32 tmp[Traits<T>::COLS];
+				r.mulVector(v, tmp);
+				l.mulVector(tmp, out);
+			}
+
+		private:
+			L l;
+			R r;
+		};
+
+		//Matrix expression multiplied by a vector expression
+		template<class M, class V, class T>
+		class MatrixVector : public Expr<MatrixVector<M, V, T>, T> {
+		public:
+			static const bool ELEMENTWISE = false;
+
+			static_assert(Traits<typename M::Type>::COLS == Traits<T>::SIZE, "Matrix and vector sizes don't match");
+
+			MatrixVector(const M& m, const V& v) : m(m), v(v) {}
+
+			void evalTo(F32* out) const
+			{
+				F32 vec[Traits<T>::SIZE];
+				v.evalTo(vec);
+				m.mulVector(vec, out);
+			}
+
+		private:
+			M m;
+			V v;
+		};
+
+
+		//Element-wise operators
+
+		template<class E1, class E2, class T>
+		inline Binary<E1, E2, Add, T> operator +(const Expr<E1, T>& a, const Expr<E2, T>& b) { return Binary<E1, E2, Add, T>(a.self(), b.self()); }
+
+		template<class E, class T>
+		inline Binary<E, Leaf<T>, Add, T> operator +(const Expr<E, T>& a, const T& b) { return Binary<E, Leaf<T>, Add, T>(a.self(), Leaf<T>(b)); }
+
+		template<class E, class T>
+		inline Binary<Leaf<T>, E, Add, T> operator +(const T& a, const Expr<E, T>& b) { return Binary<Leaf<T>, E, Add, T>(Leaf<T>(a), b.self()); }
+
+		template<class E1, class E2, class T>
+		inline Binary<E1, E2, Sub, T> operator -(const Expr<E1, T>& a, const Expr<E2, T>& b) { return Binary<E1, E2, Sub, T>(a.self(), b.self()); }
+
+		template<class E, class T>
+		inline Binary<E, Leaf<T>, Sub, T> operator -(const Expr<E, T>& a, const T& b) { return Binary<E, Leaf<T>, Sub, T>(a.self(), Leaf<T>(b)); }
+
+		template<class E, class T>
+		inline Binary<Leaf<T>, E, Sub, T> operator -(const T& a, const Expr<E, T>& b) { return Binary<Leaf<T>, E, Sub, T>(Leaf<T>(a), b.self()); }
+
+		template<class E, class T>
+		inline Scaled<E, T> operator *(const Expr<E, T>& e, F32 f) { return Scaled<E, T>(e.self(), f); }
+
+		template<class E, class T>
+		inline Scaled<E, T> operator *(F32 f, const Expr<E, T>& e) { return Scaled<E, T>(e.self(), f); }
+
+		template<class E, class T>
+		inline Scaled<E, T> operator /(const Expr<E, T>& e, F32 f) { return Scaled<E, T>(e.self(), 1.f / f); }
+
+		template<class E, class T>
+		inline Scaled<E, T> operator -(const Expr<E, T>& e) { return Scaled<E, T>(e.self(), -1.f); }
+
+
+		//Matrix products
+
+		template<class E1, class E2, class T>
+		inline Product<E1, E2, T> operator *(const Expr<E1, T>& a, const Expr<E2, T>& b) { return Product<E1, E2, T>(a.self(), b.self()); }
+
+		template<class E, class T>
+		inline Product<E, Leaf<T>, T> operator *(const Expr<E, T>& a, const T& b) { return Product<E, Leaf<T>, T>(a.self(), Leaf<T>(b)); }
+
+		template<class E, class T>
+		inline Product<Leaf<T>, E, T> operator *(const T& a, const Expr<E, T>& b) { return Product<Leaf<T>, E, T>(Leaf<T>(a), b.self()); }
+
+
+		//Matrix-vector products
+
+		template<class M, class V>
+		inline MatrixVector<M, V, Vector4> operator *(const Expr<M, Matrix4>& m, const Expr<V, Vector4>& v) { return MatrixVector<M, V, Vector4>(m.self(), v.self()); }
+
+		template<class M>
+		inline MatrixVector<M, Leaf<Vector4>, Vector4> operator *(const Expr<M, Matrix4>& m, const Vector4& v) { return MatrixVector<M, Leaf<Vector4>, Vector4>(m.self(), Leaf<Vector4>(v)); }
+
+		template<class M, class V>
+		inline MatrixVector<M, V, Vector3> operator *(const Expr<M, Matrix3>& m, const Expr<V, Vector3>& v) { return MatrixVector<M, V, Vector3>(m.self(), v.self()); }
+
+		template<class M>
+		inline MatrixVector<M, Leaf<Vector3>, Vector3> operator *(const Expr<M, Matrix3>& m, const Vector3& v) { return MatrixVector<M, Leaf<Vector3>, Vector3>(m.self(), Leaf<Vector3>(v)); }
+
+	}
+
+
+	//Starts a lazy expression from Matrix4, Matrix3, Vector4 or Vector3
+	template<class T>
+	inline expression::Leaf<T> expr(const T& t) { return expression::Leaf<T>(t); }
+
+}
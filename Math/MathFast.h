@@ -0,0 +1,372 @@
+#pragma once
+#include <math.h>
+#include <cmath>
+#include "MathSIMD.h"
+#include "MathDispatch.h"
+#include "DataTypedefs.h"
+
+#ifdef MATH_SSE2
+#include <immintrin.h>
+#endif
+
+//Fast polynomial approximations of sin, cos, acos and atan2 (Cephes single precision coefficients), one value at a time,
+//4 at a time in __m128, 8 at a time in __m256 (AVX2 and FMA) and for whole arrays on the best kernels of the CPU.
+//Largest absolute errors against double precision, measured over the whole domain:
+//	sincos: 9.5e-8 for |x| <= 8192, 1e-6 for |x| <= 1e5. The range reduction loses accuracy for larger x, and past 2^31 * PI / 2 results are garbage.
+//	acos: 3e-7. x is clamped to [-1, 1]
+//	atan2: 2.7e-7. atan2(0, 0) is 0, infinite x and y together give NaN
+//The C library is within 3.3e-8. Signs of zero are not always those of the C library.
+
+namespace Math {
+	namespace fast {
+
+		namespace constants {
+			const F32 TWO_OVER_PI = 0.636619772367581343f;
+
+			//PI / 2 split to three parts, PIO2_1 and PIO2_2 with few bits so that multiplying them by the quadrant is exact
+			const F32 PIO2_1 = 1.5703125f;
+			const F32 PIO2_2 = 4.837512969970703125e-4f;
+			const F32 PIO2_3 = 7.54978995489188216e-8f;
+
+			const F32 PI_F = 3.14159265358979323846f;
+			const F32 PI_2 = 1.57079632679489661923f;
+			const F32 PI_4 = 0.785398163397448309616f;
+			const F32 TAN_PI_8 = 0.414213562373095048802f;
+
+			//sin(r) = r + r^3 * S(r^2), cos(r) = 1 - r^2 / 2 + r^4 * C(r^2) on [-PI / 4, PI / 4]
+			const F32 S0 = -1.6666654611e-1f, S1 = 8.3321608736e-3f, S2 = -1.9515295891e-4f;
+			const F32 C0 = 4.166664568298827e-2f, C1 = -1.388731625493765e-3f, C2 = 2.443315711809948e-5f;
+
+			//asin(x) = x + x^3 * A(x^2) on [0, 0.5]
+			const F32 A0 = 1.6666752422e-1f, A1 = 7.4953002686e-2f, A2 = 4.5470025998e-2f, A3 = 2.4181311049e-2f, A4 = 4.2163199048e-2f;
+
+			//atan(x) = x + x^3 * T(x^2) on [0, tan(PI / 8)]
+			const F32 T0 = -3.33329491539e-1f, T1 = 1.99777106478e-1f, T2 = -1.38776856032e-1f, T3 = 8.05374449538e-2f;
+		}
+
+
+		//Sets s to sin(x) and c to cos(x)
+		inline void sincos(F32 x, F32& s, F32& c)
+		{
+			using namespace constants;
+
+			//Quadrant and the remainder in it
+			const I32 q = I32(x * TWO_OVER_PI + (x < 0.f ? -0.5f : 0.5f));
+			const F32 j = F32(q);
+			const F32 r = ((x - j * PIO2_1) - j * PIO2_2) - j * PIO2_3;
+			const F32 z = r * r;
+
+			const F32 ps = r + r * z * ((S2 * z + S1) * z + S0);
+			const F32 pc = 1.f - 0.5f * z + z * z * ((C2 * z + C1) * z + C0);
+
+			s = (q & 1) ? pc : ps;
+			c = (q & 1) ? ps : pc;
+
+			if (q & 2) s = -s;
+			if ((q + 1) & 2) c = -c;
+		}
+
+		//Returns sin(x)
+		inline F32 sin(F32 x)
+		{
+			F32 s, c;
+			sincos(x, s, c);
+			return s;
+		}
+
+		//Returns cos(x)
+		inline F32 cos(F32 x)
+		{
+			F32 s, c;
+			sincos(x, s, c);
+			return c;
+		}
+
+		//Returns acos(x)
+		inline F32 acos(F32 x)
+		{
+			using namespace constants;
+
+			F32 a = fabsf(x);
+			if (a > 1.f) a = 1.f;
+
+			//Near 1, acos(a) = 2 * asin(sqrt((1 - a) / 2))
+			const bool big = a > 0.5f;
+			const F32 z = big ? 0.5f * (1.f - a) : a * a;
+			const F32 s = big ? sqrtf(z) : a;
+			const F32 p = s + s * z * ((((A4 * z + A3) * z + A2) * z + A1) * z + A0);
+
+			if (big) return x < 0.f ? PI_F - 2.f * p : 2.f * p;
+			return x < 0.f ? PI_2 + p : PI_2 - p;
+		}
+
+		//Returns atan2(y, x)
+		inline F32 atan2(F32 y, F32 x)
+		{
+			using namespace constants;
+
+			const F32 ax = fabsf(x), ay = fabsf(y);
+			const F32 mx = ax > ay ? ax : ay;
+			const F32 mn = ax > ay ? ay : ax;
+
+			//atan of the smaller ratio, over tan(PI / 8) through atan(t) = PI / 4 + atan((t - 1) / (t + 1))
+			F32 t = mx == 0.f ? 0.f : mn / mx;
+			F32 r = 0.f;
+			if (t > TAN_PI_8) {
+				t = (t - 1.f) / (t + 1.f);
+				r = PI_4;
+			}
+
+			const F32 z = t * t;
+			r += t + t * z * (((T3 * z + T2) * z + T1) * z + T0);
+
+			if (ay > ax) r = PI_2 - r;
+			if (std::signbit(x)) r = PI_F - r;
+			return std::signbit(y) ? -r : r;
+		}
+
+
+#ifdef MATH_SSE2
+
+		//Sets s to sin(x) and c to cos(x) for 4 values
+		inline void sincos(__m128 x, __m128& s, __m128& c)
+		{
+			using namespace constants;
+			using namespace Math::simd;
+
+			const __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+			const __m128 j = _mm_cvtepi32_ps(q);
+
+			__m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(PIO2_1)));
+			r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PIO2_2)));
+			r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PIO2_3)));
+			const __m128 z = _mm_mul_ps(r, r);
+
+			__m128 ps = madd(_mm_set1_ps(S2), z, _mm_set1_ps(S1));
+			ps = madd(ps, z, _mm_set1_ps(S0));
+			ps = madd(_mm_mul_ps(r, z), ps, r);
+
+			__m128 pc = madd(_mm_set1_ps(C2), z, _mm_set1_ps(C1));
+			pc = madd(pc, z, _mm_set1_ps(C0));
+			pc = madd(_mm_mul_ps(z, z), pc, _mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), z)));
+
+			//Odd quadrants swap sin and cos, the sign bits come from bit 1 of q and q + 1
+			const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+			const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+			const __m128 sSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+			const __m128 cSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+
+			s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps)), sSign);
+			c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc)), cSign);
+		}
+
+		//Returns acos(x) for 4 values
+		inline __m128 acos(__m128 x)
+		{
+			using namespace constants;
+			using namespace Math::simd;
+
+			const __m128 signMask = _mm_set1_ps(-0.f);
+			const __m128 sign = _mm_and_ps(x, signMask);
+			const __m128 a = _mm_min_ps(_mm_andnot_ps(signMask, x), _mm_set1_ps(1.f));
+
+			const __m128 big = _mm_cmpgt_ps(a, _mm_set1_ps(0.5f));
+			const __m128 zBig = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(_mm_set1_ps(1.f), a));
+			const __m128 z = _mm_or_ps(_mm_and_ps(big, zBig), _mm_andnot_ps(big, _mm_mul_ps(a, a)));
+			const __m128 s = _mm_or_ps(_mm_and_ps(big, _mm_sqrt_ps(zBig)), _mm_andnot_ps(big, a));
+
+			__m128 p = madd(_mm_set1_ps(A4), z, _mm_set1_ps(A3));
+			p = madd(p, z, _mm_set1_ps(A2));
+			p = madd(p, z, _mm_set1_ps(A1));
+			p = madd(p, z, _mm_set1_ps(A0));
+			p = madd(_mm_mul_ps(s, z), p, s);
+
+			//Big: 2p, or PI - 2p for negative x. Small: PI / 2 - p, or PI / 2 + p for negative x
+			const __m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+			const __m128 rBig = _mm_add_ps(_mm_and_ps(negative, _mm_set1_ps(PI_F)), _mm_xor_ps(_mm_add_ps(p, p), sign));
+			const __m128 rSmall = _mm_sub_ps(_mm_set1_ps(PI_2), _mm_xor_ps(p, sign));
+
+			return _mm_or_ps(_mm_and_ps(big, rBig), _mm_andnot_ps(big, rSmall));
+		}
+
+		//Returns atan2(y, x) for 4 values
+		inline __m128 atan2(__m128 y, __m128 x)
+		{
+			using namespace constants;
+			using namespace Math::simd;
+
+			const __m128 signMask = _mm_set1_ps(-0.f);
+			const __m128 ax = _mm_andnot_ps(signMask, x);
+			const __m128 ay = _mm_andnot_ps(signMask, y);
+			const __m128 mx = _mm_max_ps(ax, ay);
+			const __m128 mn = _mm_min_ps(ax, ay);
+
+			__m128 t = _mm_and_ps(_mm_div_ps(mn, mx), _mm_cmpneq_ps(mx, _mm_setzero_ps()));
+
+			const __m128 big = _mm_cmpgt_ps(t, _mm_set1_ps(TAN_PI_8));
+			const __m128 tBig = _mm_div_ps(_mm_sub_ps(t, _mm_set1_ps(1.f)), _mm_add_ps(t, _mm_set1_ps(1.f)));
+			t = _mm_or_ps(_mm_and_ps(big, tBig), _mm_andnot_ps(big, t));
+
+			const __m128 z = _mm_mul_ps(t, t);
+			__m128 p = madd(_mm_set1_ps(T3), z, _mm_set1_ps(T2));
+			p = madd(p, z, _mm_set1_ps(T1));
+			p = madd(p, z, _mm_set1_ps(T0));
+			__m128 r = _mm_add_ps(madd(_mm_mul_ps(t, z), p, t), _mm_and_ps(big, _mm_set1_ps(PI_4)));
+
+			const __m128 steep = _mm_cmpgt_ps(ay, ax);
+			r = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(PI_2), r)), _mm_andnot_ps(steep, r));
+
+			const __m128 left = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31));
+			r = _mm_or_ps(_mm_and_ps(left, _mm_sub_ps(_mm_set1_ps(PI_F), r)), _mm_andnot_ps(left, r));
+
+			return _mm_xor_ps(r, _mm_and_ps(y, signMask));
+		}
+
+
+		//Sets s to sin(x) and c to cos(x) for 8 values. Needs AVX2 and FMA
+		MATH_TARGET("avx2,fma") inline void sincos(__m256 x, __m256& s, __m256& c)
+		{
+			using namespace constants;
+
+			const __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)));
+			const __m256 j = _mm256_cvtepi32_ps(q);
+
+			__m256 r = _mm256_fnmadd_ps(j, _mm256_set1_ps(PIO2_1), x);
+			r = _mm256_fnmadd_ps(j, _mm256_set1_ps(PIO2_2), r);
+			r = _mm256_fnmadd_ps(j, _mm256_set1_ps(PIO2_3), r);
+			const __m256 z = _mm256_mul_ps(r, r);
+
+			__m256 ps = _mm256_fmadd_ps(_mm256_set1_ps(S2), z, _mm256_set1_ps(S1));
+			ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(S0));
+			ps = _mm256_fmadd_ps(_mm256_mul_ps(r, z), ps, r);
+
+			__m256 pc = _mm256_fmadd_ps(_mm256_set1_ps(C2), z, _mm256_set1_ps(C1));
+			pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(C0));
+			pc = _mm256_fmadd_ps(_mm256_mul_ps(z, z), pc, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.f)));
+
+			const __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+			const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+			const __m256 sSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+			const __m256 cSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+
+			s = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sSign);
+			c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cSign);
+		}
+
+		//Returns acos(x) for 8 values. Needs AVX2 and FMA
+		MATH_TARGET("avx2,fma") inline __m256 acos(__m256 x)
+		{
+			using namespace constants;
+
+			const __m256 signMask = _mm256_set1_ps(-0.f);
+			const __m256 sign = _mm256_and_ps(x, signMask);
+			const __m256 a = _mm256_min_ps(_mm256_andnot_ps(signMask, x), _mm256_set1_ps(1.f));
+
+			const __m256 big = _mm256_cmp_ps(a, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+			const __m256 zBig = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(_mm256_set1_ps(1.f), a));
+			const __m256 z = _mm256_blendv_ps(_mm256_mul_ps(a, a), zBig, big);
+			const __m256 s = _mm256_blendv_ps(a, _mm256_sqrt_ps(zBig), big);
+
+			__m256 p = _mm256_fmadd_ps(_mm256_set1_ps(A4), z, _mm256_set1_ps(A3));
+			p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(A2));
+			p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(A1));
+			p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(A0));
+			p = _mm256_fmadd_ps(_mm256_mul_ps(s, z), p, s);
+
+			const __m256 negative = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+			const __m256 rBig = _mm256_add_ps(_mm256_and_ps(negative, _mm256_set1_ps(PI_F)), _mm256_xor_ps(_mm256_add_ps(p, p), sign));
+			const __m256 rSmall = _mm256_sub_ps(_mm256_set1_ps(PI_2), _mm256_xor_ps(p, sign));
+
+			return _mm256_blendv_ps(rSmall, rBig, big);
+		}
+
+		//Returns atan2(y, x) for 8 values. Needs AVX2 and FMA
+		MATH_TARGET("avx2,fma") inline __m256 atan2(__m256 y, __m256 x)
+		{
+			using namespace constants;
+
+			const __m256 signMask = _mm256_set1_ps(-0.f);
+			const __m256 ax = _mm256_andnot_ps(signMask, x);
+			const __m256 ay = _mm256_andnot_ps(signMask, y);
+			const __m256 mx = _mm256_max_ps(ax, ay);
+			const __m256 mn = _mm256_min_ps(ax, ay);
+
+			__m256 t = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, _mm256_setzero_ps(), _CMP_NEQ_UQ));
+
+			const __m256 big = _mm256_cmp_ps(t, _mm256_set1_ps(TAN_PI_8), _CMP_GT_OQ);
+			const __m256 tBig = _mm256_div_ps(_mm256_sub_ps(t, _mm256_set1_ps(1.f)), _mm256_add_ps(t, _mm256_set1_ps(1.f)));
+			t = _mm256_blendv_ps(t, tBig, big);
+
+			const __m256 z = _mm256_mul_ps(t, t);
+			__m256 p = _mm256_fmadd_ps(_mm256_set1_ps(T3), z, _mm256_set1_ps(T2));
+			p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(T1));
+			p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(T0));
+			__m256 r = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(t, z), p, t), _mm256_and_ps(big, _mm256_set1_ps(PI_4)));
+
+			r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_2), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+			r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), x);
+
+			return _mm256_xor_ps(r, _mm256_and_ps(y, signMask));
+		}
+
+#endif
+
+
+		//Sets s[i] to sin(x[i]) and c[i] to cos(x[i]) for count values
+		inline void sincos(const F32* x, F32* s, F32* c, U32 count)
+		{
+			dispatch::kernels().fastSinCos(x, s, c, count);
+		}
+
+		//Sets out[i] to acos(x[i]) for count values. out may be x
+		inline void acos(const F32* x, F32* out, U32 count)
+		{
+			dispatch::kernels().fastAcos(x, out, count);
+		}
+
+		//Sets out[i] to atan2(y[i], x[i]) for count values. out may be y or x
+		inline void atan2(const F32* y, const F32* x, F32* out, U32 count)
+		{
+			dispatch::kernels().fastAtan2(y, x, out, count);
+		}
+
+	}
+
+
+	//Trigonometry of the rotation and interpolation functions of Math.
+	//With MATH_FAST_TRIG they use Math::fast, otherwise the C library.
+	namespace trig {
+
+		//Sets s to sin(x) and c to cos(x)
+		inline void sincos(F32 x, F32& s, F32& c)
+		{
+#ifdef MATH_FAST_TRIG
+			fast::sincos(x, s, c);
+#else
+			s = sinf(x);
+			c = cosf(x);
+#endif
+		}
+
+		//Returns sin(x)
+		inline F32 sin(F32 x)
+		{
+#ifdef MATH_FAST_TRIG
+			return fast::sin(x);
+#else
+			return sinf(x);
+#endif
+		}
+
+		//Returns acos(x)
+		inline F32 acos(F32 x)
+		{
+#ifdef MATH_FAST_TRIG
+			return fast::acos(x);
+#else
+			return acosf(x);
+#endif
+		}
+
+	}
+}
@@ -0,0 +1,2572 @@
+#include "MathKernels.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "AABB.h"
+#include "BoundingSphere.h"
+#include "MathFast.h"
+#include <limits>
+
+#ifdef MATH_SSE2
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(F32), "Kernels expect Quaternions to be packed x, y, z, w");
+static_assert(sizeof(Vector3) == 3 * sizeof(F32), "Kernels expect Vector3s to be packed x, y, z");
+static_assert(sizeof(AABB) == 6 * sizeof(F32), "Kernels expect AABBs to be packed min x, y, z, max x, y, z");
+static_assert(sizeof(BoundingSphere) == 4 * sizeof(F32), "Kernels expect BoundingSpheres to be packed x, y, z, radius");
+
+namespace Math {
+	namespace kernels {
+
+		//Scalar
+
+		void mat4MulScalar(const F32* a, const F32* b, F32* out)
+		{
+			F32 res[16];
+
+			for (U32 r = 0; r < 4; ++r) {
+				for (U32 c = 0; c < 4; ++c) {
+					res[r * 4 + c] = a[r * 4] * b[c] + a[r * 4 + 1] * b[4 + c] + a[r * 4 + 2] * b[8 + c] + a[r * 4 + 3] * b[12 + c];
+				}
+			}
+
+			memcpy(out, res, sizeof(F32) * 16);
+		}
+
+		void mat4MulIndexedScalar(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				mat4MulScalar(a + aIdx[i] * 16, b + i * 16, out + i * 16);
+			}
+		}
+
+		bool mat4InverseScalar(const F32* elements, F32* out)
+		{
+			F32* inv = out;
+
+			inv[0] = elements[5] * elements[10] * elements[15] -
+				elements[5] * elements[11] * elements[14] -
+				elements[9] * elements[6] * elements[15] +
+				elements[9] * elements[7] * elements[14] +
+				elements[13] * elements[6] * elements[11] -
+				elements[13] * elements[7] * elements[10];
+
+			inv[4] = -elements[4] * elements[10] * elements[15] +
+				elements[4] * elements[11] * elements[14] +
+				elements[8] * elements[6] * elements[15] -
+				elements[8] * elements[7] * elements[14] -
+				elements[12] * elements[6] * elements[11] +
+				elements[12] * elements[7] * elements[10];
+
+			inv[8] = elements[4] * elements[9] * elements[15] -
+				elements[4] * elements[11] * elements[13] -
+				elements[8] * elements[5] * elements[15] +
+				elements[8] * elements[7] * elements[13] +
+				elements[12] * elements[5] * elements[11] -
+				elements[12] * elements[7] * elements[9];
+
+			inv[12] = -elements[4] * elements[9] * elements[14] +
+				elements[4] * elements[10] * elements[13] +
+				elements[8] * elements[5] * elements[14] -
+				elements[8] * elements[6] * elements[13] -
+				elements[12] * elements[5] * elements[10] +
+				elements[12] * elements[6] * elements[9];
+
+			inv[1] = -elements[1] * elements[10] * elements[15] +
+				elements[1] * elements[11] * elements[14] +
+				elements[9] * elements[2] * elements[15] -
+				elements[9] * elements[3] * elements[14] -
+				elements[13] * elements[2] * elements[11] +
+				elements[13] * elements[3] * elements[10];
+
+			inv[5] = elements[0] * elements[10] * elements[15] -
+				elements[0] * elements[11] * elements[14] -
+				elements[8] * elements[2] * elements[15] +
+				elements[8] * elements[3] * elements[14] +
+				elements[12] * elements[2] * elements[11] -
+				elements[12] * elements[3] * elements[10];
+
+			inv[9] = -elements[0] * elements[9] * elements[15] +
+				elements[0] * elements[11] * elements[13] +
+				elements[8] * elements[1] * elements[15] -
+				elements[8] * elements[3] * elements[13] -
+				elements[12] * elements[1] * elements[11] +
+				elements[12] * elements[3] * elements[9];
+
+			inv[13] = elements[0] * elements[9] * elements[14] -
+				elements[0] * elements[10] * elements[13] -
+				elements[8] * elements[1] * elements[14] +
+				elements[8] * elements[2] * elements[13] +
+				elements[12] * elements[1] * elements[10] -
+				elements[12] * elements[2] * elements[9];
+
+			inv[2] = elements[1] * elements[6] * elements[15] -
+				elements[1] * elements[7] * elements[14] -
+				elements[5] * elements[2] * elements[15] +
+				elements[5] * elements[3] * elements[14] +
+				elements[13] * elements[2] * elements[7] -
+				elements[13] * elements[3] * elements[6];
+
+			inv[6] = -elements[0] * elements[6] * elements[15] +
+				elements[0] * elements[7] * elements[14] +
+				elements[4] * elements[2] * elements[15] -
+				elements[4] * elements[3] * elements[14] -
+				elements[12] * elements[2] * elements[7] +
+				elements[12] * elements[3] * elements[6];
+
+			inv[10] = elements[0] * elements[5] * elements[15] -
+				elements[0] * elements[7] * elements[13] -
+				elements[4] * elements[1] * elements[15] +
+				elements[4] * elements[3] * elements[13] +
+				elements[12] * elements[1] * elements[7] -
+				elements[12] * elements[3] * elements[5];
+
+			inv[14] = -elements[0] * elements[5] * elements[14] +
+				elements[0] * elements[6] * elements[13] +
+				elements[4] * elements[1] * elements[14] -
+				elements[4] * elements[2] * elements[13] -
+				elements[12] * elements[1] * elements[6] +
+				elements[12] * elements[2] * elements[5];
+
+			inv[3] = -elements[1] * elements[6] * elements[11] +
+				elements[1] * elements[7] * elements[10] +
+				elements[5] * elements[2] * elements[11] -
+				elements[5] * elements[3] * elements[10] -
+				elements[9] * elements[2] * elements[7] +
+				elements[9] * elements[3] * elements[6];
+
+			inv[7] = elements[0] * elements[6] * elements[11] -
+				elements[0] * elements[7] * elements[10] -
+				elements[4] * elements[2] * elements[11] +
+				elements[4] * elements[3] * elements[10] +
+				elements[8] * elements[2] * elements[7] -
+				elements[8] * elements[3] * elements[6];
+
+			inv[11] = -elements[0] * elements[5] * elements[11] +
+				elements[0] * elements[7] * elements[9] +
+				elements[4] * elements[1] * elements[11] -
+				elements[4] * elements[3] * elements[9] -
+				elements[8] * elements[1] * elements[7] +
+				elements[8] * elements[3] * elements[5];
+
+			inv[15] = elements[0] * elements[5] * elements[10] -
+				elements[0] * elements[6] * elements[9] -
+				elements[4] * elements[1] * elements[10] +
+				elements[4] * elements[2] * elements[9] +
+				elements[8] * elements[1] * elements[6] -
+				elements[8] * elements[2] * elements[5];
+			F32 det = elements[0] * inv[0] + elements[1] * inv[4] + elements[2] * inv[8] + elements[3] * inv[12];
+
+			if (det == 0.f) return false;
+
+			det = 1.f / det;
+
+			for (U32 i = 0; i < 16; ++i) {
+				inv[i] *= det;
+			}
+
+			return true;
+		}
+
+		void mat3MulScalar(const F32* a, const F32* b, F32* out)
+		{
+			//Rows of the result are linear combinations of the rows of b, all read before out is written
+			const F32 b0 = b[0], b1 = b[1], b2 = b[2];
+			const F32 b3 = b[3], b4 = b[4], b5 = b[5];
+			const F32 b6 = b[6], b7 = b[7], b8 = b[8];
+
+			for (U32 r = 0; r < 3; ++r) {
+				const F32 a0 = a[r * 3], a1 = a[r * 3 + 1], a2 = a[r * 3 + 2];
+
+				out[r * 3] = a0 * b0 + a1 * b3 + a2 * b6;
+				out[r * 3 + 1] = a0 * b1 + a1 * b4 + a2 * b7;
+				out[r * 3 + 2] = a0 * b2 + a1 * b5 + a2 * b8;
+			}
+		}
+
+		bool affineInverse(const F32* m, F32* out)
+		{
+			//Columns of the inverse 3x3 are cross products of the rows, scaled by 1 / determinant
+			const F32 c00 = m[5] * m[10] - m[6] * m[9];
+			const F32 c01 = m[6] * m[8] - m[4] * m[10];
+			const F32 c02 = m[4] * m[9] - m[5] * m[8];
+
+			const F32 det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+
+			if (det == 0.f) return false;
+
+			const F32 invDet = 1.f / det;
+			F32* inv = out;
+
+			inv[0] = c00 * invDet;
+			inv[4] = c01 * invDet;
+			inv[8] = c02 * invDet;
+
+			inv[1] = (m[2] * m[9] - m[1] * m[10]) * invDet;
+			inv[5] = (m[0] * m[10] - m[2] * m[8]) * invDet;
+			inv[9] = (m[1] * m[8] - m[0] * m[9]) * invDet;
+
+			inv[2] = (m[1] * m[6] - m[2] * m[5]) * invDet;
+			inv[6] = (m[2] * m[4] - m[0] * m[6]) * invDet;
+			inv[10] = (m[0] * m[5] - m[1] * m[4]) * invDet;
+
+			//Translation of the inverse is the original translation moved back through the inverse 3x3
+			inv[3] = -(inv[0] * m[3] + inv[1] * m[7] + inv[2] * m[11]);
+			inv[7] = -(inv[4] * m[3] + inv[5] * m[7] + inv[6] * m[11]);
+			inv[11] = -(inv[8] * m[3] + inv[9] * m[7] + inv[10] * m[11]);
+
+			return true;
+		}
+
+		void quatMulScalar(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = a[i] * b[i];
+			}
+		}
+
+		void vec3NormalizeScalar(Vector3* v, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				v[i].normalize();
+			}
+		}
+
+		void quatNormalizeScalar(Quaternion* q, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				q[i].normalize();
+			}
+		}
+
+		void quatToMat4Scalar(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, out += 16) {
+				const F32 x = q[i].x, y = q[i].y, z = q[i].z, w = q[i].w;
+				const F32 sx = s ? s[i].x : 1.f, sy = s ? s[i].y : 1.f, sz = s ? s[i].z : 1.f;
+
+				out[0] = (1 - 2 * (y * y + z * z)) * sx;
+				out[1] = 2 * (x * y - z * w) * sy;
+				out[2] = 2 * (x * z + y * w) * sz;
+				out[3] = t ? t[i].x : 0.f;
+
+				out[4] = 2 * (x * y + z * w) * sx;
+				out[5] = (1 - 2 * (x * x + z * z)) * sy;
+				out[6] = 2 * (y * z - x * w) * sz;
+				out[7] = t ? t[i].y : 0.f;
+
+				out[8] = 2 * (x * z - y * w) * sx;
+				out[9] = 2 * (y * z + x * w) * sy;
+				out[10] = (1 - 2 * (x * x + y * y)) * sz;
+				out[11] = t ? t[i].z : 0.f;
+
+				out[12] = out[13] = out[14] = 0.f;
+				out[15] = 1.f;
+			}
+		}
+
+		//Shepperd's method: of 4w^2, 4x^2, 4y^2 and 4z^2, which are sums of the diagonal, the largest is the most accurate.
+		//Together with sums and differences of the off-diagonal elements it gives the Quaternion times 4 times that component
+		void mat4ToQuatScalar(const F32* m, Quaternion* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, m += 16) {
+				const F32 tw = 1 + m[0] + m[5] + m[10];
+				const F32 tx = 1 + m[0] - m[5] - m[10];
+				const F32 ty = 1 - m[0] + m[5] - m[10];
+				const F32 tz = 1 - m[0] - m[5] + m[10];
+
+				F32 x, y, z, w;
+				if (tw >= tx && tw >= ty && tw >= tz) {
+					x = m[9] - m[6]; y = m[2] - m[8]; z = m[4] - m[1]; w = tw;
+				}
+				else if (tx >= ty && tx >= tz) {
+					x = tx; y = m[4] + m[1]; z = m[2] + m[8]; w = m[9] - m[6];
+				}
+				else if (ty >= tz) {
+					x = m[4] + m[1]; y = ty; z = m[9] + m[6]; w = m[2] - m[8];
+				}
+				else {
+					x = m[2] + m[8]; y = m[9] + m[6]; z = tz; w = m[4] - m[1];
+				}
+
+				const F32 inv = Math::rsqrt(x * x + y * y + z * z + w * w);
+				out[i] = Quaternion(x * inv, y * inv, z * inv, w * inv);
+			}
+		}
+
+		//The palette holds the bone matrices transposed, so that columns are 4 consecutive F32s. The columns of
+		//the bones are blended by weight, then the position is c0 * x + c1 * y + c2 * z + c3 and the normal c0 * x + c1 * y + c2 * z
+		void skinScalar(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, bones += influences, weights += influences) {
+				F32 m[16] = {};
+				for (U32 k = 0; k < influences; ++k) {
+					const F32* b = palette + bones[k] * 16;
+					for (U32 e = 0; e < 16; ++e) m[e] += weights[k] * b[e];
+				}
+
+				const Vector3 p = pos[i];
+				outPos[i] = Vector3(m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+					m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+					m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+
+				if (nrm) {
+					const Vector3 n = nrm[i];
+					outNrm[i] = Vector3(m[0] * n.x + m[4] * n.y + m[8] * n.z,
+						m[1] * n.x + m[5] * n.y + m[9] * n.z,
+						m[2] * n.x + m[6] * n.y + m[10] * n.z).normalized();
+				}
+			}
+		}
+
+		//The DualQuaternions of the bones, 8 F32s each, are blended by weight. Bones whose real part points away from the first
+		//bone's are negated, so that the blend takes the shorter way. The blend is normalized and applied as in
+		//DualQuaternion::transformPoint(). Normals only rotate and keep their length
+		void skinDualQuatScalar(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, bones += influences, weights += influences) {
+				const F32* b0 = palette + bones[0] * 8;
+				F32 q[8] = {};
+				for (U32 k = 0; k < influences; ++k) {
+					const F32* b = palette + bones[k] * 8;
+					const F32 w = b[0] * b0[0] + b[1] * b0[1] + b[2] * b0[2] + b[3] * b0[3] < 0.f ? -weights[k] : weights[k];
+					for (U32 e = 0; e < 8; ++e) q[e] += w * b[e];
+				}
+
+				const F32 inv = Math::rsqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+				for (U32 e = 0; e < 8; ++e) q[e] *= inv;
+
+				const Vector3 rv(q[0], q[1], q[2]), dv(q[4], q[5], q[6]);
+				const Vector3 t = (dv * q[3] - rv * q[7] + rv.cross(dv)) * 2.f;
+
+				const Vector3 p = pos[i];
+				outPos[i] = p + rv.cross(rv.cross(p) + p * q[3]) * 2.f + t;
+
+				if (nrm) {
+					const Vector3 n = nrm[i];
+					outNrm[i] = n + rv.cross(rv.cross(n) + n * q[3]) * 2.f;
+				}
+			}
+		}
+
+		//Interpolation of the Quaternion blend kernels. All of them take the shortest path and normalize the result.
+		//Slerp weighs the ends with sin((1 - t) * angle) and sin(t * angle), approximate slerp corrects t of nlerp
+		//with a polynomial fit of the slerp curve (rotations differ from slerp by up to 8e-4 radians)
+		enum BlendMode { BLEND_NLERP, BLEND_SLERP, BLEND_SLERP_APPROX };
+
+		//Below this sin(angle) the ends are practically parallel, and slerp uses the nlerp weights
+		static const F32 SLERP_MIN_SIN = 1e-3f;
+
+		//Returns t corrected so that nlerp with it follows slerp, for d = cos(angle) >= 0.
+		//Polynomial fit from "Approximating slerp" by Arseny Kapoulkine
+		static inline F32 slerpApproxT(F32 d, F32 t)
+		{
+			const F32 A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+			const F32 B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+			const F32 k = A * (t - 0.5f) * (t - 0.5f) + B;
+			return t + t * (t - 0.5f) * (t - 1) * k;
+		}
+
+		template<BlendMode mode>
+		static void quatBlendScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				const Quaternion qa = a[i];
+				Quaternion qb = b[i];
+				const F32 ti = clamp(t[i], 0.f, 1.f);
+
+				F32 d = qa.x * qb.x + qa.y * qb.y + qa.z * qb.z + qa.w * qb.w;
+				if (d < 0.f) {
+					qb = Quaternion(-qb.x, -qb.y, -qb.z, -qb.w);
+					d = -d;
+				}
+
+				F32 wa = 1.f - ti, wb = ti;
+				if (mode == BLEND_SLERP_APPROX) {
+					wb = slerpApproxT(d, ti);
+					wa = 1.f - wb;
+				}
+				else if (mode == BLEND_SLERP) {
+					const F32 angle = trig::acos(d < 1.f ? d : 1.f);
+					if (trig::sin(angle) >= SLERP_MIN_SIN) {
+						wa = trig::sin((1.f - ti) * angle);
+						wb = trig::sin(ti * angle);
+					}
+				}
+
+				const F32 x = wa * qa.x + wb * qb.x, y = wa * qa.y + wb * qb.y, z = wa * qa.z + wb * qb.z, w = wa * qa.w + wb * qb.w;
+				const F32 inv = Math::rsqrt(x * x + y * y + z * z + w * w);
+				out[i] = Quaternion(x * inv, y * inv, z * inv, w * inv);
+			}
+		}
+
+		void quatNlerpScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendScalar<BLEND_NLERP>(a, b, t, out, count);
+		}
+
+		void quatSlerpScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendScalar<BLEND_SLERP>(a, b, t, out, count);
+		}
+
+		void quatSlerpApproxScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendScalar<BLEND_SLERP_APPROX>(a, b, t, out, count);
+		}
+
+		//How the transform kernels extend a Vector3 to 4D: w = 1 for points, w = 0 for directions,
+		//and w = 1 with the result divided by its w for projective transforms
+		enum TransformMode { TRANSFORM_POINT, TRANSFORM_DIRECTION, TRANSFORM_PROJECTIVE };
+
+		template<TransformMode mode>
+		static void vec3TransformScalar(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			const F32 w = mode == TRANSFORM_DIRECTION ? 0.f : 1.f;
+
+			for (U32 i = 0; i < count; ++i) {
+				const F32 x = in[i].x, y = in[i].y, z = in[i].z;
+
+				F32 rx = m[0] * x + m[1] * y + m[2] * z + m[3] * w;
+				F32 ry = m[4] * x + m[5] * y + m[6] * z + m[7] * w;
+				F32 rz = m[8] * x + m[9] * y + m[10] * z + m[11] * w;
+
+				if (mode == TRANSFORM_PROJECTIVE) {
+					const F32 invW = 1.f / (m[12] * x + m[13] * y + m[14] * z + m[15]);
+					rx *= invW; ry *= invW; rz *= invW;
+				}
+
+				out[i].x = rx; out[i].y = ry; out[i].z = rz;
+			}
+		}
+
+		void vec3TransformPointScalar(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformScalar<TRANSFORM_POINT>(m, in, out, count);
+		}
+
+		void vec3TransformDirScalar(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformScalar<TRANSFORM_DIRECTION>(m, in, out, count);
+		}
+
+		void vec3TransformProjScalar(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformScalar<TRANSFORM_PROJECTIVE>(m, in, out, count);
+		}
+
+		void fastSinCosScalar(const F32* x, F32* s, F32* c, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				fast::sincos(x[i], s[i], c[i]);
+			}
+		}
+
+		void fastAcosScalar(const F32* x, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = fast::acos(x[i]);
+			}
+		}
+
+		void fastAtan2Scalar(const F32* y, const F32* x, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = fast::atan2(y[i], x[i]);
+			}
+		}
+
+
+		void soaAddScalar(const F32* a, const F32* b, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = a[i] + b[i];
+			}
+		}
+
+		void soaScaleScalar(const F32* a, F32 s, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = a[i] * s;
+			}
+		}
+
+		void soaLerpScalar(const F32* a, const F32* b, F32 t, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = (1 - t) * a[i] + t * b[i];
+			}
+		}
+
+		void soaDot3Scalar(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+			}
+		}
+
+		void soaCross3Scalar(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				const F32 xx = ay[i] * bz[i] - az[i] * by[i];
+				const F32 yy = az[i] * bx[i] - ax[i] * bz[i];
+				const F32 zz = ax[i] * by[i] - ay[i] * bx[i];
+				ox[i] = xx; oy[i] = yy; oz[i] = zz;
+			}
+		}
+
+		void soaNormalize3Scalar(F32* x, F32* y, F32* z, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				const F32 inv = Math::rsqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+				x[i] *= inv; y[i] *= inv; z[i] *= inv;
+			}
+		}
+
+		//Arvo's method on the center and extents: the center is transformed as a point, and every new extent is
+		//the sum of the old extents weighted by the absolute values of a row of the 3x3 part
+		void aabbTransformScalar(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, m += mStride) {
+				const F32 cx = (in[i].min.x + in[i].max.x) * 0.5f, ex = (in[i].max.x - in[i].min.x) * 0.5f;
+				const F32 cy = (in[i].min.y + in[i].max.y) * 0.5f, ey = (in[i].max.y - in[i].min.y) * 0.5f;
+				const F32 cz = (in[i].min.z + in[i].max.z) * 0.5f, ez = (in[i].max.z - in[i].min.z) * 0.5f;
+
+				F32 c[3], e[3];
+				for (U32 r = 0; r < 3; ++r) {
+					const F32* row = m + r * 4;
+					c[r] = row[0] * cx + row[1] * cy + row[2] * cz + row[3];
+					e[r] = fabsf(row[0]) * ex + fabsf(row[1]) * ey + fabsf(row[2]) * ez;
+				}
+
+				out[i].min.x = c[0] - e[0]; out[i].min.y = c[1] - e[1]; out[i].min.z = c[2] - e[2];
+				out[i].max.x = c[0] + e[0]; out[i].max.y = c[1] + e[1]; out[i].max.z = c[2] + e[2];
+			}
+		}
+
+		void aabbMergeScalar(const AABB* in, U32 count, AABB* out)
+		{
+			AABB res;
+			for (U32 i = 0; i < count; ++i) {
+				res.merge(in[i]);
+			}
+			*out = res;
+		}
+
+		//The radius is scaled by the length of the longest column of the 3x3 part
+		void sphereTransformScalar(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i, m += mStride) {
+				const F32 x = in[i].center.x, y = in[i].center.y, z = in[i].center.z;
+
+				const F32 sx = m[0] * m[0] + m[4] * m[4] + m[8] * m[8];
+				const F32 sy = m[1] * m[1] + m[5] * m[5] + m[9] * m[9];
+				const F32 sz = m[2] * m[2] + m[6] * m[6] + m[10] * m[10];
+				const F32 s = sx > sy ? (sx > sz ? sx : sz) : (sy > sz ? sy : sz);
+
+				out[i].center.x = m[0] * x + m[1] * y + m[2] * z + m[3];
+				out[i].center.y = m[4] * x + m[5] * y + m[6] * z + m[7];
+				out[i].center.z = m[8] * x + m[9] * y + m[10] * z + m[11];
+				out[i].radius = in[i].radius * sqrtf(s);
+			}
+		}
+
+		//A sphere is outside a plane when the signed distance of its center is below -radius.
+		//The loop over the planes stops at the first plane the object is outside, and visible[n] is written for every object
+		//but n advances only for visible ones, which keeps the loop free of unpredictable branches on the result
+		U32 cullSpheresScalar(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible)
+		{
+			U32 n = 0;
+			for (U32 i = 0; i < count; ++i) {
+				U32 p = 0;
+				for (; p < 24; p += 4) {
+					const F32 d = planes[p] * x[i] + planes[p + 1] * y[i] + planes[p + 2] * z[i] + planes[p + 3];
+					if (!(d >= -r[i])) break;
+				}
+
+				visible[n] = i;
+				n += p == 24;
+			}
+
+			return n;
+		}
+
+		//A box is outside a plane when its corner farthest along the normal is. With s = min + max and e = max - min,
+		//twice the distance of that corner is n . s + |n| . e + 2d. Empty boxes give NaN and are culled
+		U32 cullAABBsScalar(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible)
+		{
+			U32 n = 0;
+			for (U32 i = 0; i < count; ++i) {
+				const F32 sx = minX[i] + maxX[i], ex = maxX[i] - minX[i];
+				const F32 sy = minY[i] + maxY[i], ey = maxY[i] - minY[i];
+				const F32 sz = minZ[i] + maxZ[i], ez = maxZ[i] - minZ[i];
+
+				U32 p = 0;
+				for (; p < 24; p += 4) {
+					const F32 d = planes[p] * sx + planes[p + 1] * sy + planes[p + 2] * sz + fabsf(planes[p]) * ex + fabsf(planes[p + 1]) * ey + fabsf(planes[p + 2]) * ez;
+					if (!(d >= -2.f * planes[p + 3])) break;
+				}
+
+				visible[n] = i;
+				n += p == 24;
+			}
+
+			return n;
+		}
+
+
+#ifdef MATH_SSE2
+
+		using namespace Math::simd;
+
+		//SSE2
+
+		//Each row of the result is a linear combination of the rows of b, weighted by a row of a
+		void mat4MulSSE2(const F32* a, const F32* b, F32* out)
+		{
+			const __m128 b0 = _mm_loadu_ps(b);
+			const __m128 b1 = _mm_loadu_ps(b + 4);
+			const __m128 b2 = _mm_loadu_ps(b + 8);
+			const __m128 b3 = _mm_loadu_ps(b + 12);
+
+			//Row i of a is read before row i of out is written, so out can be a
+			for (U32 i = 0; i < 16; i += 4) {
+				const __m128 row = _mm_loadu_ps(a + i);
+
+				__m128 r = _mm_mul_ps(splat<0>(row), b0);
+				r = madd(splat<1>(row), b1, r);
+				r = madd(splat<2>(row), b2, r);
+				r = madd(splat<3>(row), b3, r);
+
+				_mm_storeu_ps(out + i, r);
+			}
+		}
+
+		void mat4MulIndexedSSE2(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				mat4MulSSE2(a + aIdx[i] * 16, b + i * 16, out + i * 16);
+			}
+		}
+
+
+		//2x2 matrices are stored in one register as row-major (m00, m01, m10, m11)
+
+		//Returns a * b
+		static inline __m128 mat2Mul(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(_mm_mul_ps(a, shuffle<0, 3, 0, 3>(b, b)), _mm_mul_ps(shuffle<1, 0, 3, 2>(a, a), shuffle<2, 1, 2, 1>(b, b)));
+		}
+
+		//Returns adjugate(a) * b
+		static inline __m128 mat2AdjMul(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(shuffle<3, 3, 0, 0>(a, a), b), _mm_mul_ps(shuffle<1, 1, 2, 2>(a, a), shuffle<2, 3, 0, 1>(b, b)));
+		}
+
+		//Returns a * adjugate(b)
+		static inline __m128 mat2MulAdj(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(a, shuffle<3, 0, 3, 0>(b, b)), _mm_mul_ps(shuffle<1, 0, 3, 2>(a, a), shuffle<2, 1, 2, 1>(b, b)));
+		}
+
+		//Blockwise inverse: m is split to 2x2 blocks | A B |, and the inverse is built from their adjugates and determinants.
+		//                                            | C D |
+		bool mat4InverseSSE2(const F32* m, F32* out)
+		{
+			const __m128 r0 = _mm_loadu_ps(m);
+			const __m128 r1 = _mm_loadu_ps(m + 4);
+			const __m128 r2 = _mm_loadu_ps(m + 8);
+			const __m128 r3 = _mm_loadu_ps(m + 12);
+
+			const __m128 A = _mm_movelh_ps(r0, r1);
+			const __m128 B = _mm_movehl_ps(r1, r0);
+			const __m128 C = _mm_movelh_ps(r2, r3);
+			const __m128 D = _mm_movehl_ps(r3, r2);
+
+			//(|A|, |B|, |C|, |D|)
+			const __m128 detSub = _mm_sub_ps(_mm_mul_ps(shuffle<0, 2, 0, 2>(r0, r2), shuffle<1, 3, 1, 3>(r1, r3)),
+				_mm_mul_ps(shuffle<1, 3, 1, 3>(r0, r2), shuffle<0, 2, 0, 2>(r1, r3)));
+
+			const __m128 detA = splat<0>(detSub);
+			const __m128 detB = splat<1>(detSub);
+			const __m128 detC = splat<2>(detSub);
+			const __m128 detD = splat<3>(detSub);
+
+			const __m128 DC = mat2AdjMul(D, C);
+			const __m128 AB = mat2AdjMul(A, B);
+
+			//Adjugates of the blocks of the inverse times |m|
+			__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, DC));
+			__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, AB));
+			__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, AB));
+			__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, DC));
+
+			//|m| = |A||D| + |B||C| - trace(adj(A)B adj(D)C)
+			__m128 tr = _mm_mul_ps(AB, shuffle<0, 2, 1, 3>(DC, DC));
+			tr = _mm_add_ps(tr, shuffle<2, 3, 0, 1>(tr, tr));
+			tr = _mm_add_ps(tr, shuffle<1, 0, 3, 2>(tr, tr));
+
+			const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+			if (_mm_cvtss_f32(det) == 0.f) return false;
+
+			const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+
+			X = _mm_mul_ps(X, invDet);
+			Y = _mm_mul_ps(Y, invDet);
+			Z = _mm_mul_ps(Z, invDet);
+			W = _mm_mul_ps(W, invDet);
+
+			//Undo the adjugates while putting the blocks back to rows
+			_mm_storeu_ps(out, shuffle<3, 1, 3, 1>(X, Y));
+			_mm_storeu_ps(out + 4, shuffle<2, 0, 2, 0>(X, Y));
+			_mm_storeu_ps(out + 8, shuffle<3, 1, 3, 1>(Z, W));
+			_mm_storeu_ps(out + 12, shuffle<2, 0, 2, 0>(Z, W));
+
+			return true;
+		}
+
+		void quatMulSSE2(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+		{
+			const F32* pa = reinterpret_cast<const F32*>(a);
+			const F32* pb = reinterpret_cast<const F32*>(b);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			for (U32 i = 0; i < count * 4; i += 4) {
+				_mm_storeu_ps(po + i, quatMul(_mm_loadu_ps(pa + i), _mm_loadu_ps(pb + i)));
+			}
+		}
+
+		//Four Vector3s are loaded as three registers (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3),
+		//split to x, y and z of all four for the lengths, and scaled in place
+		void vec3NormalizeSSE2(Vector3* v, U32 count)
+		{
+			F32* p = reinterpret_cast<F32*>(v);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, p += 12) {
+				const __m128 f0 = _mm_loadu_ps(p);
+				const __m128 f1 = _mm_loadu_ps(p + 4);
+				const __m128 f2 = _mm_loadu_ps(p + 8);
+
+				const __m128 x = shuffle<0, 1, 0, 2>(shuffle<0, 3, 0, 3>(f0, f0), shuffle<2, 2, 1, 1>(f1, f2));
+				const __m128 y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(f0, f1), shuffle<3, 3, 2, 2>(f1, f2));
+				const __m128 z = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(f0, f1), shuffle<0, 0, 3, 3>(f2, f2));
+
+				const __m128 len2 = madd(z, z, madd(y, y, _mm_mul_ps(x, x)));
+				const __m128 inv = rsqrt(len2);
+
+				_mm_storeu_ps(p, _mm_mul_ps(f0, shuffle<0, 0, 0, 1>(inv, inv)));
+				_mm_storeu_ps(p + 4, _mm_mul_ps(f1, shuffle<1, 1, 2, 2>(inv, inv)));
+				_mm_storeu_ps(p + 8, _mm_mul_ps(f2, shuffle<2, 3, 3, 3>(inv, inv)));
+			}
+
+			vec3NormalizeScalar(v + i, count - i);
+		}
+
+		//Four Quaternions are squared and transposed, so that summing the registers gives their lengths squared
+		void quatNormalizeSSE2(Quaternion* q, U32 count)
+		{
+			F32* p = reinterpret_cast<F32*>(q);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, p += 16) {
+				const __m128 q0 = _mm_loadu_ps(p);
+				const __m128 q1 = _mm_loadu_ps(p + 4);
+				const __m128 q2 = _mm_loadu_ps(p + 8);
+				const __m128 q3 = _mm_loadu_ps(p + 12);
+
+				__m128 s0 = _mm_mul_ps(q0, q0), s1 = _mm_mul_ps(q1, q1), s2 = _mm_mul_ps(q2, q2), s3 = _mm_mul_ps(q3, q3);
+				_MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+
+				const __m128 inv = rsqrt(_mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+
+				_mm_storeu_ps(p, _mm_mul_ps(q0, splat<0>(inv)));
+				_mm_storeu_ps(p + 4, _mm_mul_ps(q1, splat<1>(inv)));
+				_mm_storeu_ps(p + 8, _mm_mul_ps(q2, splat<2>(inv)));
+				_mm_storeu_ps(p + 12, _mm_mul_ps(q3, splat<3>(inv)));
+			}
+
+			quatNormalizeScalar(q + i, count - i);
+		}
+
+		//Four Quaternions per iteration, transposed to x, y, z and w registers so that every lane blends one pair.
+		//The shortest path flips the sign bits of b with the sign of the dot product, without branches
+		template<BlendMode mode>
+		static void quatBlendSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			const F32* pa = reinterpret_cast<const F32*>(a);
+			const F32* pb = reinterpret_cast<const F32*>(b);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			const __m128 signMask = _mm_set1_ps(-0.f);
+			const __m128 one = _mm_set1_ps(1.f);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 ax = _mm_loadu_ps(pa + i * 4), ay = _mm_loadu_ps(pa + i * 4 + 4), az = _mm_loadu_ps(pa + i * 4 + 8), aw = _mm_loadu_ps(pa + i * 4 + 12);
+				__m128 bx = _mm_loadu_ps(pb + i * 4), by = _mm_loadu_ps(pb + i * 4 + 4), bz = _mm_loadu_ps(pb + i * 4 + 8), bw = _mm_loadu_ps(pb + i * 4 + 12);
+				_MM_TRANSPOSE4_PS(ax, ay, az, aw);
+				_MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+				const __m128 vt = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + i), _mm_setzero_ps()), one);
+
+				__m128 d = madd(aw, bw, madd(az, bz, madd(ay, by, _mm_mul_ps(ax, bx))));
+				const __m128 sign = _mm_and_ps(d, signMask);
+				d = _mm_xor_ps(d, sign);
+
+				__m128 wa = _mm_sub_ps(one, vt), wb = vt;
+				if (mode == BLEND_SLERP_APPROX) {
+					const __m128 A = madd(madd(madd(_mm_set1_ps(-1.43519f), d, _mm_set1_ps(3.55645f)), d, _mm_set1_ps(-3.2452f)), d, _mm_set1_ps(1.0904f));
+					const __m128 B = madd(madd(_mm_set1_ps(0.215638f), d, _mm_set1_ps(-1.06021f)), d, _mm_set1_ps(0.848013f));
+					const __m128 th = _mm_sub_ps(vt, _mm_set1_ps(0.5f));
+					const __m128 k = madd(_mm_mul_ps(A, th), th, B);
+					wb = madd(_mm_mul_ps(_mm_mul_ps(vt, th), _mm_sub_ps(vt, one)), k, vt);
+					wa = _mm_sub_ps(one, wb);
+				}
+				else if (mode == BLEND_SLERP) {
+					//sin((1 - t) * angle) = sin(angle) * cos(t * angle) - cos(angle) * sin(t * angle)
+					d = _mm_min_ps(d, one);
+					const __m128 angle = fast::acos(d);
+					const __m128 sinAngle = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(d, d)));
+					__m128 st, ct;
+					fast::sincos(_mm_mul_ps(vt, angle), st, ct);
+
+					const __m128 useSlerp = _mm_cmpge_ps(sinAngle, _mm_set1_ps(SLERP_MIN_SIN));
+					wa = _mm_or_ps(_mm_and_ps(useSlerp, _mm_sub_ps(_mm_mul_ps(sinAngle, ct), _mm_mul_ps(d, st))), _mm_andnot_ps(useSlerp, wa));
+					wb = _mm_or_ps(_mm_and_ps(useSlerp, st), _mm_andnot_ps(useSlerp, wb));
+				}
+				wb = _mm_xor_ps(wb, sign);
+
+				__m128 x = madd(wa, ax, _mm_mul_ps(wb, bx));
+				__m128 y = madd(wa, ay, _mm_mul_ps(wb, by));
+				__m128 z = madd(wa, az, _mm_mul_ps(wb, bz));
+				__m128 w = madd(wa, aw, _mm_mul_ps(wb, bw));
+
+				const __m128 inv = rsqrt(madd(w, w, madd(z, z, madd(y, y, _mm_mul_ps(x, x)))));
+				x = _mm_mul_ps(x, inv);
+				y = _mm_mul_ps(y, inv);
+				z = _mm_mul_ps(z, inv);
+				w = _mm_mul_ps(w, inv);
+
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(po + i * 4, x);
+				_mm_storeu_ps(po + i * 4 + 4, y);
+				_mm_storeu_ps(po + i * 4 + 8, z);
+				_mm_storeu_ps(po + i * 4 + 12, w);
+			}
+
+			quatBlendScalar<mode>(a + i, b + i, t + i, out + i, count - i);
+		}
+
+		void quatNlerpSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendSSE2<BLEND_NLERP>(a, b, t, out, count);
+		}
+
+		void quatSlerpSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendSSE2<BLEND_SLERP>(a, b, t, out, count);
+		}
+
+		void quatSlerpApproxSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendSSE2<BLEND_SLERP_APPROX>(a, b, t, out, count);
+		}
+
+		//Splits four Vector3s, stored as (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3), to x, y and z of all four
+		static inline void loadVec3x4(const F32* p, __m128& x, __m128& y, __m128& z)
+		{
+			const __m128 f0 = _mm_loadu_ps(p);
+			const __m128 f1 = _mm_loadu_ps(p + 4);
+			const __m128 f2 = _mm_loadu_ps(p + 8);
+
+			x = shuffle<0, 1, 0, 2>(shuffle<0, 3, 0, 3>(f0, f0), shuffle<2, 2, 1, 1>(f1, f2));
+			y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(f0, f1), shuffle<3, 3, 2, 2>(f1, f2));
+			z = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(f0, f1), shuffle<0, 0, 3, 3>(f2, f2));
+		}
+
+		//Stores x, y and z of four vectors as four Vector3s, inverse of loadVec3x4()
+		static inline void storeVec3x4(F32* p, __m128 x, __m128 y, __m128 z)
+		{
+			const __m128 xyLo = _mm_unpacklo_ps(x, y);
+			const __m128 xyHi = _mm_unpackhi_ps(x, y);
+
+			_mm_storeu_ps(p, shuffle<0, 1, 0, 2>(xyLo, shuffle<0, 0, 1, 1>(z, x)));
+			_mm_storeu_ps(p + 4, shuffle<0, 2, 0, 1>(shuffle<1, 1, 1, 1>(y, z), xyHi));
+			_mm_storeu_ps(p + 8, shuffle<0, 2, 0, 2>(shuffle<2, 2, 2, 2>(z, xyHi), shuffle<3, 3, 3, 3>(xyHi, z)));
+		}
+
+		//The matrix is broadcast to registers once, and four vectors are transformed per iteration as x, y and z registers
+		template<TransformMode mode>
+		static void vec3TransformSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			//Points and directions only read the top 3 rows, so they also take the 12 F32s of an Affine3x4
+			__m128 e[16];
+			for (U32 i = 0; i < (mode == TRANSFORM_PROJECTIVE ? 16u : 12u); ++i) e[i] = _mm_set1_ps(m[i]);
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, pi += 12, po += 12) {
+				__m128 x, y, z;
+				loadVec3x4(pi, x, y, z);
+
+				__m128 rx = mode == TRANSFORM_DIRECTION ? _mm_mul_ps(e[2], z) : madd(e[2], z, e[3]);
+				__m128 ry = mode == TRANSFORM_DIRECTION ? _mm_mul_ps(e[6], z) : madd(e[6], z, e[7]);
+				__m128 rz = mode == TRANSFORM_DIRECTION ? _mm_mul_ps(e[10], z) : madd(e[10], z, e[11]);
+				rx = madd(e[0], x, madd(e[1], y, rx));
+				ry = madd(e[4], x, madd(e[5], y, ry));
+				rz = madd(e[8], x, madd(e[9], y, rz));
+
+				if (mode == TRANSFORM_PROJECTIVE) {
+					const __m128 w = madd(e[12], x, madd(e[13], y, madd(e[14], z, e[15])));
+					const __m128 invW = _mm_div_ps(_mm_set1_ps(1.f), w);
+					rx = _mm_mul_ps(rx, invW);
+					ry = _mm_mul_ps(ry, invW);
+					rz = _mm_mul_ps(rz, invW);
+				}
+
+				storeVec3x4(po, rx, ry, rz);
+			}
+
+			vec3TransformScalar<mode>(m, in + i, out + i, count - i);
+		}
+
+		void vec3TransformPointSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformSSE2<TRANSFORM_POINT>(m, in, out, count);
+		}
+
+		void vec3TransformDirSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformSSE2<TRANSFORM_DIRECTION>(m, in, out, count);
+		}
+
+		void vec3TransformProjSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformSSE2<TRANSFORM_PROJECTIVE>(m, in, out, count);
+		}
+
+		//Four Quaternions per iteration, transposed to x, y, z and w registers. Each row of the four matrices is computed
+		//as four column registers and transposed back
+		void quatToMat4SSE2(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count)
+		{
+			const F32* pq = reinterpret_cast<const F32*>(q);
+			const __m128 one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f);
+			const __m128 lastRow = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, out += 64) {
+				__m128 x = _mm_loadu_ps(pq + i * 4), y = _mm_loadu_ps(pq + i * 4 + 4), z = _mm_loadu_ps(pq + i * 4 + 8), w = _mm_loadu_ps(pq + i * 4 + 12);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+
+				__m128 sx = one, sy = one, sz = one;
+				if (s) loadVec3x4(reinterpret_cast<const F32*>(s + i), sx, sy, sz);
+
+				__m128 tx = _mm_setzero_ps(), ty = tx, tz = tx;
+				if (t) loadVec3x4(reinterpret_cast<const F32*>(t + i), tx, ty, tz);
+
+				const __m128 x2 = _mm_mul_ps(two, x), y2 = _mm_mul_ps(two, y), z2 = _mm_mul_ps(two, z);
+				const __m128 xx = _mm_mul_ps(x2, x), yy = _mm_mul_ps(y2, y), zz = _mm_mul_ps(z2, z);
+				const __m128 xy = _mm_mul_ps(x2, y), xz = _mm_mul_ps(x2, z), yz = _mm_mul_ps(y2, z);
+				const __m128 xw = _mm_mul_ps(x2, w), yw = _mm_mul_ps(y2, w), zw = _mm_mul_ps(z2, w);
+
+				__m128 r0 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+				__m128 r1 = _mm_mul_ps(_mm_sub_ps(xy, zw), sy);
+				__m128 r2 = _mm_mul_ps(_mm_add_ps(xz, yw), sz);
+				__m128 r3 = tx;
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(out, r0);
+				_mm_storeu_ps(out + 16, r1);
+				_mm_storeu_ps(out + 32, r2);
+				_mm_storeu_ps(out + 48, r3);
+
+				r0 = _mm_mul_ps(_mm_add_ps(xy, zw), sx);
+				r1 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+				r2 = _mm_mul_ps(_mm_sub_ps(yz, xw), sz);
+				r3 = ty;
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(out + 4, r0);
+				_mm_storeu_ps(out + 20, r1);
+				_mm_storeu_ps(out + 36, r2);
+				_mm_storeu_ps(out + 52, r3);
+
+				r0 = _mm_mul_ps(_mm_sub_ps(xz, yw), sx);
+				r1 = _mm_mul_ps(_mm_add_ps(yz, xw), sy);
+				r2 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+				r3 = tz;
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(out + 8, r0);
+				_mm_storeu_ps(out + 24, r1);
+				_mm_storeu_ps(out + 40, r2);
+				_mm_storeu_ps(out + 56, r3);
+
+				for (U32 k = 0; k < 4; ++k) _mm_storeu_ps(out + k * 16 + 12, lastRow);
+			}
+
+			quatToMat4Scalar(q + i, t ? t + i : nullptr, s ? s + i : nullptr, out, count - i);
+		}
+
+		//Shepperd's method for four matrices per iteration, the case of the largest diagonal sum is picked with masks.
+		//The rows of the four matrices are transposed to registers holding one element of all four
+		void mat4ToQuatSSE2(const F32* m, Quaternion* out, U32 count)
+		{
+			F32* po = reinterpret_cast<F32*>(out);
+			const __m128 one = _mm_set1_ps(1.f);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, m += 64, po += 16) {
+				__m128 m00 = _mm_loadu_ps(m), m01 = _mm_loadu_ps(m + 16), m02 = _mm_loadu_ps(m + 32), m03 = _mm_loadu_ps(m + 48);
+				__m128 m10 = _mm_loadu_ps(m + 4), m11 = _mm_loadu_ps(m + 20), m12 = _mm_loadu_ps(m + 36), m13 = _mm_loadu_ps(m + 52);
+				__m128 m20 = _mm_loadu_ps(m + 8), m21 = _mm_loadu_ps(m + 24), m22 = _mm_loadu_ps(m + 40), m23 = _mm_loadu_ps(m + 56);
+				_MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+				_MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+				_MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+
+				const __m128 tw = _mm_add_ps(_mm_add_ps(one, m00), _mm_add_ps(m11, m22));
+				const __m128 tx = _mm_sub_ps(_mm_add_ps(one, m00), _mm_add_ps(m11, m22));
+				const __m128 ty = _mm_sub_ps(_mm_add_ps(one, m11), _mm_add_ps(m00, m22));
+				const __m128 tz = _mm_sub_ps(_mm_add_ps(one, m22), _mm_add_ps(m00, m11));
+
+				const __m128 caseW = _mm_and_ps(_mm_cmpge_ps(tw, tx), _mm_and_ps(_mm_cmpge_ps(tw, ty), _mm_cmpge_ps(tw, tz)));
+				const __m128 caseX = _mm_andnot_ps(caseW, _mm_and_ps(_mm_cmpge_ps(tx, ty), _mm_cmpge_ps(tx, tz)));
+				const __m128 caseY = _mm_andnot_ps(_mm_or_ps(caseW, caseX), _mm_cmpge_ps(ty, tz));
+				const __m128 caseZ = _mm_andnot_ps(_mm_or_ps(_mm_or_ps(caseW, caseX), caseY), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+				const __m128 d21 = _mm_sub_ps(m21, m12), d02 = _mm_sub_ps(m02, m20), d10 = _mm_sub_ps(m10, m01);
+				const __m128 s10 = _mm_add_ps(m10, m01), s02 = _mm_add_ps(m02, m20), s21 = _mm_add_ps(m21, m12);
+
+				__m128 x = _mm_or_ps(_mm_or_ps(_mm_and_ps(caseW, d21), _mm_and_ps(caseX, tx)), _mm_or_ps(_mm_and_ps(caseY, s10), _mm_and_ps(caseZ, s02)));
+				__m128 y = _mm_or_ps(_mm_or_ps(_mm_and_ps(caseW, d02), _mm_and_ps(caseX, s10)), _mm_or_ps(_mm_and_ps(caseY, ty), _mm_and_ps(caseZ, s21)));
+				__m128 z = _mm_or_ps(_mm_or_ps(_mm_and_ps(caseW, d10), _mm_and_ps(caseX, s02)), _mm_or_ps(_mm_and_ps(caseY, s21), _mm_and_ps(caseZ, tz)));
+				__m128 w = _mm_or_ps(_mm_or_ps(_mm_and_ps(caseW, tw), _mm_and_ps(caseX, d21)), _mm_or_ps(_mm_and_ps(caseY, d02), _mm_and_ps(caseZ, d10)));
+
+				const __m128 inv = rsqrt(madd(w, w, madd(z, z, madd(y, y, _mm_mul_ps(x, x)))));
+				x = _mm_mul_ps(x, inv);
+				y = _mm_mul_ps(y, inv);
+				z = _mm_mul_ps(z, inv);
+				w = _mm_mul_ps(w, inv);
+
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(po, x);
+				_mm_storeu_ps(po + 4, y);
+				_mm_storeu_ps(po + 8, z);
+				_mm_storeu_ps(po + 12, w);
+			}
+
+			mat4ToQuatScalar(m, out + i, count - i);
+		}
+
+		//Blends the columns of the bones of one vertex, see skinScalar()
+		static inline void skinBlendSSE2(const F32* palette, const U16* bones, const F32* weights, U32 influences, __m128& c0, __m128& c1, __m128& c2, __m128& c3)
+		{
+			const F32* b = palette + bones[0] * 16;
+			__m128 w = _mm_set1_ps(weights[0]);
+			c0 = _mm_mul_ps(w, _mm_loadu_ps(b));
+			c1 = _mm_mul_ps(w, _mm_loadu_ps(b + 4));
+			c2 = _mm_mul_ps(w, _mm_loadu_ps(b + 8));
+			c3 = _mm_mul_ps(w, _mm_loadu_ps(b + 12));
+
+			for (U32 k = 1; k < influences; ++k) {
+				b = palette + bones[k] * 16;
+				w = _mm_set1_ps(weights[k]);
+				c0 = madd(w, _mm_loadu_ps(b), c0);
+				c1 = madd(w, _mm_loadu_ps(b + 4), c1);
+				c2 = madd(w, _mm_loadu_ps(b + 8), c2);
+				c3 = madd(w, _mm_loadu_ps(b + 12), c3);
+			}
+		}
+
+		//Four vertices per iteration. Each blended matrix stays in four column registers and transforms one vertex to
+		//an (x, y, z, 0) register, the four results are transposed to x, y and z registers for the stores and the normalize
+		void skinSSE2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 rp[4], rn[4];
+				for (U32 j = 0; j < 4; ++j) {
+					__m128 c0, c1, c2, c3;
+					skinBlendSSE2(palette, bones + (i + j) * influences, weights + (i + j) * influences, influences, c0, c1, c2, c3);
+
+					const Vector3& p = pos[i + j];
+					rp[j] = madd(c0, _mm_set1_ps(p.x), madd(c1, _mm_set1_ps(p.y), madd(c2, _mm_set1_ps(p.z), c3)));
+
+					if (nrm) {
+						const Vector3& n = nrm[i + j];
+						rn[j] = madd(c0, _mm_set1_ps(n.x), madd(c1, _mm_set1_ps(n.y), _mm_mul_ps(c2, _mm_set1_ps(n.z))));
+					}
+				}
+
+				_MM_TRANSPOSE4_PS(rp[0], rp[1], rp[2], rp[3]);
+				storeVec3x4(reinterpret_cast<F32*>(outPos + i), rp[0], rp[1], rp[2]);
+
+				if (nrm) {
+					_MM_TRANSPOSE4_PS(rn[0], rn[1], rn[2], rn[3]);
+					const __m128 inv = rsqrt(madd(rn[0], rn[0], madd(rn[1], rn[1], _mm_mul_ps(rn[2], rn[2]))));
+					storeVec3x4(reinterpret_cast<F32*>(outNrm + i), _mm_mul_ps(rn[0], inv), _mm_mul_ps(rn[1], inv), _mm_mul_ps(rn[2], inv));
+				}
+			}
+
+			skinScalar(palette, pos + i, nrm ? nrm + i : nullptr, bones + i * influences, weights + i * influences, influences, outPos + i, outNrm ? outNrm + i : nullptr, count - i);
+		}
+
+		//Rotates (x, y, z) by the normalized real parts (rx, ry, rz, rw) as in DualQuaternion::transformDirection()
+		static inline void dualQuatRotateSSE2(__m128 rx, __m128 ry, __m128 rz, __m128 rw, __m128& x, __m128& y, __m128& z)
+		{
+			const __m128 ax = madd(rw, x, _mm_sub_ps(_mm_mul_ps(ry, z), _mm_mul_ps(rz, y)));
+			const __m128 ay = madd(rw, y, _mm_sub_ps(_mm_mul_ps(rz, x), _mm_mul_ps(rx, z)));
+			const __m128 az = madd(rw, z, _mm_sub_ps(_mm_mul_ps(rx, y), _mm_mul_ps(ry, x)));
+			const __m128 two = _mm_set1_ps(2.f);
+
+			x = madd(two, _mm_sub_ps(_mm_mul_ps(ry, az), _mm_mul_ps(rz, ay)), x);
+			y = madd(two, _mm_sub_ps(_mm_mul_ps(rz, ax), _mm_mul_ps(rx, az)), y);
+			z = madd(two, _mm_sub_ps(_mm_mul_ps(rx, ay), _mm_mul_ps(ry, ax)), z);
+		}
+
+		//Four vertices per iteration in x, y and z registers. For each influence the DualQuaternions of the four bones are
+		//transposed to registers of one component each, then blended as in skinDualQuatScalar()
+		void skinDualQuatSSE2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			const __m128 signBit = _mm_set1_ps(-0.f);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const U16* bi = bones + i * influences;
+				const F32* wi = weights + i * influences;
+
+				__m128 q[8], first[4];
+				for (U32 k = 0; k < influences; ++k) {
+					const F32* b0 = palette + bi[k] * 8;
+					const F32* b1 = palette + bi[influences + k] * 8;
+					const F32* b2 = palette + bi[2 * influences + k] * 8;
+					const F32* b3 = palette + bi[3 * influences + k] * 8;
+
+					__m128 rx = _mm_loadu_ps(b0), ry = _mm_loadu_ps(b1), rz = _mm_loadu_ps(b2), rw = _mm_loadu_ps(b3);
+					__m128 dx = _mm_loadu_ps(b0 + 4), dy = _mm_loadu_ps(b1 + 4), dz = _mm_loadu_ps(b2 + 4), dw = _mm_loadu_ps(b3 + 4);
+					_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+					_MM_TRANSPOSE4_PS(dx, dy, dz, dw);
+
+					__m128 w = _mm_setr_ps(wi[k], wi[influences + k], wi[2 * influences + k], wi[3 * influences + k]);
+					if (k == 0) {
+						first[0] = rx; first[1] = ry; first[2] = rz; first[3] = rw;
+						q[0] = _mm_mul_ps(w, rx); q[1] = _mm_mul_ps(w, ry); q[2] = _mm_mul_ps(w, rz); q[3] = _mm_mul_ps(w, rw);
+						q[4] = _mm_mul_ps(w, dx); q[5] = _mm_mul_ps(w, dy); q[6] = _mm_mul_ps(w, dz); q[7] = _mm_mul_ps(w, dw);
+						continue;
+					}
+
+					const __m128 d = madd(rx, first[0], madd(ry, first[1], madd(rz, first[2], _mm_mul_ps(rw, first[3]))));
+					w = _mm_xor_ps(w, _mm_and_ps(_mm_cmplt_ps(d, _mm_setzero_ps()), signBit));
+
+					q[0] = madd(w, rx, q[0]); q[1] = madd(w, ry, q[1]); q[2] = madd(w, rz, q[2]); q[3] = madd(w, rw, q[3]);
+					q[4] = madd(w, dx, q[4]); q[5] = madd(w, dy, q[5]); q[6] = madd(w, dz, q[6]); q[7] = madd(w, dw, q[7]);
+				}
+
+				const __m128 inv = rsqrt(madd(q[0], q[0], madd(q[1], q[1], madd(q[2], q[2], _mm_mul_ps(q[3], q[3])))));
+				for (U32 e = 0; e < 8; ++e) q[e] = _mm_mul_ps(q[e], inv);
+
+				//Translation 2 * (rw * dv - dw * rv + rv x dv)
+				const __m128 two = _mm_set1_ps(2.f);
+				const __m128 tx = _mm_mul_ps(two, madd(q[3], q[4], _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q[1], q[6]), _mm_mul_ps(q[2], q[5])), _mm_mul_ps(q[7], q[0]))));
+				const __m128 ty = _mm_mul_ps(two, madd(q[3], q[5], _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q[2], q[4]), _mm_mul_ps(q[0], q[6])), _mm_mul_ps(q[7], q[1]))));
+				const __m128 tz = _mm_mul_ps(two, madd(q[3], q[6], _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q[0], q[5]), _mm_mul_ps(q[1], q[4])), _mm_mul_ps(q[7], q[2]))));
+
+				__m128 x, y, z;
+				loadVec3x4(reinterpret_cast<const F32*>(pos + i), x, y, z);
+				dualQuatRotateSSE2(q[0], q[1], q[2], q[3], x, y, z);
+				storeVec3x4(reinterpret_cast<F32*>(outPos + i), _mm_add_ps(x, tx), _mm_add_ps(y, ty), _mm_add_ps(z, tz));
+
+				if (nrm) {
+					loadVec3x4(reinterpret_cast<const F32*>(nrm + i), x, y, z);
+					dualQuatRotateSSE2(q[0], q[1], q[2], q[3], x, y, z);
+					storeVec3x4(reinterpret_cast<F32*>(outNrm + i), x, y, z);
+				}
+			}
+
+			skinDualQuatScalar(palette, pos + i, nrm ? nrm + i : nullptr, bones + i * influences, weights + i * influences, influences, outPos + i, outNrm ? outNrm + i : nullptr, count - i);
+		}
+
+		void fastSinCosSSE2(const F32* x, F32* s, F32* c, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 vs, vc;
+				fast::sincos(_mm_loadu_ps(x + i), vs, vc);
+				_mm_storeu_ps(s + i, vs);
+				_mm_storeu_ps(c + i, vc);
+			}
+
+			fastSinCosScalar(x + i, s + i, c + i, count - i);
+		}
+
+		void fastAcosSSE2(const F32* x, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(out + i, fast::acos(_mm_loadu_ps(x + i)));
+			}
+
+			fastAcosScalar(x + i, out + i, count - i);
+		}
+
+		void fastAtan2SSE2(const F32* y, const F32* x, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(out + i, fast::atan2(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+			}
+
+			fastAtan2Scalar(y + i, x + i, out + i, count - i);
+		}
+
+		//The SoA kernels process 4 elements per iteration, the rest on the scalar kernels
+
+		void soaAddSSE2(const F32* a, const F32* b, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			}
+
+			soaAddScalar(a + i, b + i, out + i, count - i);
+		}
+
+		void soaScaleSSE2(const F32* a, F32 s, F32* out, U32 count)
+		{
+			const __m128 vs = _mm_set1_ps(s);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), vs));
+			}
+
+			soaScaleScalar(a + i, s, out + i, count - i);
+		}
+
+		void soaLerpSSE2(const F32* a, const F32* b, F32 t, F32* out, U32 count)
+		{
+			const __m128 vt = _mm_set1_ps(t);
+			const __m128 vt1 = _mm_set1_ps(1 - t);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(out + i, madd(vt1, _mm_loadu_ps(a + i), _mm_mul_ps(vt, _mm_loadu_ps(b + i))));
+			}
+
+			soaLerpScalar(a + i, b + i, t, out + i, count - i);
+		}
+
+		void soaDot3SSE2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 d = _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+				d = madd(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i), d);
+				d = madd(_mm_loadu_ps(az + i), _mm_loadu_ps(bz + i), d);
+				_mm_storeu_ps(out + i, d);
+			}
+
+			soaDot3Scalar(ax + i, ay + i, az + i, bx + i, by + i, bz + i, out + i, count - i);
+		}
+
+		void soaCross3SSE2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m128 vax = _mm_loadu_ps(ax + i), vay = _mm_loadu_ps(ay + i), vaz = _mm_loadu_ps(az + i);
+				const __m128 vbx = _mm_loadu_ps(bx + i), vby = _mm_loadu_ps(by + i), vbz = _mm_loadu_ps(bz + i);
+
+				_mm_storeu_ps(ox + i, _mm_sub_ps(_mm_mul_ps(vay, vbz), _mm_mul_ps(vaz, vby)));
+				_mm_storeu_ps(oy + i, _mm_sub_ps(_mm_mul_ps(vaz, vbx), _mm_mul_ps(vax, vbz)));
+				_mm_storeu_ps(oz + i, _mm_sub_ps(_mm_mul_ps(vax, vby), _mm_mul_ps(vay, vbx)));
+			}
+
+			soaCross3Scalar(ax + i, ay + i, az + i, bx + i, by + i, bz + i, ox + i, oy + i, oz + i, count - i);
+		}
+
+		void soaNormalize3SSE2(F32* x, F32* y, F32* z, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+				const __m128 inv = rsqrt(madd(vz, vz, madd(vy, vy, _mm_mul_ps(vx, vx))));
+
+				_mm_storeu_ps(x + i, _mm_mul_ps(vx, inv));
+				_mm_storeu_ps(y + i, _mm_mul_ps(vy, inv));
+				_mm_storeu_ps(z + i, _mm_mul_ps(vz, inv));
+			}
+
+			soaNormalize3Scalar(x + i, y + i, z + i, count - i);
+		}
+
+		//Splits four AABBs to x, y and z of their minimum corners and of their maximum corners.
+		//As Vector3s the boxes are min 0, max 0, min 1, max 1 and so on
+		static inline void loadAABBx4(const F32* p, __m128* mn, __m128* mx)
+		{
+			__m128 a[3], b[3];
+			loadVec3x4(p, a[0], a[1], a[2]);
+			loadVec3x4(p + 12, b[0], b[1], b[2]);
+
+			for (U32 k = 0; k < 3; ++k) {
+				mn[k] = shuffle<0, 2, 0, 2>(a[k], b[k]);
+				mx[k] = shuffle<1, 3, 1, 3>(a[k], b[k]);
+			}
+		}
+
+		//Stores four AABBs from x, y and z of their corners
+		static inline void storeAABBx4(F32* p, const __m128* mn, const __m128* mx)
+		{
+			storeVec3x4(p, _mm_unpacklo_ps(mn[0], mx[0]), _mm_unpacklo_ps(mn[1], mx[1]), _mm_unpacklo_ps(mn[2], mx[2]));
+			storeVec3x4(p + 12, _mm_unpackhi_ps(mn[0], mx[0]), _mm_unpackhi_ps(mn[1], mx[1]), _mm_unpackhi_ps(mn[2], mx[2]));
+		}
+
+		//Loads the top 3 rows of four matrices stride F32s apart, with element k of all four in e[k]
+		static inline void loadAffinex4(const F32* m, size_t stride, __m128* e)
+		{
+			for (U32 r = 0; r < 12; r += 4) {
+				__m128 m0 = _mm_loadu_ps(m + r);
+				__m128 m1 = _mm_loadu_ps(m + stride + r);
+				__m128 m2 = _mm_loadu_ps(m + 2 * stride + r);
+				__m128 m3 = _mm_loadu_ps(m + 3 * stride + r);
+				_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+
+				e[r] = m0; e[r + 1] = m1; e[r + 2] = m2; e[r + 3] = m3;
+			}
+		}
+
+		//aabbTransformScalar() for four boxes given as corners, with their matrices in e as from loadAffinex4()
+		static inline void aabbTransformx4(const __m128* e, __m128* mn, __m128* mx)
+		{
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+			__m128 c[3], x[3];
+			for (U32 k = 0; k < 3; ++k) {
+				c[k] = _mm_mul_ps(_mm_add_ps(mn[k], mx[k]), half);
+				x[k] = _mm_mul_ps(_mm_sub_ps(mx[k], mn[k]), half);
+			}
+
+			for (U32 r = 0; r < 3; ++r) {
+				const __m128* row = e + r * 4;
+				const __m128 cr = madd(row[0], c[0], madd(row[1], c[1], madd(row[2], c[2], row[3])));
+				const __m128 xr = madd(_mm_and_ps(row[0], absMask), x[0], madd(_mm_and_ps(row[1], absMask), x[1], _mm_mul_ps(_mm_and_ps(row[2], absMask), x[2])));
+
+				mn[r] = _mm_sub_ps(cr, xr);
+				mx[r] = _mm_add_ps(cr, xr);
+			}
+		}
+
+		//Four boxes per iteration. A shared matrix is broadcast once, per-box matrices are transposed four at a time
+		void aabbTransformSSE2(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count)
+		{
+			__m128 e[12];
+			if (mStride == 0) {
+				for (U32 k = 0; k < 12; ++k) e[k] = _mm_set1_ps(m[k]);
+			}
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, pi += 24, po += 24) {
+				if (mStride != 0) loadAffinex4(m + size_t(i) * mStride, mStride, e);
+
+				__m128 mn[3], mx[3];
+				loadAABBx4(pi, mn, mx);
+				aabbTransformx4(e, mn, mx);
+				storeAABBx4(po, mn, mx);
+			}
+
+			aabbTransformScalar(m + size_t(i) * mStride, mStride, in + i, out + i, count - i);
+		}
+
+		//Maximum corners are accumulated negated, so that one min covers both corners. Two boxes fill three registers,
+		//so every lane of the accumulators always meets the same component
+		void aabbMergeSSE2(const AABB* in, U32 count, AABB* out)
+		{
+			alignas(16) F32 f[12];
+			for (U32 k = 0; k < 12; ++k) f[k] = k % 6 < 3 ? 0.f : -0.f;
+			const __m128 flip[3] = { _mm_load_ps(f), _mm_load_ps(f + 4), _mm_load_ps(f + 8) };
+
+			const __m128 inf = _mm_set1_ps(std::numeric_limits<F32>::infinity());
+			__m128 acc[3] = { inf, inf, inf };
+
+			const F32* p = reinterpret_cast<const F32*>(in);
+
+			U32 i = 0;
+			for (; i + 2 <= count; i += 2, p += 12) {
+				for (U32 k = 0; k < 3; ++k) acc[k] = _mm_min_ps(acc[k], _mm_xor_ps(_mm_loadu_ps(p + k * 4), flip[k]));
+			}
+
+			for (U32 k = 0; k < 3; ++k) _mm_store_ps(f + k * 4, _mm_xor_ps(acc[k], flip[k]));
+			const AABB* partial = reinterpret_cast<const AABB*>(f);
+
+			AABB res;
+			aabbMergeScalar(in + i, count - i, &res);
+			res.merge(partial[0]);
+			res.merge(partial[1]);
+			*out = res;
+		}
+
+		//Returns the length of the longest column of the 3x3 parts of the matrices in e
+		static inline __m128 maxScalex4(const __m128* e)
+		{
+			const __m128 sx = madd(e[8], e[8], madd(e[4], e[4], _mm_mul_ps(e[0], e[0])));
+			const __m128 sy = madd(e[9], e[9], madd(e[5], e[5], _mm_mul_ps(e[1], e[1])));
+			const __m128 sz = madd(e[10], e[10], madd(e[6], e[6], _mm_mul_ps(e[2], e[2])));
+
+			return _mm_sqrt_ps(_mm_max_ps(sx, _mm_max_ps(sy, sz)));
+		}
+
+		//Four spheres per iteration, transposed to x, y, z and radius registers
+		void sphereTransformSSE2(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count)
+		{
+			__m128 e[12], scale = _mm_setzero_ps();
+			if (mStride == 0) {
+				for (U32 k = 0; k < 12; ++k) e[k] = _mm_set1_ps(m[k]);
+				scale = maxScalex4(e);
+			}
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, pi += 16, po += 16) {
+				if (mStride != 0) {
+					loadAffinex4(m + size_t(i) * mStride, mStride, e);
+					scale = maxScalex4(e);
+				}
+
+				__m128 x = _mm_loadu_ps(pi), y = _mm_loadu_ps(pi + 4), z = _mm_loadu_ps(pi + 8), r = _mm_loadu_ps(pi + 12);
+				_MM_TRANSPOSE4_PS(x, y, z, r);
+
+				__m128 cx = madd(e[0], x, madd(e[1], y, madd(e[2], z, e[3])));
+				__m128 cy = madd(e[4], x, madd(e[5], y, madd(e[6], z, e[7])));
+				__m128 cz = madd(e[8], x, madd(e[9], y, madd(e[10], z, e[11])));
+				r = _mm_mul_ps(r, scale);
+				_MM_TRANSPOSE4_PS(cx, cy, cz, r);
+
+				_mm_storeu_ps(po, cx);
+				_mm_storeu_ps(po + 4, cy);
+				_mm_storeu_ps(po + 8, cz);
+				_mm_storeu_ps(po + 12, r);
+			}
+
+			sphereTransformScalar(m + size_t(i) * mStride, mStride, in + i, out + i, count - i);
+		}
+
+		//Writes first + k to visible[n] for every lane k of a group of width objects, advancing n past the lanes set in mask.
+		//Compacts the visible indices without branches, and stays within visible since n <= first + k
+		static inline U32 appendVisible(U32* visible, U32 n, U32 first, U32 mask, U32 width)
+		{
+			for (U32 k = 0; k < width; ++k) {
+				visible[n] = first + k;
+				n += (mask >> k) & 1;
+			}
+
+			return n;
+		}
+
+		//Four spheres per iteration. Opposite planes are tested in pairs until all four are outside one, which halves the branches
+		//of the early-out, and groups with nothing visible skip the compaction
+		U32 cullSpheresSSE2(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible)
+		{
+			__m128 pl[24];
+			for (U32 k = 0; k < 24; ++k) pl[k] = _mm_set1_ps(planes[k]);
+
+			U32 n = 0, i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+				const __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+
+				U32 mask = 0xF;
+				for (U32 p = 0; p < 24 && mask != 0; p += 8) {
+					const __m128 d0 = madd(pl[p + 2], vz, madd(pl[p + 1], vy, madd(pl[p], vx, pl[p + 3])));
+					const __m128 d1 = madd(pl[p + 6], vz, madd(pl[p + 5], vy, madd(pl[p + 4], vx, pl[p + 7])));
+					mask &= U32(_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(d0, negR), _mm_cmpge_ps(d1, negR))));
+				}
+
+				if (mask != 0) n = appendVisible(visible, n, i, mask, 4);
+			}
+
+			const U32 tail = cullSpheresScalar(planes, x + i, y + i, z + i, r + i, count - i, visible + n);
+			for (U32 k = 0; k < tail; ++k) visible[n + k] += i;
+			return n + tail;
+		}
+
+		//Four boxes per iteration, same as cullSpheresSSE2()
+		U32 cullAABBsSSE2(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible)
+		{
+			//Normals, their absolute values and -2d of each plane
+			__m128 pn[18], pa[18], pd[6];
+			for (U32 p = 0; p < 6; ++p) {
+				for (U32 k = 0; k < 3; ++k) {
+					pn[p * 3 + k] = _mm_set1_ps(planes[p * 4 + k]);
+					pa[p * 3 + k] = _mm_set1_ps(fabsf(planes[p * 4 + k]));
+				}
+				pd[p] = _mm_set1_ps(-2.f * planes[p * 4 + 3]);
+			}
+
+			U32 n = 0, i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m128 mnx = _mm_loadu_ps(minX + i), mny = _mm_loadu_ps(minY + i), mnz = _mm_loadu_ps(minZ + i);
+				const __m128 mxx = _mm_loadu_ps(maxX + i), mxy = _mm_loadu_ps(maxY + i), mxz = _mm_loadu_ps(maxZ + i);
+				const __m128 sx = _mm_add_ps(mnx, mxx), sy = _mm_add_ps(mny, mxy), sz = _mm_add_ps(mnz, mxz);
+				const __m128 ex = _mm_sub_ps(mxx, mnx), ey = _mm_sub_ps(mxy, mny), ez = _mm_sub_ps(mxz, mnz);
+
+				U32 mask = 0xF;
+				for (U32 p = 0; p < 6 && mask != 0; p += 2) {
+					__m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for (U32 q = p; q < p + 2; ++q) {
+						const __m128* vn = pn + q * 3;
+						const __m128* va = pa + q * 3;
+						__m128 d = _mm_mul_ps(va[2], ez);
+						d = madd(va[1], ey, d);
+						d = madd(va[0], ex, d);
+						d = madd(vn[2], sz, d);
+						d = madd(vn[1], sy, d);
+						d = madd(vn[0], sx, d);
+						in = _mm_and_ps(in, _mm_cmpge_ps(d, pd[q]));
+					}
+					mask &= U32(_mm_movemask_ps(in));
+				}
+
+				if (mask != 0) n = appendVisible(visible, n, i, mask, 4);
+			}
+
+			const U32 tail = cullAABBsScalar(planes, minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i, count - i, visible + n);
+			for (U32 k = 0; k < tail; ++k) visible[n + k] += i;
+			return n + tail;
+		}
+
+
+		//AVX2 and FMA
+
+		//Returns element i of each 128-bit half of v in all lanes of that half
+		template<int i>
+		MATH_TARGET("avx2,fma") static inline __m256 splat256(__m256 v)
+		{
+			return _mm256_permute_ps(v, _MM_SHUFFLE(i, i, i, i));
+		}
+
+		//Returns 1 / sqrt(x), same as Math::simd::rsqrt() with fused Newton-Raphson step
+		MATH_TARGET("avx2,fma") static inline __m256 rsqrt256(__m256 x)
+		{
+			const __m256 y = _mm256_rsqrt_ps(x);
+			const __m256 hxy = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), y);
+			return _mm256_mul_ps(y, _mm256_fnmadd_ps(hxy, y, _mm256_set1_ps(1.5f)));
+		}
+
+		//Two rows per register
+		MATH_TARGET("avx2,fma") void mat4MulAVX2(const F32* a, const F32* b, F32* out)
+		{
+			const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+			const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+			const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+			const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+
+			const __m256 a01 = _mm256_loadu_ps(a);
+			const __m256 a23 = _mm256_loadu_ps(a + 8);
+
+			__m256 r01 = _mm256_mul_ps(splat256<0>(a01), b0);
+			r01 = _mm256_fmadd_ps(splat256<1>(a01), b1, r01);
+			r01 = _mm256_fmadd_ps(splat256<2>(a01), b2, r01);
+			r01 = _mm256_fmadd_ps(splat256<3>(a01), b3, r01);
+
+			__m256 r23 = _mm256_mul_ps(splat256<0>(a23), b0);
+			r23 = _mm256_fmadd_ps(splat256<1>(a23), b1, r23);
+			r23 = _mm256_fmadd_ps(splat256<2>(a23), b2, r23);
+			r23 = _mm256_fmadd_ps(splat256<3>(a23), b3, r23);
+
+			_mm256_storeu_ps(out, r01);
+			_mm256_storeu_ps(out + 8, r23);
+		}
+
+		MATH_TARGET("avx2,fma") void mat4MulIndexedAVX2(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				mat4MulAVX2(a + aIdx[i] * 16, b + i * 16, out + i * 16);
+			}
+		}
+
+		//Two Quaternions per register, same terms as Math::simd::quatMul()
+		MATH_TARGET("avx2,fma") void quatMulAVX2(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+		{
+			const __m256 sign1 = _mm256_setr_ps(0.f, 0.f, -0.f, -0.f, 0.f, 0.f, -0.f, -0.f);
+			const __m256 sign2 = _mm256_setr_ps(-0.f, 0.f, 0.f, -0.f, -0.f, 0.f, 0.f, -0.f);
+			const __m256 sign3 = _mm256_setr_ps(0.f, -0.f, 0.f, -0.f, 0.f, -0.f, 0.f, -0.f);
+
+			const F32* pa = reinterpret_cast<const F32*>(a);
+			const F32* pb = reinterpret_cast<const F32*>(b);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 2 <= count; i += 2) {
+				const __m256 qa = _mm256_loadu_ps(pa + i * 4);
+				const __m256 qb = _mm256_loadu_ps(pb + i * 4);
+
+				__m256 r = _mm256_mul_ps(splat256<3>(qb), qa);
+				r = _mm256_fmadd_ps(splat256<0>(qb), _mm256_xor_ps(_mm256_permute_ps(qa, _MM_SHUFFLE(0, 1, 2, 3)), sign1), r);
+				r = _mm256_fmadd_ps(splat256<1>(qb), _mm256_xor_ps(_mm256_permute_ps(qa, _MM_SHUFFLE(1, 0, 3, 2)), sign2), r);
+				r = _mm256_fmadd_ps(splat256<2>(qb), _mm256_xor_ps(_mm256_permute_ps(qa, _MM_SHUFFLE(2, 3, 0, 1)), sign3), r);
+
+				_mm256_storeu_ps(po + i * 4, r);
+			}
+
+			quatMulSSE2(a + i, b + i, out + i, count - i);
+		}
+
+		//Eight Vector3s are loaded as three registers. One permutation per register moves x, y or z of the vectors
+		//to the lanes of their vector indices, and blends pick each lane from the register that has it.
+		MATH_TARGET("avx2,fma") void vec3NormalizeAVX2(Vector3* v, U32 count)
+		{
+			const __m256i xIdx = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+			const __m256i yIdx = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+			const __m256i zIdx = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+
+			//Inverse length of each vector, repeated for its three floats
+			const __m256i s0Idx = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+			const __m256i s1Idx = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+			const __m256i s2Idx = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+			F32* p = reinterpret_cast<F32*>(v);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, p += 24) {
+				const __m256 f0 = _mm256_loadu_ps(p);
+				const __m256 f1 = _mm256_loadu_ps(p + 8);
+				const __m256 f2 = _mm256_loadu_ps(p + 16);
+
+				__m256 x = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, xIdx), _mm256_permutevar8x32_ps(f1, xIdx), 0x38);
+				x = _mm256_blend_ps(x, _mm256_permutevar8x32_ps(f2, xIdx), 0xC0);
+
+				__m256 y = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, yIdx), _mm256_permutevar8x32_ps(f1, yIdx), 0x18);
+				y = _mm256_blend_ps(y, _mm256_permutevar8x32_ps(f2, yIdx), 0xE0);
+
+				__m256 z = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, zIdx), _mm256_permutevar8x32_ps(f1, zIdx), 0x1C);
+				z = _mm256_blend_ps(z, _mm256_permutevar8x32_ps(f2, zIdx), 0xE0);
+
+				const __m256 len2 = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+				const __m256 inv = rsqrt256(len2);
+
+				_mm256_storeu_ps(p, _mm256_mul_ps(f0, _mm256_permutevar8x32_ps(inv, s0Idx)));
+				_mm256_storeu_ps(p + 8, _mm256_mul_ps(f1, _mm256_permutevar8x32_ps(inv, s1Idx)));
+				_mm256_storeu_ps(p + 16, _mm256_mul_ps(f2, _mm256_permutevar8x32_ps(inv, s2Idx)));
+			}
+
+			vec3NormalizeSSE2(v + i, count - i);
+		}
+
+		//Eight Quaternions in four registers, two per register. Two rounds of horizontal adds leave the lengths squared
+		//of Quaternions 0, 2, 4, 6 in the low half and of 1, 3, 5, 7 in the high half, matching the halves of the registers.
+		MATH_TARGET("avx2,fma") void quatNormalizeAVX2(Quaternion* q, U32 count)
+		{
+			F32* p = reinterpret_cast<F32*>(q);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, p += 32) {
+				const __m256 q01 = _mm256_loadu_ps(p);
+				const __m256 q23 = _mm256_loadu_ps(p + 8);
+				const __m256 q45 = _mm256_loadu_ps(p + 16);
+				const __m256 q67 = _mm256_loadu_ps(p + 24);
+
+				const __m256 h0 = _mm256_hadd_ps(_mm256_mul_ps(q01, q01), _mm256_mul_ps(q23, q23));
+				const __m256 h1 = _mm256_hadd_ps(_mm256_mul_ps(q45, q45), _mm256_mul_ps(q67, q67));
+				const __m256 inv = rsqrt256(_mm256_hadd_ps(h0, h1));
+
+				_mm256_storeu_ps(p, _mm256_mul_ps(q01, splat256<0>(inv)));
+				_mm256_storeu_ps(p + 8, _mm256_mul_ps(q23, splat256<1>(inv)));
+				_mm256_storeu_ps(p + 16, _mm256_mul_ps(q45, splat256<2>(inv)));
+				_mm256_storeu_ps(p + 24, _mm256_mul_ps(q67, splat256<3>(inv)));
+			}
+
+			quatNormalizeSSE2(q + i, count - i);
+		}
+
+		//Transposes the 4x4 blocks in the low halves and in the high halves of r0 to r3. Four registers of two Quaternions each
+		//become x, y, z and w of Quaternions 0, 2, 4, 6 in the low halves and 1, 3, 5, 7 in the high halves, and back
+		MATH_TARGET("avx2,fma") static inline void transpose2x4x4(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+		{
+			const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+			const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+			const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+			const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+			r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		//Same as quatBlendSSE2(), eight Quaternions per iteration. t is permuted to the lane order of transpose2x4x4()
+		template<BlendMode mode>
+		MATH_TARGET("avx2,fma") static void quatBlendAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			const F32* pa = reinterpret_cast<const F32*>(a);
+			const F32* pb = reinterpret_cast<const F32*>(b);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			const __m256i tIdx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+			const __m256 signMask = _mm256_set1_ps(-0.f);
+			const __m256 one = _mm256_set1_ps(1.f);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 ax = _mm256_loadu_ps(pa + i * 4), ay = _mm256_loadu_ps(pa + i * 4 + 8), az = _mm256_loadu_ps(pa + i * 4 + 16), aw = _mm256_loadu_ps(pa + i * 4 + 24);
+				__m256 bx = _mm256_loadu_ps(pb + i * 4), by = _mm256_loadu_ps(pb + i * 4 + 8), bz = _mm256_loadu_ps(pb + i * 4 + 16), bw = _mm256_loadu_ps(pb + i * 4 + 24);
+				transpose2x4x4(ax, ay, az, aw);
+				transpose2x4x4(bx, by, bz, bw);
+
+				__m256 vt = _mm256_permutevar8x32_ps(_mm256_loadu_ps(t + i), tIdx);
+				vt = _mm256_min_ps(_mm256_max_ps(vt, _mm256_setzero_ps()), one);
+
+				__m256 d = _mm256_fmadd_ps(aw, bw, _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx))));
+				const __m256 sign = _mm256_and_ps(d, signMask);
+				d = _mm256_xor_ps(d, sign);
+
+				__m256 wa = _mm256_sub_ps(one, vt), wb = vt;
+				if (mode == BLEND_SLERP_APPROX) {
+					const __m256 A = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(-1.43519f), d, _mm256_set1_ps(3.55645f)), d, _mm256_set1_ps(-3.2452f)), d, _mm256_set1_ps(1.0904f));
+					const __m256 B = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(0.215638f), d, _mm256_set1_ps(-1.06021f)), d, _mm256_set1_ps(0.848013f));
+					const __m256 th = _mm256_sub_ps(vt, _mm256_set1_ps(0.5f));
+					const __m256 k = _mm256_fmadd_ps(_mm256_mul_ps(A, th), th, B);
+					wb = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_mul_ps(vt, th), _mm256_sub_ps(vt, one)), k, vt);
+					wa = _mm256_sub_ps(one, wb);
+				}
+				else if (mode == BLEND_SLERP) {
+					d = _mm256_min_ps(d, one);
+					const __m256 angle = fast::acos(d);
+					const __m256 sinAngle = _mm256_sqrt_ps(_mm256_fnmadd_ps(d, d, one));
+					__m256 st, ct;
+					fast::sincos(_mm256_mul_ps(vt, angle), st, ct);
+
+					const __m256 useSlerp = _mm256_cmp_ps(sinAngle, _mm256_set1_ps(SLERP_MIN_SIN), _CMP_GE_OQ);
+					wa = _mm256_blendv_ps(wa, _mm256_fmsub_ps(sinAngle, ct, _mm256_mul_ps(d, st)), useSlerp);
+					wb = _mm256_blendv_ps(wb, st, useSlerp);
+				}
+				wb = _mm256_xor_ps(wb, sign);
+
+				__m256 x = _mm256_fmadd_ps(wa, ax, _mm256_mul_ps(wb, bx));
+				__m256 y = _mm256_fmadd_ps(wa, ay, _mm256_mul_ps(wb, by));
+				__m256 z = _mm256_fmadd_ps(wa, az, _mm256_mul_ps(wb, bz));
+				__m256 w = _mm256_fmadd_ps(wa, aw, _mm256_mul_ps(wb, bw));
+
+				const __m256 inv = rsqrt256(_mm256_fmadd_ps(w, w, _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)))));
+				x = _mm256_mul_ps(x, inv);
+				y = _mm256_mul_ps(y, inv);
+				z = _mm256_mul_ps(z, inv);
+				w = _mm256_mul_ps(w, inv);
+
+				transpose2x4x4(x, y, z, w);
+				_mm256_storeu_ps(po + i * 4, x);
+				_mm256_storeu_ps(po + i * 4 + 8, y);
+				_mm256_storeu_ps(po + i * 4 + 16, z);
+				_mm256_storeu_ps(po + i * 4 + 24, w);
+			}
+
+			quatBlendSSE2<mode>(a + i, b + i, t + i, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void quatNlerpAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendAVX2<BLEND_NLERP>(a, b, t, out, count);
+		}
+
+		MATH_TARGET("avx2,fma") void quatSlerpAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendAVX2<BLEND_SLERP>(a, b, t, out, count);
+		}
+
+		MATH_TARGET("avx2,fma") void quatSlerpApproxAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count)
+		{
+			quatBlendAVX2<BLEND_SLERP_APPROX>(a, b, t, out, count);
+		}
+
+		//Splits eight Vector3s from three registers to x, y and z of all eight, see vec3NormalizeAVX2()
+		MATH_TARGET("avx2,fma") static inline void loadVec3x8(const F32* p, __m256& x, __m256& y, __m256& z)
+		{
+			const __m256i xIdx = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+			const __m256i yIdx = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+			const __m256i zIdx = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+
+			const __m256 f0 = _mm256_loadu_ps(p);
+			const __m256 f1 = _mm256_loadu_ps(p + 8);
+			const __m256 f2 = _mm256_loadu_ps(p + 16);
+
+			x = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, xIdx), _mm256_permutevar8x32_ps(f1, xIdx), 0x38);
+			x = _mm256_blend_ps(x, _mm256_permutevar8x32_ps(f2, xIdx), 0xC0);
+
+			y = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, yIdx), _mm256_permutevar8x32_ps(f1, yIdx), 0x18);
+			y = _mm256_blend_ps(y, _mm256_permutevar8x32_ps(f2, yIdx), 0xE0);
+
+			z = _mm256_blend_ps(_mm256_permutevar8x32_ps(f0, zIdx), _mm256_permutevar8x32_ps(f1, zIdx), 0x1C);
+			z = _mm256_blend_ps(z, _mm256_permutevar8x32_ps(f2, zIdx), 0xE0);
+		}
+
+		//Stores x, y and z of eight vectors as eight Vector3s. Lane j of output register k holds float 8k + j,
+		//which belongs to vector (8k + j) / 3, so all components use the same permutation and blends pick the component
+		MATH_TARGET("avx2,fma") static inline void storeVec3x8(F32* p, __m256 x, __m256 y, __m256 z)
+		{
+			const __m256i idx0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+			const __m256i idx1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+			const __m256i idx2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+			__m256 f0 = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, idx0), _mm256_permutevar8x32_ps(y, idx0), 0x92);
+			f0 = _mm256_blend_ps(f0, _mm256_permutevar8x32_ps(z, idx0), 0x24);
+
+			__m256 f1 = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, idx1), _mm256_permutevar8x32_ps(y, idx1), 0x24);
+			f1 = _mm256_blend_ps(f1, _mm256_permutevar8x32_ps(z, idx1), 0x49);
+
+			__m256 f2 = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, idx2), _mm256_permutevar8x32_ps(y, idx2), 0x49);
+			f2 = _mm256_blend_ps(f2, _mm256_permutevar8x32_ps(z, idx2), 0x92);
+
+			_mm256_storeu_ps(p, f0);
+			_mm256_storeu_ps(p + 8, f1);
+			_mm256_storeu_ps(p + 16, f2);
+		}
+
+		//Same as vec3TransformSSE2(), eight vectors per iteration
+		template<TransformMode mode>
+		MATH_TARGET("avx2,fma") static void vec3TransformAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			__m256 e[16];
+			for (U32 i = 0; i < (mode == TRANSFORM_PROJECTIVE ? 16u : 12u); ++i) e[i] = _mm256_set1_ps(m[i]);
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, pi += 24, po += 24) {
+				__m256 x, y, z;
+				loadVec3x8(pi, x, y, z);
+
+				__m256 rx = mode == TRANSFORM_DIRECTION ? _mm256_mul_ps(e[2], z) : _mm256_fmadd_ps(e[2], z, e[3]);
+				__m256 ry = mode == TRANSFORM_DIRECTION ? _mm256_mul_ps(e[6], z) : _mm256_fmadd_ps(e[6], z, e[7]);
+				__m256 rz = mode == TRANSFORM_DIRECTION ? _mm256_mul_ps(e[10], z) : _mm256_fmadd_ps(e[10], z, e[11]);
+				rx = _mm256_fmadd_ps(e[0], x, _mm256_fmadd_ps(e[1], y, rx));
+				ry = _mm256_fmadd_ps(e[4], x, _mm256_fmadd_ps(e[5], y, ry));
+				rz = _mm256_fmadd_ps(e[8], x, _mm256_fmadd_ps(e[9], y, rz));
+
+				if (mode == TRANSFORM_PROJECTIVE) {
+					const __m256 w = _mm256_fmadd_ps(e[12], x, _mm256_fmadd_ps(e[13], y, _mm256_fmadd_ps(e[14], z, e[15])));
+					const __m256 invW = _mm256_div_ps(_mm256_set1_ps(1.f), w);
+					rx = _mm256_mul_ps(rx, invW);
+					ry = _mm256_mul_ps(ry, invW);
+					rz = _mm256_mul_ps(rz, invW);
+				}
+
+				storeVec3x8(po, rx, ry, rz);
+			}
+
+			vec3TransformSSE2<mode>(m, in + i, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void vec3TransformPointAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformAVX2<TRANSFORM_POINT>(m, in, out, count);
+		}
+
+		MATH_TARGET("avx2,fma") void vec3TransformDirAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformAVX2<TRANSFORM_DIRECTION>(m, in, out, count);
+		}
+
+		MATH_TARGET("avx2,fma") void vec3TransformProjAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count)
+		{
+			vec3TransformAVX2<TRANSFORM_PROJECTIVE>(m, in, out, count);
+		}
+
+		//Returns 4 floats from lo in the low half and 4 floats from hi in the high half
+		MATH_TARGET("avx2,fma") static inline __m256 load2x4(const F32* lo, const F32* hi)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+		}
+
+		//Stores the low half of v to lo and the high half to hi
+		MATH_TARGET("avx2,fma") static inline void store2x4(F32* lo, F32* hi, __m256 v)
+		{
+			_mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+			_mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+		}
+
+		//Same as quatToMat4SSE2(), eight Quaternions per iteration. Quaternion k goes to the low half and k + 4 to the high half
+		//of a register, so that transposing the halves puts lanes in order
+		MATH_TARGET("avx2,fma") void quatToMat4AVX2(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count)
+		{
+			const F32* pq = reinterpret_cast<const F32*>(q);
+			const __m256 one = _mm256_set1_ps(1.f), two = _mm256_set1_ps(2.f);
+			const __m256 lastRow = _mm256_setr_ps(0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, pq += 32, out += 128) {
+				__m256 x = load2x4(pq, pq + 16), y = load2x4(pq + 4, pq + 20), z = load2x4(pq + 8, pq + 24), w = load2x4(pq + 12, pq + 28);
+				transpose2x4x4(x, y, z, w);
+
+				__m256 sx = one, sy = one, sz = one;
+				if (s) loadVec3x8(reinterpret_cast<const F32*>(s + i), sx, sy, sz);
+
+				__m256 tx = _mm256_setzero_ps(), ty = tx, tz = tx;
+				if (t) loadVec3x8(reinterpret_cast<const F32*>(t + i), tx, ty, tz);
+
+				const __m256 x2 = _mm256_mul_ps(two, x), y2 = _mm256_mul_ps(two, y), z2 = _mm256_mul_ps(two, z);
+				const __m256 xx = _mm256_mul_ps(x2, x), yy = _mm256_mul_ps(y2, y), zz = _mm256_mul_ps(z2, z);
+				const __m256 xy = _mm256_mul_ps(x2, y), xz = _mm256_mul_ps(x2, z), yz = _mm256_mul_ps(y2, z);
+				const __m256 xw = _mm256_mul_ps(x2, w), yw = _mm256_mul_ps(y2, w), zw = _mm256_mul_ps(z2, w);
+
+				__m256 rows[3][4] = {
+					{ _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_sub_ps(xy, zw), sy), _mm256_mul_ps(_mm256_add_ps(xz, yw), sz), tx },
+					{ _mm256_mul_ps(_mm256_add_ps(xy, zw), sx), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_sub_ps(yz, xw), sz), ty },
+					{ _mm256_mul_ps(_mm256_sub_ps(xz, yw), sx), _mm256_mul_ps(_mm256_add_ps(yz, xw), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), tz },
+				};
+
+				for (U32 r = 0; r < 3; ++r) transpose2x4x4(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+
+				//rows[r][k] now holds row r of matrix k in the low half and of matrix k + 4 in the high half.
+				//Pairs of rows are joined to 32-byte stores
+				for (U32 k = 0; k < 4; ++k) {
+					_mm256_storeu_ps(out + k * 16, _mm256_permute2f128_ps(rows[0][k], rows[1][k], 0x20));
+					_mm256_storeu_ps(out + k * 16 + 8, _mm256_permute2f128_ps(rows[2][k], lastRow, 0x20));
+					_mm256_storeu_ps(out + (k + 4) * 16, _mm256_permute2f128_ps(rows[0][k], rows[1][k], 0x31));
+					_mm256_storeu_ps(out + (k + 4) * 16 + 8, _mm256_permute2f128_ps(rows[2][k], lastRow, 0x31));
+				}
+			}
+
+			quatToMat4SSE2(q + i, t ? t + i : nullptr, s ? s + i : nullptr, out, count - i);
+		}
+
+		//Same as mat4ToQuatSSE2(), eight matrices per iteration, matrix k in the low half and k + 4 in the high half
+		MATH_TARGET("avx2,fma") void mat4ToQuatAVX2(const F32* m, Quaternion* out, U32 count)
+		{
+			F32* po = reinterpret_cast<F32*>(out);
+			const __m256 one = _mm256_set1_ps(1.f);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, m += 128, po += 32) {
+				__m256 e[3][4];
+				for (U32 r = 0; r < 3; ++r) {
+					for (U32 k = 0; k < 4; ++k) e[r][k] = load2x4(m + k * 16 + r * 4, m + (k + 4) * 16 + r * 4);
+					transpose2x4x4(e[r][0], e[r][1], e[r][2], e[r][3]);
+				}
+				const __m256 m00 = e[0][0], m01 = e[0][1], m02 = e[0][2];
+				const __m256 m10 = e[1][0], m11 = e[1][1], m12 = e[1][2];
+				const __m256 m20 = e[2][0], m21 = e[2][1], m22 = e[2][2];
+
+				const __m256 tw = _mm256_add_ps(_mm256_add_ps(one, m00), _mm256_add_ps(m11, m22));
+				const __m256 tx = _mm256_sub_ps(_mm256_add_ps(one, m00), _mm256_add_ps(m11, m22));
+				const __m256 ty = _mm256_sub_ps(_mm256_add_ps(one, m11), _mm256_add_ps(m00, m22));
+				const __m256 tz = _mm256_sub_ps(_mm256_add_ps(one, m22), _mm256_add_ps(m00, m11));
+
+				const __m256 caseW = _mm256_and_ps(_mm256_cmp_ps(tw, tx, _CMP_GE_OQ), _mm256_and_ps(_mm256_cmp_ps(tw, ty, _CMP_GE_OQ), _mm256_cmp_ps(tw, tz, _CMP_GE_OQ)));
+				const __m256 caseX = _mm256_andnot_ps(caseW, _mm256_and_ps(_mm256_cmp_ps(tx, ty, _CMP_GE_OQ), _mm256_cmp_ps(tx, tz, _CMP_GE_OQ)));
+				const __m256 caseY = _mm256_andnot_ps(_mm256_or_ps(caseW, caseX), _mm256_cmp_ps(ty, tz, _CMP_GE_OQ));
+
+				const __m256 d21 = _mm256_sub_ps(m21, m12), d02 = _mm256_sub_ps(m02, m20), d10 = _mm256_sub_ps(m10, m01);
+				const __m256 s10 = _mm256_add_ps(m10, m01), s02 = _mm256_add_ps(m02, m20), s21 = _mm256_add_ps(m21, m12);
+
+				//Case Z first, then the other cases blended over it
+				__m256 x = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(s02, s10, caseY), tx, caseX), d21, caseW);
+				__m256 y = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(s21, ty, caseY), s10, caseX), d02, caseW);
+				__m256 z = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(tz, s21, caseY), s02, caseX), d10, caseW);
+				__m256 w = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(d10, d02, caseY), d21, caseX), tw, caseW);
+
+				const __m256 inv = rsqrt256(_mm256_fmadd_ps(w, w, _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)))));
+				x = _mm256_mul_ps(x, inv);
+				y = _mm256_mul_ps(y, inv);
+				z = _mm256_mul_ps(z, inv);
+				w = _mm256_mul_ps(w, inv);
+
+				transpose2x4x4(x, y, z, w);
+				store2x4(po, po + 16, x);
+				store2x4(po + 4, po + 20, y);
+				store2x4(po + 8, po + 24, z);
+				store2x4(po + 12, po + 28, w);
+			}
+
+			mat4ToQuatSSE2(m, out + i, count - i);
+		}
+
+		//Same as skinSSE2(), but a blended matrix is two registers, columns 0 and 1 and columns 2 and 3, which halves the
+		//multiply-adds of the blend. The transform multiplies them by (x, x, x, x, y, y, y, y) and (z, z, z, z, 1, 1, 1, 1)
+		//and adds the halves
+		MATH_TARGET("avx2,fma") void skinAVX2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 rp[4], rn[4];
+				for (U32 j = 0; j < 4; ++j) {
+					const U16* bj = bones + (i + j) * influences;
+					const F32* wj = weights + (i + j) * influences;
+
+					const F32* b = palette + bj[0] * 16;
+					__m256 w = _mm256_set1_ps(wj[0]);
+					__m256 c01 = _mm256_mul_ps(w, _mm256_loadu_ps(b));
+					__m256 c23 = _mm256_mul_ps(w, _mm256_loadu_ps(b + 8));
+
+					for (U32 k = 1; k < influences; ++k) {
+						b = palette + bj[k] * 16;
+						w = _mm256_set1_ps(wj[k]);
+						c01 = _mm256_fmadd_ps(w, _mm256_loadu_ps(b), c01);
+						c23 = _mm256_fmadd_ps(w, _mm256_loadu_ps(b + 8), c23);
+					}
+
+					const Vector3& p = pos[i + j];
+					const __m256 pxy = _mm256_insertf128_ps(_mm256_set1_ps(p.x), _mm_set1_ps(p.y), 1);
+					const __m256 pz1 = _mm256_insertf128_ps(_mm256_set1_ps(p.z), _mm_set1_ps(1.f), 1);
+					const __m256 r = _mm256_fmadd_ps(c01, pxy, _mm256_mul_ps(c23, pz1));
+					rp[j] = _mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1));
+
+					if (nrm) {
+						const Vector3& n = nrm[i + j];
+						const __m256 nxy = _mm256_insertf128_ps(_mm256_set1_ps(n.x), _mm_set1_ps(n.y), 1);
+						const __m256 nz0 = _mm256_insertf128_ps(_mm256_set1_ps(n.z), _mm_setzero_ps(), 1);
+						const __m256 rnj = _mm256_fmadd_ps(c01, nxy, _mm256_mul_ps(c23, nz0));
+						rn[j] = _mm_add_ps(_mm256_castps256_ps128(rnj), _mm256_extractf128_ps(rnj, 1));
+					}
+				}
+
+				_MM_TRANSPOSE4_PS(rp[0], rp[1], rp[2], rp[3]);
+				storeVec3x4(reinterpret_cast<F32*>(outPos + i), rp[0], rp[1], rp[2]);
+
+				if (nrm) {
+					_MM_TRANSPOSE4_PS(rn[0], rn[1], rn[2], rn[3]);
+					const __m128 inv = rsqrt(_mm_fmadd_ps(rn[0], rn[0], _mm_fmadd_ps(rn[1], rn[1], _mm_mul_ps(rn[2], rn[2]))));
+					storeVec3x4(reinterpret_cast<F32*>(outNrm + i), _mm_mul_ps(rn[0], inv), _mm_mul_ps(rn[1], inv), _mm_mul_ps(rn[2], inv));
+				}
+			}
+
+			skinScalar(palette, pos + i, nrm ? nrm + i : nullptr, bones + i * influences, weights + i * influences, influences, outPos + i, outNrm ? outNrm + i : nullptr, count - i);
+		}
+
+		//Transposes 8 registers of 8 F32s, r[i][j] becomes r[j][i]
+		MATH_TARGET("avx2,fma") static inline void transpose8x8(__m256* r)
+		{
+			const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+			const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+			const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+			const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+			const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+			r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+			r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+			r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+			r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+			r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+			r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+			r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+			r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+		}
+
+		//Rotates (x, y, z) by the normalized real parts (rx, ry, rz, rw) as in DualQuaternion::transformDirection()
+		MATH_TARGET("avx2,fma") static inline void dualQuatRotateAVX2(__m256 rx, __m256 ry, __m256 rz, __m256 rw, __m256& x, __m256& y, __m256& z)
+		{
+			const __m256 ax = _mm256_fmadd_ps(rw, x, _mm256_fmsub_ps(ry, z, _mm256_mul_ps(rz, y)));
+			const __m256 ay = _mm256_fmadd_ps(rw, y, _mm256_fmsub_ps(rz, x, _mm256_mul_ps(rx, z)));
+			const __m256 az = _mm256_fmadd_ps(rw, z, _mm256_fmsub_ps(rx, y, _mm256_mul_ps(ry, x)));
+			const __m256 two = _mm256_set1_ps(2.f);
+
+			x = _mm256_fmadd_ps(two, _mm256_fmsub_ps(ry, az, _mm256_mul_ps(rz, ay)), x);
+			y = _mm256_fmadd_ps(two, _mm256_fmsub_ps(rz, ax, _mm256_mul_ps(rx, az)), y);
+			z = _mm256_fmadd_ps(two, _mm256_fmsub_ps(rx, ay, _mm256_mul_ps(ry, ax)), z);
+		}
+
+		//Same as skinDualQuatSSE2(), eight vertices per iteration, but a DualQuaternion fits one register. Each vertex blends
+		//its bones with one multiply-add per influence, the sign comes from a dot product of the real parts.
+		//The eight blends are then transposed once to registers of one component each
+		MATH_TARGET("avx2,fma") void skinDualQuatAVX2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count)
+		{
+			const __m128 signBit = _mm_set1_ps(-0.f);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 q[8];
+				for (U32 j = 0; j < 8; ++j) {
+					const U16* bj = bones + (i + j) * influences;
+					const F32* wj = weights + (i + j) * influences;
+
+					const __m256 b0 = _mm256_loadu_ps(palette + bj[0] * 8);
+					const __m128 r0 = _mm256_castps256_ps128(b0);
+					q[j] = _mm256_mul_ps(_mm256_set1_ps(wj[0]), b0);
+
+					for (U32 k = 1; k < influences; ++k) {
+						const __m256 b = _mm256_loadu_ps(palette + bj[k] * 8);
+						const __m128 sign = _mm_and_ps(_mm_dp_ps(_mm256_castps256_ps128(b), r0, 0xF1), signBit);
+						const __m256 w = _mm256_xor_ps(_mm256_set1_ps(wj[k]), _mm256_broadcastss_ps(sign));
+						q[j] = _mm256_fmadd_ps(w, b, q[j]);
+					}
+				}
+				transpose8x8(q);
+
+				const __m256 inv = rsqrt256(_mm256_fmadd_ps(q[0], q[0], _mm256_fmadd_ps(q[1], q[1], _mm256_fmadd_ps(q[2], q[2], _mm256_mul_ps(q[3], q[3])))));
+				for (U32 e = 0; e < 8; ++e) q[e] = _mm256_mul_ps(q[e], inv);
+
+				//Translation 2 * (rw * dv - dw * rv + rv x dv)
+				const __m256 two = _mm256_set1_ps(2.f);
+				const __m256 tx = _mm256_mul_ps(two, _mm256_fmadd_ps(q[3], q[4], _mm256_fnmadd_ps(q[7], q[0], _mm256_fmsub_ps(q[1], q[6], _mm256_mul_ps(q[2], q[5])))));
+				const __m256 ty = _mm256_mul_ps(two, _mm256_fmadd_ps(q[3], q[5], _mm256_fnmadd_ps(q[7], q[1], _mm256_fmsub_ps(q[2], q[4], _mm256_mul_ps(q[0], q[6])))));
+				const __m256 tz = _mm256_mul_ps(two, _mm256_fmadd_ps(q[3], q[6], _mm256_fnmadd_ps(q[7], q[2], _mm256_fmsub_ps(q[0], q[5], _mm256_mul_ps(q[1], q[4])))));
+
+				__m256 x, y, z;
+				loadVec3x8(reinterpret_cast<const F32*>(pos + i), x, y, z);
+				dualQuatRotateAVX2(q[0], q[1], q[2], q[3], x, y, z);
+				storeVec3x8(reinterpret_cast<F32*>(outPos + i), _mm256_add_ps(x, tx), _mm256_add_ps(y, ty), _mm256_add_ps(z, tz));
+
+				if (nrm) {
+					loadVec3x8(reinterpret_cast<const F32*>(nrm + i), x, y, z);
+					dualQuatRotateAVX2(q[0], q[1], q[2], q[3], x, y, z);
+					storeVec3x8(reinterpret_cast<F32*>(outNrm + i), x, y, z);
+				}
+			}
+
+			skinDualQuatSSE2(palette, pos + i, nrm ? nrm + i : nullptr, bones + i * influences, weights + i * influences, influences, outPos + i, outNrm ? outNrm + i : nullptr, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void fastSinCosAVX2(const F32* x, F32* s, F32* c, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 vs, vc;
+				fast::sincos(_mm256_loadu_ps(x + i), vs, vc);
+				_mm256_storeu_ps(s + i, vs);
+				_mm256_storeu_ps(c + i, vc);
+			}
+
+			fastSinCosSSE2(x + i, s + i, c + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void fastAcosAVX2(const F32* x, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(out + i, fast::acos(_mm256_loadu_ps(x + i)));
+			}
+
+			fastAcosSSE2(x + i, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void fastAtan2AVX2(const F32* y, const F32* x, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(out + i, fast::atan2(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+			}
+
+			fastAtan2SSE2(y + i, x + i, out + i, count - i);
+		}
+
+
+		//The SoA kernels process 8 elements per iteration, the rest on the SSE2 kernels
+
+		MATH_TARGET("avx2,fma") void soaAddAVX2(const F32* a, const F32* b, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+			}
+
+			soaAddSSE2(a + i, b + i, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void soaScaleAVX2(const F32* a, F32 s, F32* out, U32 count)
+		{
+			const __m256 vs = _mm256_set1_ps(s);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), vs));
+			}
+
+			soaScaleSSE2(a + i, s, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void soaLerpAVX2(const F32* a, const F32* b, F32 t, F32* out, U32 count)
+		{
+			const __m256 vt = _mm256_set1_ps(t);
+			const __m256 vt1 = _mm256_set1_ps(1 - t);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(out + i, _mm256_fmadd_ps(vt1, _mm256_loadu_ps(a + i), _mm256_mul_ps(vt, _mm256_loadu_ps(b + i))));
+			}
+
+			soaLerpSSE2(a + i, b + i, t, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void soaDot3AVX2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 d = _mm256_mul_ps(_mm256_loadu_ps(ax + i), _mm256_loadu_ps(bx + i));
+				d = _mm256_fmadd_ps(_mm256_loadu_ps(ay + i), _mm256_loadu_ps(by + i), d);
+				d = _mm256_fmadd_ps(_mm256_loadu_ps(az + i), _mm256_loadu_ps(bz + i), d);
+				_mm256_storeu_ps(out + i, d);
+			}
+
+			soaDot3SSE2(ax + i, ay + i, az + i, bx + i, by + i, bz + i, out + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void soaCross3AVX2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				const __m256 vax = _mm256_loadu_ps(ax + i), vay = _mm256_loadu_ps(ay + i), vaz = _mm256_loadu_ps(az + i);
+				const __m256 vbx = _mm256_loadu_ps(bx + i), vby = _mm256_loadu_ps(by + i), vbz = _mm256_loadu_ps(bz + i);
+
+				_mm256_storeu_ps(ox + i, _mm256_fmsub_ps(vay, vbz, _mm256_mul_ps(vaz, vby)));
+				_mm256_storeu_ps(oy + i, _mm256_fmsub_ps(vaz, vbx, _mm256_mul_ps(vax, vbz)));
+				_mm256_storeu_ps(oz + i, _mm256_fmsub_ps(vax, vby, _mm256_mul_ps(vay, vbx)));
+			}
+
+			soaCross3SSE2(ax + i, ay + i, az + i, bx + i, by + i, bz + i, ox + i, oy + i, oz + i, count - i);
+		}
+
+		MATH_TARGET("avx2,fma") void soaNormalize3AVX2(F32* x, F32* y, F32* z, U32 count)
+		{
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8) {
+				const __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+				const __m256 inv = rsqrt256(_mm256_fmadd_ps(vz, vz, _mm256_fmadd_ps(vy, vy, _mm256_mul_ps(vx, vx))));
+
+				_mm256_storeu_ps(x + i, _mm256_mul_ps(vx, inv));
+				_mm256_storeu_ps(y + i, _mm256_mul_ps(vy, inv));
+				_mm256_storeu_ps(z + i, _mm256_mul_ps(vz, inv));
+			}
+
+			soaNormalize3SSE2(x + i, y + i, z + i, count - i);
+		}
+
+		//Lanes of the registers in the AVX2 bounds kernels: the low halves hold objects 0, 1, 4 and 5, the high halves objects 2, 3, 6 and 7,
+		//the order _mm256_shuffle_ps() gives in loadAABBx8(). Object boundsLane[j] goes to the low half of register j before transposing,
+		//and object boundsLane[j] + 2 to its high half
+		static const U32 boundsLane[4] = { 0, 1, 4, 5 };
+
+		//Same as loadAABBx4(), eight boxes in the lane order of boundsLane
+		MATH_TARGET("avx2,fma") static inline void loadAABBx8(const F32* p, __m256* mn, __m256* mx)
+		{
+			__m256 a[3], b[3];
+			loadVec3x8(p, a[0], a[1], a[2]);
+			loadVec3x8(p + 24, b[0], b[1], b[2]);
+
+			for (U32 k = 0; k < 3; ++k) {
+				mn[k] = _mm256_shuffle_ps(a[k], b[k], _MM_SHUFFLE(2, 0, 2, 0));
+				mx[k] = _mm256_shuffle_ps(a[k], b[k], _MM_SHUFFLE(3, 1, 3, 1));
+			}
+		}
+
+		//Same as storeAABBx4(), eight boxes in the lane order of boundsLane
+		MATH_TARGET("avx2,fma") static inline void storeAABBx8(F32* p, const __m256* mn, const __m256* mx)
+		{
+			storeVec3x8(p, _mm256_unpacklo_ps(mn[0], mx[0]), _mm256_unpacklo_ps(mn[1], mx[1]), _mm256_unpacklo_ps(mn[2], mx[2]));
+			storeVec3x8(p + 24, _mm256_unpackhi_ps(mn[0], mx[0]), _mm256_unpackhi_ps(mn[1], mx[1]), _mm256_unpackhi_ps(mn[2], mx[2]));
+		}
+
+		//Same as loadAffinex4(), eight matrices in the lane order of boundsLane
+		MATH_TARGET("avx2,fma") static inline void loadAffinex8(const F32* m, size_t stride, __m256* e)
+		{
+			for (U32 r = 0; r < 12; r += 4) {
+				__m256 q[4];
+				for (U32 j = 0; j < 4; ++j) q[j] = load2x4(m + boundsLane[j] * stride + r, m + (boundsLane[j] + 2) * stride + r);
+				transpose2x4x4(q[0], q[1], q[2], q[3]);
+
+				e[r] = q[0]; e[r + 1] = q[1]; e[r + 2] = q[2]; e[r + 3] = q[3];
+			}
+		}
+
+		MATH_TARGET("avx2,fma") void aabbTransformAVX2(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count)
+		{
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+			__m256 e[12];
+			if (mStride == 0) {
+				for (U32 k = 0; k < 12; ++k) e[k] = _mm256_set1_ps(m[k]);
+			}
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, pi += 48, po += 48) {
+				if (mStride != 0) loadAffinex8(m + size_t(i) * mStride, mStride, e);
+
+				__m256 mn[3], mx[3];
+				loadAABBx8(pi, mn, mx);
+
+				__m256 c[3], x[3];
+				for (U32 k = 0; k < 3; ++k) {
+					c[k] = _mm256_mul_ps(_mm256_add_ps(mn[k], mx[k]), half);
+					x[k] = _mm256_mul_ps(_mm256_sub_ps(mx[k], mn[k]), half);
+				}
+
+				for (U32 r = 0; r < 3; ++r) {
+					const __m256* row = e + r * 4;
+					const __m256 cr = _mm256_fmadd_ps(row[0], c[0], _mm256_fmadd_ps(row[1], c[1], _mm256_fmadd_ps(row[2], c[2], row[3])));
+					const __m256 xr = _mm256_fmadd_ps(_mm256_and_ps(row[0], absMask), x[0],
+						_mm256_fmadd_ps(_mm256_and_ps(row[1], absMask), x[1], _mm256_mul_ps(_mm256_and_ps(row[2], absMask), x[2])));
+
+					mn[r] = _mm256_sub_ps(cr, xr);
+					mx[r] = _mm256_add_ps(cr, xr);
+				}
+
+				storeAABBx8(po, mn, mx);
+			}
+
+			aabbTransformSSE2(m + size_t(i) * mStride, mStride, in + i, out + i, count - i);
+		}
+
+		//Same as aabbMergeSSE2(), four boxes in three registers per iteration
+		MATH_TARGET("avx2,fma") void aabbMergeAVX2(const AABB* in, U32 count, AABB* out)
+		{
+			alignas(32) F32 f[24];
+			for (U32 k = 0; k < 24; ++k) f[k] = k % 6 < 3 ? 0.f : -0.f;
+			const __m256 flip[3] = { _mm256_load_ps(f), _mm256_load_ps(f + 8), _mm256_load_ps(f + 16) };
+
+			const __m256 inf = _mm256_set1_ps(std::numeric_limits<F32>::infinity());
+			__m256 acc[3] = { inf, inf, inf };
+
+			const F32* p = reinterpret_cast<const F32*>(in);
+
+			U32 i = 0;
+			for (; i + 4 <= count; i += 4, p += 24) {
+				for (U32 k = 0; k < 3; ++k) acc[k] = _mm256_min_ps(acc[k], _mm256_xor_ps(_mm256_loadu_ps(p + k * 8), flip[k]));
+			}
+
+			for (U32 k = 0; k < 3; ++k) _mm256_store_ps(f + k * 8, _mm256_xor_ps(acc[k], flip[k]));
+			const AABB* partial = reinterpret_cast<const AABB*>(f);
+
+			AABB res;
+			aabbMergeSSE2(in + i, count - i, &res);
+			for (U32 k = 0; k < 4; ++k) res.merge(partial[k]);
+			*out = res;
+		}
+
+		//Same as maxScalex4(), eight matrices
+		MATH_TARGET("avx2,fma") static inline __m256 maxScalex8(const __m256* e)
+		{
+			const __m256 sx = _mm256_fmadd_ps(e[8], e[8], _mm256_fmadd_ps(e[4], e[4], _mm256_mul_ps(e[0], e[0])));
+			const __m256 sy = _mm256_fmadd_ps(e[9], e[9], _mm256_fmadd_ps(e[5], e[5], _mm256_mul_ps(e[1], e[1])));
+			const __m256 sz = _mm256_fmadd_ps(e[10], e[10], _mm256_fmadd_ps(e[6], e[6], _mm256_mul_ps(e[2], e[2])));
+
+			return _mm256_sqrt_ps(_mm256_max_ps(sx, _mm256_max_ps(sy, sz)));
+		}
+
+		//Same as sphereTransformSSE2(), eight spheres per iteration in the lane order of boundsLane
+		MATH_TARGET("avx2,fma") void sphereTransformAVX2(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count)
+		{
+			__m256 e[12], scale = _mm256_setzero_ps();
+			if (mStride == 0) {
+				for (U32 k = 0; k < 12; ++k) e[k] = _mm256_set1_ps(m[k]);
+				scale = maxScalex8(e);
+			}
+
+			const F32* pi = reinterpret_cast<const F32*>(in);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			U32 i = 0;
+			for (; i + 8 <= count; i += 8, pi += 32, po += 32) {
+				if (mStride != 0) {
+					loadAffinex8(m + size_t(i) * mStride, mStride, e);
+					scale = maxScalex8(e);
+				}
+
+				__m256 q[4];
+				for (U32 j = 0; j < 4; ++j) q[j] = load2x4(pi + boundsLane[j] * 4, pi + (boundsLane[j] + 2) * 4);
+				transpose2x4x4(q[0], q[1], q[2], q[3]);
+
+				__m256 cx = _mm256_fmadd_ps(e[0], q[0], _mm256_fmadd_ps(e[1], q[1], _mm256_fmadd_ps(e[2], q[2], e[3])));
+				__m256 cy = _mm256_fmadd_ps(e[4], q[0], _mm256_fmadd_ps(e[5], q[1], _mm256_fmadd_ps(e[6], q[2], e[7])));
+				__m256 cz = _mm256_fmadd_ps(e[8], q[0], _mm256_fmadd_ps(e[9], q[1], _mm256_fmadd_ps(e[10], q[2], e[11])));
+				__m256 r = _mm256_mul_ps(q[3], scale);
+				transpose2x4x4(cx, cy, cz, r);
+
+				store2x4(po + boundsLane[0] * 4, po + (boundsLane[0] + 2) * 4, cx);
+				store2x4(po + boundsLane[1] * 4, po + (boundsLane[1] + 2) * 4, cy);
+				store2x4(po + boundsLane[2] * 4, po + (boundsLane[2] + 2) * 4, cz);
+				store2x4(po + boundsLane[3] * 4, po + (boundsLane[3] + 2) * 4, r);
+			}
+
+			sphereTransformSSE2(m + size_t(i) * mStride, mStride, in + i, out + i, count - i);
+		}
+
+		//For each 8-bit mask, the indices of its set bits packed 3 bits each from the lowest bits, and the amount of set bits in bits 24 to 27
+		static const U32* visibleLanes()
+		{
+			struct Table {
+				U32 e[256];
+
+				Table() {
+					for (U32 m = 0; m < 256; ++m) {
+						U32 n = 0;
+						e[m] = 0;
+						for (U32 k = 0; k < 8; ++k) {
+							if ((m >> k) & 1) e[m] |= k << (3 * n++);
+						}
+						e[m] |= n << 24;
+					}
+				}
+			};
+
+			static const Table table;
+			return table.e;
+		}
+
+		//appendVisible() for eight lanes with one store. lanes is from visibleLanes()
+		MATH_TARGET("avx2,fma") static inline U32 appendVisible8(U32* visible, U32 n, U32 first, U32 mask, const U32* lanes)
+		{
+			const U32 e = lanes[mask];
+			const __m256i k = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(int(e)), _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21)), _mm256_set1_epi32(7));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + n), _mm256_add_epi32(k, _mm256_set1_epi32(int(first))));
+			return n + (e >> 24);
+		}
+
+		//Same as cullSpheresSSE2(), eight spheres per iteration
+		MATH_TARGET("avx2,fma") U32 cullSpheresAVX2(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible)
+		{
+			const U32* lanes = visibleLanes();
+			__m256 pl[24];
+			for (U32 k = 0; k < 24; ++k) pl[k] = _mm256_set1_ps(planes[k]);
+
+			U32 n = 0, i = 0;
+			for (; i + 8 <= count; i += 8) {
+				const __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+				const __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+
+				U32 mask = 0xFF;
+				for (U32 p = 0; p < 24 && mask != 0; p += 8) {
+					const __m256 d0 = _mm256_fmadd_ps(pl[p + 2], vz, _mm256_fmadd_ps(pl[p + 1], vy, _mm256_fmadd_ps(pl[p], vx, pl[p + 3])));
+					const __m256 d1 = _mm256_fmadd_ps(pl[p + 6], vz, _mm256_fmadd_ps(pl[p + 5], vy, _mm256_fmadd_ps(pl[p + 4], vx, pl[p + 7])));
+					mask &= U32(_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(d0, negR, _CMP_GE_OQ), _mm256_cmp_ps(d1, negR, _CMP_GE_OQ))));
+				}
+
+				if (mask != 0) n = appendVisible8(visible, n, i, mask, lanes);
+			}
+
+			const U32 tail = cullSpheresSSE2(planes, x + i, y + i, z + i, r + i, count - i, visible + n);
+			for (U32 k = 0; k < tail; ++k) visible[n + k] += i;
+			return n + tail;
+		}
+
+		//Same as cullAABBsSSE2(), eight boxes per iteration
+		MATH_TARGET("avx2,fma") U32 cullAABBsAVX2(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible)
+		{
+			const U32* lanes = visibleLanes();
+			__m256 pn[18], pa[18], pd[6];
+			for (U32 p = 0; p < 6; ++p) {
+				for (U32 k = 0; k < 3; ++k) {
+					pn[p * 3 + k] = _mm256_set1_ps(planes[p * 4 + k]);
+					pa[p * 3 + k] = _mm256_set1_ps(fabsf(planes[p * 4 + k]));
+				}
+				pd[p] = _mm256_set1_ps(-2.f * planes[p * 4 + 3]);
+			}
+
+			U32 n = 0, i = 0;
+			for (; i + 8 <= count; i += 8) {
+				const __m256 mnx = _mm256_loadu_ps(minX + i), mny = _mm256_loadu_ps(minY + i), mnz = _mm256_loadu_ps(minZ + i);
+				const __m256 mxx = _mm256_loadu_ps(maxX + i), mxy = _mm256_loadu_ps(maxY + i), mxz = _mm256_loadu_ps(maxZ + i);
+				const __m256 sx = _mm256_add_ps(mnx, mxx), sy = _mm256_add_ps(mny, mxy), sz = _mm256_add_ps(mnz, mxz);
+				const __m256 ex = _mm256_sub_ps(mxx, mnx), ey = _mm256_sub_ps(mxy, mny), ez = _mm256_sub_ps(mxz, mnz);
+
+				U32 mask = 0xFF;
+				for (U32 p = 0; p < 6 && mask != 0; p += 2) {
+					__m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for (U32 q = p; q < p + 2; ++q) {
+						const __m256* vn = pn + q * 3;
+						const __m256* va = pa + q * 3;
+						__m256 d = _mm256_mul_ps(va[2], ez);
+						d = _mm256_fmadd_ps(va[1], ey, d);
+						d = _mm256_fmadd_ps(va[0], ex, d);
+						d = _mm256_fmadd_ps(vn[2], sz, d);
+						d = _mm256_fmadd_ps(vn[1], sy, d);
+						d = _mm256_fmadd_ps(vn[0], sx, d);
+						in = _mm256_and_ps(in, _mm256_cmp_ps(d, pd[q], _CMP_GE_OQ));
+					}
+					mask &= U32(_mm256_movemask_ps(in));
+				}
+
+				if (mask != 0) n = appendVisible8(visible, n, i, mask, lanes);
+			}
+
+			const U32 tail = cullAABBsSSE2(planes, minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i, count - i, visible + n);
+			for (U32 k = 0; k < tail; ++k) visible[n + k] += i;
+			return n + tail;
+		}
+
+		//AVX-512F
+
+		//GCC warns about the undefined source register that avx512fintrin.h passes to broadcast and permute, a false positive
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+		//The whole matrix in one register, row r of b broadcast to all four rows
+		MATH_TARGET("avx512f") void mat4MulAVX512(const F32* a, const F32* b, F32* out)
+		{
+			const __m512 b0 = _mm512_broadcast_f32x4(_mm_loadu_ps(b));
+			const __m512 b1 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 4));
+			const __m512 b2 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 8));
+			const __m512 b3 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 12));
+
+			const __m512 rows = _mm512_loadu_ps(a);
+
+			__m512 r = _mm512_mul_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+			r = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1, r);
+			r = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2, r);
+			r = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3, r);
+
+			_mm512_storeu_ps(out, r);
+		}
+
+		MATH_TARGET("avx512f") void mat4MulIndexedAVX512(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count)
+		{
+			for (U32 i = 0; i < count; ++i) {
+				mat4MulAVX512(a + aIdx[i] * 16, b + i * 16, out + i * 16);
+			}
+		}
+
+		//Four Quaternions per register, the last partial register is masked
+		MATH_TARGET("avx512f") void quatMulAVX512(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count)
+		{
+			//AVX-512F has no float xor, signs are flipped as integers
+			const __m512i sign1 = _mm512_castps_si512(_mm512_broadcast_f32x4(_mm_setr_ps(0.f, 0.f, -0.f, -0.f)));
+			const __m512i sign2 = _mm512_castps_si512(_mm512_broadcast_f32x4(_mm_setr_ps(-0.f, 0.f, 0.f, -0.f)));
+			const __m512i sign3 = _mm512_castps_si512(_mm512_broadcast_f32x4(_mm_setr_ps(0.f, -0.f, 0.f, -0.f)));
+
+			const F32* pa = reinterpret_cast<const F32*>(a);
+			const F32* pb = reinterpret_cast<const F32*>(b);
+			F32* po = reinterpret_cast<F32*>(out);
+
+			for (U32 i = 0; i < count; i += 4) {
+				const U32 left = count - i < 4 ? count - i : 4;
+				const __mmask16 mask = __mmask16((1u << (left * 4)) - 1u);
+
+				const __m512 qa = _mm512_maskz_loadu_ps(mask, pa + i * 4);
+				const __m512 qb = _mm512_maskz_loadu_ps(mask, pb + i * 4);
+
+				const __m512 t1 = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_permute_ps(qa, _MM_SHUFFLE(0, 1, 2, 3))), sign1));
+				const __m512 t2 = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_permute_ps(qa, _MM_SHUFFLE(1, 0, 3, 2))), sign2));
+				const __m512 t3 = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_permute_ps(qa, _MM_SHUFFLE(2, 3, 0, 1))), sign3));
+
+				__m512 r = _mm512_mul_ps(_mm512_permute_ps(qb, _MM_SHUFFLE(3, 3, 3, 3)), qa);
+				r = _mm512_fmadd_ps(_mm512_permute_ps(qb, _MM_SHUFFLE(0, 0, 0, 0)), t1, r);
+				r = _mm512_fmadd_ps(_mm512_permute_ps(qb, _MM_SHUFFLE(1, 1, 1, 1)), t2, r);
+				r = _mm512_fmadd_ps(_mm512_permute_ps(qb, _MM_SHUFFLE(2, 2, 2, 2)), t3, r);
+
+				_mm512_mask_storeu_ps(po + i * 4, mask, r);
+			}
+		}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "MathSIMD.h"
+#include "DataTypedefs.h"
+
+class Quaternion;
+class Vector3;
+class AABB;
+class BoundingSphere;
+
+//Implementations of the kernels in Math::dispatch::Kernels, one set per instruction set.
+//Use them through Math::dispatch::kernels(), calling a kernel the CPU does not support crashes.
+
+namespace Math {
+	namespace kernels {
+
+		//Plain C++, works everywhere
+
+		void mat4MulScalar(const F32* a, const F32* b, F32* out);
+		void mat4MulIndexedScalar(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count);
+		bool mat4InverseScalar(const F32* m, F32* out);
+
+		//Multiplies 3x3 matrices of 9 row-major F32s. out may be a or b. Used by the expressions of MathExpression.h, not dispatched
+		void mat3MulScalar(const F32* a, const F32* b, F32* out);
+
+		//Inverts the affine matrix of 12 row-major F32s (top 3 rows of a Matrix4) to out. Returns false if m is singular.
+		//out may not be m. Used by both Matrix4::inverseAffine() and Affine3x4::inverse(), not dispatched
+		bool affineInverse(const F32* m, F32* out);
+
+		void quatMulScalar(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count);
+		void vec3NormalizeScalar(Vector3* v, U32 count);
+		void quatNormalizeScalar(Quaternion* q, U32 count);
+		void quatNlerpScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpApproxScalar(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void vec3TransformPointScalar(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformDirScalar(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformProjScalar(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void quatToMat4Scalar(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count);
+		void mat4ToQuatScalar(const F32* m, Quaternion* out, U32 count);
+		void skinScalar(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void skinDualQuatScalar(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void fastSinCosScalar(const F32* x, F32* s, F32* c, U32 count);
+		void fastAcosScalar(const F32* x, F32* out, U32 count);
+		void fastAtan2Scalar(const F32* y, const F32* x, F32* out, U32 count);
+		void soaAddScalar(const F32* a, const F32* b, F32* out, U32 count);
+		void soaScaleScalar(const F32* a, F32 s, F32* out, U32 count);
+		void soaLerpScalar(const F32* a, const F32* b, F32 t, F32* out, U32 count);
+		void soaDot3Scalar(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count);
+		void soaCross3Scalar(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count);
+		void soaNormalize3Scalar(F32* x, F32* y, F32* z, U32 count);
+		void aabbTransformScalar(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count);
+		void aabbMergeScalar(const AABB* in, U32 count, AABB* out);
+		void sphereTransformScalar(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count);
+		U32 cullSpheresScalar(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible);
+		U32 cullAABBsScalar(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible);
+
+#ifdef MATH_SSE2
+		//SSE2, the baseline of x64
+
+		void mat4MulSSE2(const F32* a, const F32* b, F32* out);
+		void mat4MulIndexedSSE2(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count);
+		bool mat4InverseSSE2(const F32* m, F32* out);
+		void quatMulSSE2(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count);
+		void vec3NormalizeSSE2(Vector3* v, U32 count);
+		void quatNormalizeSSE2(Quaternion* q, U32 count);
+		void quatNlerpSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpApproxSSE2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void vec3TransformPointSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformDirSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformProjSSE2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void quatToMat4SSE2(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count);
+		void mat4ToQuatSSE2(const F32* m, Quaternion* out, U32 count);
+		void skinSSE2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void skinDualQuatSSE2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void fastSinCosSSE2(const F32* x, F32* s, F32* c, U32 count);
+		void fastAcosSSE2(const F32* x, F32* out, U32 count);
+		void fastAtan2SSE2(const F32* y, const F32* x, F32* out, U32 count);
+		void soaAddSSE2(const F32* a, const F32* b, F32* out, U32 count);
+		void soaScaleSSE2(const F32* a, F32 s, F32* out, U32 count);
+		void soaLerpSSE2(const F32* a, const F32* b, F32 t, F32* out, U32 count);
+		void soaDot3SSE2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count);
+		void soaCross3SSE2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count);
+		void soaNormalize3SSE2(F32* x, F32* y, F32* z, U32 count);
+		void aabbTransformSSE2(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count);
+		void aabbMergeSSE2(const AABB* in, U32 count, AABB* out);
+		void sphereTransformSSE2(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count);
+		U32 cullSpheresSSE2(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible);
+		U32 cullAABBsSSE2(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible);
+
+		//AVX2 and FMA
+
+		void mat4MulAVX2(const F32* a, const F32* b, F32* out);
+		void mat4MulIndexedAVX2(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count);
+		void quatMulAVX2(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count);
+		void vec3NormalizeAVX2(Vector3* v, U32 count);
+		void quatNormalizeAVX2(Quaternion* q, U32 count);
+		void quatNlerpAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void quatSlerpApproxAVX2(const Quaternion* a, const Quaternion* b, const F32* t, Quaternion* out, U32 count);
+		void vec3TransformPointAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformDirAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void vec3TransformProjAVX2(const F32* m, const Vector3* in, Vector3* out, U32 count);
+		void quatToMat4AVX2(const Quaternion* q, const Vector3* t, const Vector3* s, F32* out, U32 count);
+		void mat4ToQuatAVX2(const F32* m, Quaternion* out, U32 count);
+		void skinAVX2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void skinDualQuatAVX2(const F32* palette, const Vector3* pos, const Vector3* nrm, const U16* bones, const F32* weights, U32 influences, Vector3* outPos, Vector3* outNrm, U32 count);
+		void fastSinCosAVX2(const F32* x, F32* s, F32* c, U32 count);
+		void fastAcosAVX2(const F32* x, F32* out, U32 count);
+		void fastAtan2AVX2(const F32* y, const F32* x, F32* out, U32 count);
+		void soaAddAVX2(const F32* a, const F32* b, F32* out, U32 count);
+		void soaScaleAVX2(const F32* a, F32 s, F32* out, U32 count);
+		void soaLerpAVX2(const F32* a, const F32* b, F32 t, F32* out, U32 count);
+		void soaDot3AVX2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* out, U32 count);
+		void soaCross3AVX2(const F32* ax, const F32* ay, const F32* az, const F32* bx, const F32* by, const F32* bz, F32* ox, F32* oy, F32* oz, U32 count);
+		void soaNormalize3AVX2(F32* x, F32* y, F32* z, U32 count);
+		void aabbTransformAVX2(const F32* m, U32 mStride, const AABB* in, AABB* out, U32 count);
+		void aabbMergeAVX2(const AABB* in, U32 count, AABB* out);
+		void sphereTransformAVX2(const F32* m, U32 mStride, const BoundingSphere* in, BoundingSphere* out, U32 count);
+		U32 cullSpheresAVX2(const F32* planes, const F32* x, const F32* y, const F32* z, const F32* r, U32 count, U32* visible);
+		U32 cullAABBsAVX2(const F32* planes, const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, U32 count, U32* visible);
+
+		//AVX-512F
+
+		void mat4MulAVX512(const F32* a, const F32* b, F32* out);
+		void mat4MulIndexedAVX512(const F32* a, const U32* aIdx, const F32* b, F32* out, U32 count);
+		void quatMulAVX512(const Quaternion* a, const Quaternion* b, Quaternion* out, U32 count);
+#endif
+
+	}
+}
@@ -1,10 +1,589 @@
-
 #include "MathMemoryManager.h"
 
 #ifdef MATH_CUSTOM_MEMORY
 
-boost::pool<>* MathMemoryManager::pool4 = nullptr;
-boost::pool<>* MathMemoryManager::pool3 = nullptr;
+#if defined(MATH_THREAD_LOCAL_POOLS) || defined(MATH_MEMORY_STATS)
+#include <atomic>
+#include <mutex>
+#endif
+
+#ifdef MATH_MEMORY_STATS
+#include <algorithm>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#endif
+#endif
+
+
+//Every block starts with a header that tells where it came from: thread pools, the global pools or an arena.
+//Header is 16 bytes, so the elements keep the 16-byte alignment of the block.
+struct BlockHeader {
+	void* owner;
+	BlockHeader* next;
+};
+
+static const size_t headerSize = 16;
+static_assert(sizeof(BlockHeader) <= headerSize, "BlockHeader doesn't fit in the block header");
+
+static const size_t mat4BlockSize = headerSize + sizeof(F32) * 16;
+static const size_t mat3BlockSize = headerSize + ((sizeof(F32) * 9 + 15) & ~size_t(15));
+
+//Owner of all blocks allocated from arenas
+static U8 arenaOwner;
+
+//Arena of the innermost MathArenaScope on this thread
+static thread_local MathArena* currentArena = nullptr;
+
+
+static BlockHeader* headerOf(F32* p)
+{
+	return (BlockHeader*)((U8*)p - headerSize);
+}
+
+static F32* elementsOf(BlockHeader* block, void* owner)
+{
+	block->owner = owner;
+	return (F32*)((U8*)block + headerSize);
+}
+
+
+#ifdef MATH_MEMORY_STATS
+
+enum BlockKind { MAT4, MAT3 };
+
+struct BlockCounters {
+	std::atomic<U64> live, peak, allocs, frees;
+};
+
+static BlockCounters counters[2];
+static std::atomic<U64> arenaAllocs(0);
+static std::atomic<U64> poolGrowths(0);
+static std::atomic<U64> bytesReserved(0);
+
+static std::atomic<U32> sampleInterval(0);
+static thread_local U32 sampleCounter = 0;
+
+static const U32 maxSites = 256;
+static MathAllocationSite sites[maxSites];
+static U32 siteCount = 0;
+static std::mutex siteMutex;
+
+
+//Size of the prefix MathPoolAllocator keeps in front of the memory it gives to the pools
+static const size_t reservedHeaderSize = 16;
+
+char* MathPoolAllocator::malloc(const size_type bytes)
+{
+	char* block = new (std::nothrow) char[reservedHeaderSize + bytes];
+	if (!block) return nullptr;
+
+	*(size_type*)block = bytes;
+	poolGrowths.fetch_add(1, std::memory_order_relaxed);
+	bytesReserved.fetch_add(bytes, std::memory_order_relaxed);
+	return block + reservedHeaderSize;
+}
+
+void MathPoolAllocator::free(char* const block)
+{
+	char* p = block - reservedHeaderSize;
+	bytesReserved.fetch_sub(*(size_type*)p, std::memory_order_relaxed);
+	delete[] p;
+}
+
+
+//Captures the call stack of the calling allocation and adds it to the sites
+#if defined(_MSC_VER)
+__declspec(noinline)
+#elif defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void sampleSite()
+{
+	MathAllocationSite site;
+	site.samples = 1;
+
+#ifdef _WIN32
+	site.frameCount = CaptureStackBackTrace(1, MathAllocationSite::MAX_FRAMES, site.frames, nullptr);
+#elif defined(__GLIBC__) || defined(__APPLE__)
+	void* frames[MathAllocationSite::MAX_FRAMES + 1];
+	int n = backtrace(frames, MathAllocationSite::MAX_FRAMES + 1);
+	site.frameCount = n > 1 ? U32(n - 1) : 0;
+	std::copy(frames + 1, frames + 1 + site.frameCount, site.frames);
+#else
+	site.frameCount = 0;
+#endif
+
+	std::lock_guard<std::mutex> lock(siteMutex);
+
+	for (U32 i = 0; i < siteCount; ++i) {
+		if (sites[i].frameCount == site.frameCount && std::equal(site.frames, site.frames + site.frameCount, sites[i].frames)) {
+			++sites[i].samples;
+			return;
+		}
+	}
+
+	//Table full, new call stacks are dropped
+	if (siteCount < maxSites) sites[siteCount++] = site;
+}
+
+static void countAlloc(BlockKind kind)
+{
+	BlockCounters& c = counters[kind];
+	c.allocs.fetch_add(1, std::memory_order_relaxed);
+
+	const U64 live = c.live.fetch_add(1, std::memory_order_relaxed) + 1;
+	U64 peak = c.peak.load(std::memory_order_relaxed);
+	while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+	const U32 interval = sampleInterval.load(std::memory_order_relaxed);
+	if (interval != 0 && ++sampleCounter >= interval) {
+		sampleCounter = 0;
+		sampleSite();
+	}
+}
+
+static void countFree(BlockKind kind)
+{
+	BlockCounters& c = counters[kind];
+	c.frees.fetch_add(1, std::memory_order_relaxed);
+	c.live.fetch_sub(1, std::memory_order_relaxed);
+}
+
+MathMemoryStats MathMemoryManager::stats()
+{
+	MathMemoryStats s;
+	s.liveMat4 = counters[MAT4].live.load(std::memory_order_relaxed);
+	s.liveMat3 = counters[MAT3].live.load(std::memory_order_relaxed);
+	s.peakMat4 = counters[MAT4].peak.load(std::memory_order_relaxed);
+	s.peakMat3 = counters[MAT3].peak.load(std::memory_order_relaxed);
+	s.allocsMat4 = counters[MAT4].allocs.load(std::memory_order_relaxed);
+	s.freesMat4 = counters[MAT4].frees.load(std::memory_order_relaxed);
+	s.allocsMat3 = counters[MAT3].allocs.load(std::memory_order_relaxed);
+	s.freesMat3 = counters[MAT3].frees.load(std::memory_order_relaxed);
+	s.arenaAllocs = arenaAllocs.load(std::memory_order_relaxed);
+	s.poolGrowths = poolGrowths.load(std::memory_order_relaxed);
+	s.bytesReserved = bytesReserved.load(std::memory_order_relaxed);
+	return s;
+}
+
+void MathMemoryManager::resetStats()
+{
+	for (BlockCounters& c : counters) {
+		c.peak.store(c.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		c.allocs.store(0, std::memory_order_relaxed);
+		c.frees.store(0, std::memory_order_relaxed);
+	}
+	arenaAllocs.store(0, std::memory_order_relaxed);
+	poolGrowths.store(0, std::memory_order_relaxed);
+}
+
+void MathMemoryManager::setSampleInterval(U32 interval)
+{
+	sampleInterval.store(interval, std::memory_order_relaxed);
+}
+
+U32 MathMemoryManager::sampledSites(MathAllocationSite* out, U32 maxOut)
+{
+	std::lock_guard<std::mutex> lock(siteMutex);
+
+	std::sort(sites, sites + siteCount, [](const MathAllocationSite& a, const MathAllocationSite& b) { return a.samples > b.samples; });
+
+	const U32 n = std::min(siteCount, maxOut);
+	std::copy(sites, sites + n, out);
+	return n;
+}
+
+void MathMemoryManager::clearSampledSites()
+{
+	std::lock_guard<std::mutex> lock(siteMutex);
+	siteCount = 0;
+}
+
+#else
+
+enum BlockKind { MAT4, MAT3 };
+
+static void countAlloc(BlockKind) {}
+static void countFree(BlockKind) {}
+
+#endif
+
+
+static F32* arenaBlock(size_t blockSize)
+{
+#ifdef MATH_MEMORY_STATS
+	arenaAllocs.fetch_add(1, std::memory_order_relaxed);
+#endif
+	return elementsOf((BlockHeader*)currentArena->allocate(blockSize), &arenaOwner);
+}
+
+
+//Makes the pool allocate space for initial blocks right away, and increase blocks on the first growth
+static void reservePool(MathPool& pool, U32 initial, U32 increase)
+{
+	if (initial != 0) {
+		pool.set_next_size(initial);
+		pool.free(pool.malloc());
+	}
+
+	pool.set_next_size(increase != 0 ? increase : 32);
+}
+
+
+#ifdef MATH_THREAD_LOCAL_POOLS
+
+//Pools owned by one thread. Only the owner touches pool4 and pool3, other threads only push to the remote lists.
+struct MathMemoryManager::ThreadPools {
+
+	ThreadPools() : pool4(mat4BlockSize), pool3(mat3BlockSize), remote4(nullptr), remote3(nullptr), abandoned(false), next(nullptr)
+	{
+		reservePool(pool4, mat4Init, mat4Inc);
+		reservePool(pool3, mat3Init, mat3Inc);
+	}
+
+	MathPool pool4;
+	MathPool pool3;
+
+	//Blocks freed by other threads
+	std::atomic<BlockHeader*> remote4;
+	std::atomic<BlockHeader*> remote3;
+
+	//True when the owning thread has exited and the pools wait for a new owner
+	std::atomic<bool> abandoned;
+
+	ThreadPools* next;
+};
+
+
+U32 MathMemoryManager::mat4Init = 0;
+U32 MathMemoryManager::mat4Inc = 0;
+U32 MathMemoryManager::mat3Init = 0;
+U32 MathMemoryManager::mat3Inc = 0;
+
+//All pools ever registered, guarded by registryMutex
+static MathMemoryManager::ThreadPools* registry = nullptr;
+static std::mutex registryMutex;
+
+//Incremented by free(), so threads notice that their cached pools are gone
+static std::atomic<U32> generation(1);
+
+
+//Abandons the pools of a thread when the thread exits
+struct ThreadPoolsHandle {
+	MathMemoryManager::ThreadPools* pools = nullptr;
+	U32 generation = 0;
+
+	~ThreadPoolsHandle() {
+		if (pools && generation == ::generation.load(std::memory_order_acquire)) {
+			pools->abandoned.store(true, std::memory_order_release);
+		}
+
+		//Blocks freed after this point go to the remote lists
+		pools = nullptr;
+	}
+};
+
+static thread_local ThreadPoolsHandle threadHandle;
+
+
+//Pushes a block to a remote list. Lock-free, the owner takes the whole list at once so there is no ABA problem.
+static void pushRemote(std::atomic<BlockHeader*>& list, BlockHeader* block)
+{
+	BlockHeader* head = list.load(std::memory_order_relaxed);
+	do {
+		block->next = head;
+	} while (!list.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+//Returns all blocks of a remote list to the pool
+static void drainRemote(std::atomic<BlockHeader*>& list, MathPool& pool)
+{
+	BlockHeader* block = list.exchange(nullptr, std::memory_order_acquire);
+	while (block) {
+		BlockHeader* next = block->next;
+		pool.free(block);
+		block = next;
+	}
+}
+
+static F32* allocBlock(MathPool& pool, std::atomic<BlockHeader*>& remote, MathMemoryManager::ThreadPools* owner)
+{
+	if (remote.load(std::memory_order_relaxed) != nullptr) drainRemote(remote, pool);
+
+	BlockHeader* block = (BlockHeader*)pool.malloc();
+	if (!block) return nullptr;
+
+	return elementsOf(block, owner);
+}
+
+
+void MathMemoryManager::init(U32 mat4, U32 mat4Inc, U32 mat3, U32 mat3Inc)
+{
+	assert(mat4 != 0 || mat4Inc != 0 || mat3 != 0 || mat3Inc != 0);
+
+	MathMemoryManager::mat4Init = mat4;
+	MathMemoryManager::mat4Inc = mat4Inc;
+	MathMemoryManager::mat3Init = mat3;
+	MathMemoryManager::mat3Inc = mat3Inc;
+}
+
+void MathMemoryManager::free()
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	generation.fetch_add(1, std::memory_order_acq_rel);
+
+	while (registry) {
+		ThreadPools* next = registry->next;
+		delete registry;
+		registry = next;
+	}
+}
+
+MathMemoryManager::ThreadPools* MathMemoryManager::threadPools()
+{
+	const U32 gen = generation.load(std::memory_order_acquire);
+	if (threadHandle.pools && threadHandle.generation == gen) return threadHandle.pools;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	ThreadPools* pools = nullptr;
+
+	//Adopt pools of an exited thread if there are any
+	for (ThreadPools* p = registry; p; p = p->next) {
+		bool expected = true;
+		if (p->abandoned.load(std::memory_order_relaxed) && p->abandoned.compare_exchange_strong(expected, false, std::memory_order_acquire)) {
+			pools = p;
+			break;
+		}
+	}
+
+	if (!pools) {
+		pools = new ThreadPools();
+		pools->next = registry;
+		registry = pools;
+	}
+
+	threadHandle.pools = pools;
+	threadHandle.generation = generation.load(std::memory_order_relaxed);
+	return pools;
+}
+
+F32* MathMemoryManager::newMat4()
+{
+	if (currentArena) return arenaBlock(mat4BlockSize);
+
+	return newPoolMat4();
+}
+
+F32* MathMemoryManager::newPoolMat4()
+{
+	ThreadPools* pools = threadPools();
+	countAlloc(MAT4);
+	return allocBlock(pools->pool4, pools->remote4, pools);
+}
+
+void MathMemoryManager::deleteMat4(F32* p)
+{
+	if (!p) return;
+
+	BlockHeader* block = headerOf(p);
+	if (block->owner == &arenaOwner) return;
+
+	countFree(MAT4);
+	ThreadPools* owner = (ThreadPools*)block->owner;
+
+	if (owner == threadHandle.pools) owner->pool4.free(block);
+	else pushRemote(owner->remote4, block);
+}
+
+F32* MathMemoryManager::newMat3()
+{
+	if (currentArena) return arenaBlock(mat3BlockSize);
+
+	return newPoolMat3();
+}
+
+F32* MathMemoryManager::newPoolMat3()
+{
+	ThreadPools* pools = threadPools();
+	countAlloc(MAT3);
+	return allocBlock(pools->pool3, pools->remote3, pools);
+}
+
+void MathMemoryManager::deleteMat3(F32* p)
+{
+	if (!p) return;
+
+	BlockHeader* block = headerOf(p);
+	if (block->owner == &arenaOwner) return;
+
+	countFree(MAT3);
+	ThreadPools* owner = (ThreadPools*)block->owner;
+
+	if (owner == threadHandle.pools) owner->pool3.free(block);
+	else pushRemote(owner->remote3, block);
+}
+
+#else
+
+MathPool* MathMemoryManager::pool4 = nullptr;
+MathPool* MathMemoryManager::pool3 = nullptr;
+
+
+void MathMemoryManager::init(U32 mat4, U32 mat4Inc, U32 mat3, U32 mat3Inc)
+{
+	assert(mat4 != 0 || mat4Inc != 0 || mat3 != 0 || mat3Inc != 0);
+
+
+	pool4 = new MathPool(mat4BlockSize);
+	reservePool(*pool4, mat4, mat4Inc);
+
+	pool3 = new MathPool(mat3BlockSize);
+	reservePool(*pool3, mat3, mat3Inc);
+
+}
+
+void MathMemoryManager::free()
+{
+	delete pool3;
+	delete pool4;
+	pool3 = nullptr;
+	pool4 = nullptr;
+}
+
+F32* MathMemoryManager::newMat4()
+{
+	if (currentArena) return arenaBlock(mat4BlockSize);
+
+	return newPoolMat4();
+}
+
+F32* MathMemoryManager::newPoolMat4()
+{
+	BlockHeader* block = (BlockHeader*)pool4->malloc();
+	if (!block) return nullptr;
+
+	countAlloc(MAT4);
+
+	return elementsOf(block, pool4);
+}
+
+void MathMemoryManager::deleteMat4(F32* p)
+{
+	if (!p) return;
+
+	BlockHeader* block = headerOf(p);
+	if (block->owner == &arenaOwner) return;
+
+	countFree(MAT4);
+	pool4->free(block);
+}
+
+F32* MathMemoryManager::newMat3()
+{
+	if (currentArena) return arenaBlock(mat3BlockSize);
+
+	return newPoolMat3();
+}
+
+F32* MathMemoryManager::newPoolMat3()
+{
+	BlockHeader* block = (BlockHeader*)pool3->malloc();
+	if (!block) return nullptr;
+
+	countAlloc(MAT3);
+
+	return elementsOf(block, pool3);
+}
+
+void MathMemoryManager::deleteMat3(F32* p)
+{
+	if (!p) return;
+
+	BlockHeader* block = headerOf(p);
+	if (block->owner == &arenaOwner) return;
+
+	countFree(MAT3);
+	pool3->free(block);
+}
+
+#endif
+
+bool MathMemoryManager::isArenaBlock(const F32* p)
+{
+	return p && headerOf((F32*)p)->owner == &arenaOwner;
+}
+
+
+//Chunk header is rounded to 16 bytes, so allocations stay 16-byte aligned
+static const size_t chunkHeaderSize = 16;
+
+MathArena::MathArena(size_t chunkSize) : first(nullptr), current(nullptr), cursor(nullptr), end(nullptr), chunkSize(chunkSize), usedBytes(0)
+{
+	static_assert(sizeof(Chunk) <= chunkHeaderSize, "MathArena::Chunk doesn't fit in the chunk header");
+}
+
+MathArena::~MathArena()
+{
+	while (first) {
+		Chunk* next = first->next;
+		delete[] (U8*)first;
+		first = next;
+	}
+}
+
+void MathArena::reset()
+{
+	current = first;
+	cursor = first ? (U8*)first + chunkHeaderSize : nullptr;
+	end = first ? cursor + first->size : nullptr;
+	usedBytes = 0;
+}
+
+void MathArena::nextChunk(size_t size)
+{
+	Chunk* next = current ? current->next : first;
+
+	//Chunks after current are left from before the last reset, a new one is needed only if they run out or are too small
+	if (!next || next->size < size) {
+		const size_t s = size > chunkSize ? size : chunkSize;
+		Chunk* chunk = (Chunk*)new U8[chunkHeaderSize + s];
+		chunk->size = s;
+		chunk->next = next;
+
+		if (current) current->next = chunk;
+		else first = chunk;
+
+		next = chunk;
+	}
+
+	current = next;
+	cursor = (U8*)current + chunkHeaderSize;
+	end = cursor + current->size;
+}
+
+MathArena& MathArena::threadArena()
+{
+	static thread_local MathArena arena;
+	return arena;
+}
+
+
+MathArenaScope::MathArenaScope(MathArena& arena) : previous(currentArena)
+{
+	currentArena = &arena;
+}
+
+MathArenaScope::~MathArenaScope()
+{
+	currentArena = previous;
+}
 
 #endif
 
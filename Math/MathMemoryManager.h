@@ -1,6 +1,6 @@
 #pragma once
 
-#define MATH_CUSTOM_MEMORY
+#include "MathConfig.h"
 #include "DataTypedefs.h"
 #include <assert.h>
 
@@ -11,48 +11,206 @@
 
 
 #ifdef MATH_CUSTOM_MEMORY
+
+#ifdef MATH_MEMORY_STATS
+
+//Allocator of boost::pool that counts how often the pools grow and how much memory they reserve
+struct MathPoolAllocator {
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	static char* malloc(const size_type bytes);
+	static void free(char* const block);
+};
+
+typedef boost::pool<MathPoolAllocator> MathPool;
+
+
+//Snapshot of the MathMemoryManager counters, see MathMemoryManager::stats()
+struct MathMemoryStats {
+	//Matrix4 and Matrix3 blocks currently allocated from the pools
+	U64 liveMat4, liveMat3;
+
+	//Highest live counts since init or resetStats()
+	U64 peakMat4, peakMat3;
+
+	//Allocations and frees since init or resetStats()
+	U64 allocsMat4, freesMat4, allocsMat3, freesMat3;
+
+	//Matrix4 and Matrix3 blocks allocated from arenas since init or resetStats()
+	U64 arenaAllocs;
+
+	//Times the pools had to get more memory from the system since init or resetStats()
+	U64 poolGrowths;
+
+	//Bytes the pools currently hold
+	U64 bytesReserved;
+};
+
+//Call stack of sampled allocations, see MathMemoryManager::sampledSites()
+struct MathAllocationSite {
+	static const U32 MAX_FRAMES = 8;
+
+	//Return addresses, innermost first. Resolve with a debugger or addr2line
+	void* frames[MAX_FRAMES];
+	U32 frameCount;
+
+	//Amount of samples taken from this call stack
+	U64 samples;
+};
+
+#else
+
+typedef boost::pool<> MathPool;
+
+#endif
+
+
+//Memory pools that hold the elements of Matrix4 and Matrix3.
+//With MATH_THREAD_LOCAL_POOLS every thread gets its own pools and allocates without locking. A block freed on another
+//thread is pushed to a lock-free list of the owning pools, and the owning thread takes the blocks back on its next allocation.
+//Pools of exited threads are reused by new threads.
+//While a MathArenaScope is alive, the thread allocates from the scope's MathArena instead of the pools.
 class MathMemoryManager {
 public:
 
-	static void init(U32 mat4, U32 mat4Inc, U32 mat3, U32 mat3Inc)
-	{
-		assert(mat4 != 0 || mat4Inc != 0 || mat3 != 0 || mat3Inc != 0);
+	//Parameters are initial amounts of objects to allocate space for, and size of the first increase of size.
+	//With thread-local pools, every thread gets pools of these sizes when it allocates for the first time.
+	static void init(U32 mat4, U32 mat4Inc, U32 mat3, U32 mat3Inc);
 
+	//Deletes the pools. No matrices from the pools may be alive, and no other thread may use the pools anymore.
+	static void free();
 
-		pool4 = new boost::pool<>(sizeof(F32) * 16 * mat4, mat4Inc * sizeof(F32) * 16);
+	static F32* newMat4();
 
-		pool3 = new boost::pool<>(sizeof(F32) * 9 * mat3, mat3Inc * sizeof(F32) * 9);
+	static void deleteMat4(F32* p);
 
+	static F32* newMat3();
 
+	static void deleteMat3(F32* p);
 
-	}
+	//Allocate from the pools even while a MathArenaScope is alive. Free with deleteMat4() and deleteMat3()
+	static F32* newPoolMat4();
 
-	static void free() {
-		delete pool3;
-		delete pool4;
-	}
+	static F32* newPoolMat3();
 
-	static F32* newMat4() {
-		return (F32*)pool4->malloc();
-	}
+	//Returns true if p is the elements of a matrix allocated from a MathArena. p may be null
+	static bool isArenaBlock(const F32* p);
 
-	static void deleteMat4(F32* p) {
-		if(p) pool4->free(p);
-	}
+#ifdef MATH_MEMORY_STATS
+	//Returns the current values of the counters
+	static MathMemoryStats stats();
+
+	//Zeroes the totals, and sets peaks to the current live counts
+	static void resetStats();
+
+	//Records the call stack of every interval:th pool allocation on each thread. 0 disables sampling
+	static void setSampleInterval(U32 interval);
+
+	//Copies up to maxSites sampled call stacks to sites, most sampled first. Returns the amount copied
+	static U32 sampledSites(MathAllocationSite* sites, U32 maxSites);
+
+	//Forgets all sampled call stacks
+	static void clearSampledSites();
+#endif
+
+#ifdef MATH_THREAD_LOCAL_POOLS
+	//Pools of one thread, defined in MathMemoryManager.cpp
+	struct ThreadPools;
 
-	static F32* newMat3() {
-		return (F32*)pool3->malloc();
-	}
 
-	static void deleteMat3(F32* p) {
-		if (p) pool3->free(p);
+private:
+
+	//Returns the pools of the calling thread, registers new ones if needed
+	static ThreadPools* threadPools();
+
+	static U32 mat4Init, mat4Inc, mat3Init, mat3Inc;
+
+#else
+
+private:
+
+	static MathPool* pool4;
+	static MathPool* pool3;
+
+#endif
+};
+
+
+//Bump-pointer allocator for short-lived Matrix4 and Matrix3 temporaries, used through MathArenaScope.
+//Allocating is a pointer bump, and reset() releases everything at once. Deleting a matrix from an arena does nothing.
+//Matrices allocated from an arena must not be used after reset() or after the arena is destroyed.
+//Assigning to a matrix copies the elements when either matrix is from an arena, so a matrix created outside a scope
+//never takes arena memory from one assigned to it inside the scope (keep = a * b; stays valid after reset()).
+//Moving from an arena matrix copies the elements to pool memory, so moved matrices (v.push_back(a * b), std::swap)
+//stay valid too. Matrices otherwise created inside a scope, including copies, use the arena.
+//Not thread-safe, use one arena per thread (see threadArena()).
+class MathArena {
+public:
+
+	//Creates an empty arena that allocates memory in chunks of chunkSize bytes
+	explicit MathArena(size_t chunkSize = 64 * 1024);
+
+	//Destructor, frees all chunks
+	~MathArena();
+
+	MathArena(const MathArena&) = delete;
+	MathArena& operator =(const MathArena&) = delete;
+
+	//Returns size bytes of 16-byte aligned memory
+	void* allocate(size_t size)
+	{
+		size = (size + 15) & ~size_t(15);
+
+		if (size > size_t(end - cursor)) nextChunk(size);
+
+		void* p = cursor;
+		cursor += size;
+		usedBytes += size;
+		return p;
 	}
 
+	//Releases everything allocated from this arena. Chunks are kept for reuse, so this is O(1).
+	void reset();
+
+	//Returns the amount of bytes allocated since the last reset
+	size_t used() const { return usedBytes; }
+
+	//Returns the arena of the calling thread
+	static MathArena& threadArena();
 
 private:
 
-	static boost::pool<>* pool4;
-	static boost::pool<>* pool3;
+	struct Chunk {
+		Chunk* next;
+		size_t size;
+	};
+
+	//Moves to the next chunk that can fit size bytes, allocating one if needed
+	void nextChunk(size_t size);
+
+	Chunk* first;
+	Chunk* current;
+	U8* cursor;
+	U8* end;
+
+	size_t chunkSize;
+	size_t usedBytes;
+};
+
+
+//Makes Matrix4 and Matrix3 created on this thread allocate from arena while the scope is alive. Scopes can be nested.
+class MathArenaScope {
+public:
+	explicit MathArenaScope(MathArena& arena);
+
+	~MathArenaScope();
+
+	MathArenaScope(const MathArenaScope&) = delete;
+	MathArenaScope& operator =(const MathArenaScope&) = delete;
+
+private:
+	MathArena* previous;
 };
 
 
@@ -75,3 +233,4 @@ private:
 
 
 
+
@@ -0,0 +1,765 @@
+#pragma once
+#include "MathSIMD.h"
+#include "MathUtility.h"
+#include "DataTypedefs.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Matrix4.h"
+
+//Packet types: one register holds the same component of 4 or 8 objects, e.g. Vector3x4 holds x of four vectors in x,
+//y in y and z in z. Code written with them looks like code written with Vector3, Quaternion and Matrix4,
+//but does the work of 4 or 8 objects per operation. Lane i of every component belongs to object i.
+//
+//Float4 uses SSE2, Float8 uses AVX if the build targets it (MATH_AVX) and two Float4s otherwise. Without SSE2 both
+//fall back to plain F32s. Unlike the batch operations of MathBatch.h, packets are not dispatched at runtime.
+
+
+//4 F32s, one per lane
+class Float4 {
+public:
+
+	//Amount of lanes
+	static const U32 WIDTH = 4;
+
+	//Uninitialized
+	Float4() {}
+
+	//All lanes f
+	Float4(F32 f) {
+#ifdef MATH_SSE2
+		v = _mm_set1_ps(f);
+#else
+		v[0] = v[1] = v[2] = v[3] = f;
+#endif
+	}
+
+#ifdef MATH_SSE2
+	explicit Float4(__m128 v) : v(v) {}
+#endif
+
+	//Loads the lanes from 4 F32s at p
+	static Float4 load(const F32* p) {
+#ifdef MATH_SSE2
+		return Float4(_mm_loadu_ps(p));
+#else
+		Float4 r;
+		for (U32 i = 0; i < 4; ++i) r.v[i] = p[i];
+		return r;
+#endif
+	}
+
+	//Stores the lanes to 4 F32s at p
+	void store(F32* p) const {
+#ifdef MATH_SSE2
+		_mm_storeu_ps(p, v);
+#else
+		for (U32 i = 0; i < 4; ++i) p[i] = v[i];
+#endif
+	}
+
+	//Returns lane i
+	F32 operator [](U32 i) const {
+		F32 f[4];
+		store(f);
+		return f[i];
+	}
+
+	//Lane i of a, b, c and d is loaded from p[i][0], p[i][1], p[i][2] and p[i][3]
+	static void loadTransposed(const F32* const* p, Float4& a, Float4& b, Float4& c, Float4& d) {
+#ifdef MATH_SSE2
+		a.v = _mm_loadu_ps(p[0]);
+		b.v = _mm_loadu_ps(p[1]);
+		c.v = _mm_loadu_ps(p[2]);
+		d.v = _mm_loadu_ps(p[3]);
+		_MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+#else
+		for (U32 i = 0; i < 4; ++i) {
+			a.v[i] = p[i][0];
+			b.v[i] = p[i][1];
+			c.v[i] = p[i][2];
+			d.v[i] = p[i][3];
+		}
+#endif
+	}
+
+	//Inverse of loadTransposed()
+	static void storeTransposed(F32* const* p, Float4 a, Float4 b, Float4 c, Float4 d) {
+#ifdef MATH_SSE2
+		_MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+		_mm_storeu_ps(p[0], a.v);
+		_mm_storeu_ps(p[1], b.v);
+		_mm_storeu_ps(p[2], c.v);
+		_mm_storeu_ps(p[3], d.v);
+#else
+		for (U32 i = 0; i < 4; ++i) {
+			p[i][0] = a.v[i];
+			p[i][1] = b.v[i];
+			p[i][2] = c.v[i];
+			p[i][3] = d.v[i];
+		}
+#endif
+	}
+
+	//Lane i of x, y and z is loaded from p[3 * i], p[3 * i + 1] and p[3 * i + 2]. Reads exactly 12 F32s
+	static void loadTransposed3(const F32* p, Float4& x, Float4& y, Float4& z) {
+#ifdef MATH_SSE2
+		using namespace Math::simd;
+		const __m128 f0 = _mm_loadu_ps(p), f1 = _mm_loadu_ps(p + 4), f2 = _mm_loadu_ps(p + 8);
+		x.v = shuffle<0, 1, 0, 2>(shuffle<0, 3, 0, 3>(f0, f0), shuffle<2, 2, 1, 1>(f1, f2));
+		y.v = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(f0, f1), shuffle<3, 3, 2, 2>(f1, f2));
+		z.v = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(f0, f1), shuffle<0, 0, 3, 3>(f2, f2));
+#else
+		for (U32 i = 0; i < 4; ++i) {
+			x.v[i] = p[3 * i];
+			y.v[i] = p[3 * i + 1];
+			z.v[i] = p[3 * i + 2];
+		}
+#endif
+	}
+
+	//Inverse of loadTransposed3(). Writes exactly 12 F32s
+	static void storeTransposed3(F32* p, Float4 x, Float4 y, Float4 z) {
+#ifdef MATH_SSE2
+		using namespace Math::simd;
+		const __m128 xyLo = _mm_unpacklo_ps(x.v, y.v), xyHi = _mm_unpackhi_ps(x.v, y.v);
+		_mm_storeu_ps(p, shuffle<0, 1, 0, 2>(xyLo, shuffle<0, 0, 1, 1>(z.v, x.v)));
+		_mm_storeu_ps(p + 4, shuffle<0, 2, 0, 1>(shuffle<1, 1, 1, 1>(y.v, z.v), xyHi));
+		_mm_storeu_ps(p + 8, shuffle<0, 2, 0, 2>(shuffle<2, 2, 2, 2>(z.v, xyHi), shuffle<3, 3, 3, 3>(xyHi, z.v)));
+#else
+		for (U32 i = 0; i < 4; ++i) {
+			p[3 * i] = x.v[i];
+			p[3 * i + 1] = y.v[i];
+			p[3 * i + 2] = z.v[i];
+		}
+#endif
+	}
+
+
+	friend Float4 operator +(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_add_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] += b.v[i];
+		return a;
+#endif
+	}
+
+	friend Float4 operator -(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_sub_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] -= b.v[i];
+		return a;
+#endif
+	}
+
+	friend Float4 operator *(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_mul_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] *= b.v[i];
+		return a;
+#endif
+	}
+
+	friend Float4 operator /(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_div_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] /= b.v[i];
+		return a;
+#endif
+	}
+
+	Float4 operator -() const {
+#ifdef MATH_SSE2
+		return Float4(_mm_xor_ps(v, _mm_set1_ps(-0.f)));
+#else
+		Float4 r;
+		for (U32 i = 0; i < 4; ++i) r.v[i] = -v[i];
+		return r;
+#endif
+	}
+
+	Float4& operator +=(Float4 f) { return *this = *this + f; }
+	Float4& operator -=(Float4 f) { return *this = *this - f; }
+	Float4& operator *=(Float4 f) { return *this = *this * f; }
+	Float4& operator /=(Float4 f) { return *this = *this / f; }
+
+	//Returns a * b + c, fused when FMA is available
+	friend Float4 madd(Float4 a, Float4 b, Float4 c) {
+#ifdef MATH_SSE2
+		return Float4(Math::simd::madd(a.v, b.v, c.v));
+#else
+		return a * b + c;
+#endif
+	}
+
+	friend Float4 min(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_min_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] = Math::min(a.v[i], b.v[i]);
+		return a;
+#endif
+	}
+
+	friend Float4 max(Float4 a, Float4 b) {
+#ifdef MATH_SSE2
+		return Float4(_mm_max_ps(a.v, b.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] = Math::max(a.v[i], b.v[i]);
+		return a;
+#endif
+	}
+
+	friend Float4 sqrt(Float4 a) {
+#ifdef MATH_SSE2
+		return Float4(_mm_sqrt_ps(a.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] = sqrtf(a.v[i]);
+		return a;
+#endif
+	}
+
+	//Returns 1 / sqrt(a), see Math::rsqrt
+	friend Float4 rsqrt(Float4 a) {
+#ifdef MATH_SSE2
+		return Float4(Math::simd::rsqrt(a.v));
+#else
+		for (U32 i = 0; i < 4; ++i) a.v[i] = Math::rsqrt(a.v[i]);
+		return a;
+#endif
+	}
+
+#ifdef MATH_SSE2
+	__m128 v;
+#else
+	F32 v[4];
+#endif
+};
+
+
+//8 F32s, one per lane
+class Float8 {
+public:
+
+	//Amount of lanes
+	static const U32 WIDTH = 8;
+
+	//Uninitialized
+	Float8() {}
+
+	//All lanes f
+#ifdef MATH_AVX
+	Float8(F32 f) : v(_mm256_set1_ps(f)) {}
+
+	explicit Float8(__m256 v) : v(v) {}
+#else
+	Float8(F32 f) : lo(f), hi(f) {}
+#endif
+
+	//Lanes 0 to 3 from lo and 4 to 7 from hi
+	Float8(Float4 lo, Float4 hi) {
+#ifdef MATH_AVX
+		v = _mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1);
+#else
+		this->lo = lo;
+		this->hi = hi;
+#endif
+	}
+
+	//Returns lanes 0 to 3
+	Float4 low() const {
+#ifdef MATH_AVX
+		return Float4(_mm256_castps256_ps128(v));
+#else
+		return lo;
+#endif
+	}
+
+	//Returns lanes 4 to 7
+	Float4 high() const {
+#ifdef MATH_AVX
+		return Float4(_mm256_extractf128_ps(v, 1));
+#else
+		return hi;
+#endif
+	}
+
+	//Loads the lanes from 8 F32s at p
+	static Float8 load(const F32* p) {
+#ifdef MATH_AVX
+		return Float8(_mm256_loadu_ps(p));
+#else
+		return Float8(Float4::load(p), Float4::load(p + 4));
+#endif
+	}
+
+	//Stores the lanes to 8 F32s at p
+	void store(F32* p) const {
+#ifdef MATH_AVX
+		_mm256_storeu_ps(p, v);
+#else
+		lo.store(p);
+		hi.store(p + 4);
+#endif
+	}
+
+	//Returns lane i
+	F32 operator [](U32 i) const {
+		F32 f[8];
+		store(f);
+		return f[i];
+	}
+
+	//Lane i of a, b, c and d is loaded from p[i][0], p[i][1], p[i][2] and p[i][3]
+	static void loadTransposed(const F32* const* p, Float8& a, Float8& b, Float8& c, Float8& d) {
+		Float4 a0, b0, c0, d0, a1, b1, c1, d1;
+		Float4::loadTransposed(p, a0, b0, c0, d0);
+		Float4::loadTransposed(p + 4, a1, b1, c1, d1);
+		a = Float8(a0, a1);
+		b = Float8(b0, b1);
+		c = Float8(c0, c1);
+		d = Float8(d0, d1);
+	}
+
+	//Inverse of loadTransposed()
+	static void storeTransposed(F32* const* p, Float8 a, Float8 b, Float8 c, Float8 d) {
+		Float4::storeTransposed(p, a.low(), b.low(), c.low(), d.low());
+		Float4::storeTransposed(p + 4, a.high(), b.high(), c.high(), d.high());
+	}
+
+	//Lane i of x, y and z is loaded from p[3 * i], p[3 * i + 1] and p[3 * i + 2]. Reads exactly 24 F32s
+	static void loadTransposed3(const F32* p, Float8& x, Float8& y, Float8& z) {
+		Float4 x0, y0, z0, x1, y1, z1;
+		Float4::loadTransposed3(p, x0, y0, z0);
+		Float4::loadTransposed3(p + 12, x1, y1, z1);
+		x = Float8(x0, x1);
+		y = Float8(y0, y1);
+		z = Float8(z0, z1);
+	}
+
+	//Inverse of loadTransposed3(). Writes exactly 24 F32s
+	static void storeTransposed3(F32* p, Float8 x, Float8 y, Float8 z) {
+		Float4::storeTransposed3(p, x.low(), y.low(), z.low());
+		Float4::storeTransposed3(p + 12, x.high(), y.high(), z.high());
+	}
+
+
+#ifdef MATH_AVX
+	friend Float8 operator +(Float8 a, Float8 b) { return Float8(_mm256_add_ps(a.v, b.v)); }
+	friend Float8 operator -(Float8 a, Float8 b) { return Float8(_mm256_sub_ps(a.v, b.v)); }
+	friend Float8 operator *(Float8 a, Float8 b) { return Float8(_mm256_mul_ps(a.v, b.v)); }
+	friend Float8 operator /(Float8 a, Float8 b) { return Float8(_mm256_div_ps(a.v, b.v)); }
+	Float8 operator -() const { return Float8(_mm256_xor_ps(v, _mm256_set1_ps(-0.f))); }
+
+	//Returns a * b + c, fused when FMA is available
+	friend Float8 madd(Float8 a, Float8 b, Float8 c) { return Float8(Math::simd::madd(a.v, b.v, c.v)); }
+
+	friend Float8 min(Float8 a, Float8 b) { return Float8(_mm256_min_ps(a.v, b.v)); }
+	friend Float8 max(Float8 a, Float8 b) { return Float8(_mm256_max_ps(a.v, b.v)); }
+	friend Float8 sqrt(Float8 a) { return Float8(_mm256_sqrt_ps(a.v)); }
+
+	//Returns 1 / sqrt(a), see Math::rsqrt
+	friend Float8 rsqrt(Float8 a) { return Float8(Math::simd::rsqrt(a.v)); }
+#else
+	friend Float8 operator +(Float8 a, Float8 b) { return Float8(a.lo + b.lo, a.hi + b.hi); }
+	friend Float8 operator -(Float8 a, Float8 b) { return Float8(a.lo - b.lo, a.hi - b.hi); }
+	friend Float8 operator *(Float8 a, Float8 b) { return Float8(a.lo * b.lo, a.hi * b.hi); }
+	friend Float8 operator /(Float8 a, Float8 b) { return Float8(a.lo / b.lo, a.hi / b.hi); }
+	Float8 operator -() const { return Float8(-lo, -hi); }
+
+	//Returns a * b + c, fused when FMA is available
+	friend Float8 madd(Float8 a, Float8 b, Float8 c) { return Float8(madd(a.lo, b.lo, c.lo), madd(a.hi, b.hi, c.hi)); }
+
+	friend Float8 min(Float8 a, Float8 b) { return Float8(min(a.lo, b.lo), min(a.hi, b.hi)); }
+	friend Float8 max(Float8 a, Float8 b) { return Float8(max(a.lo, b.lo), max(a.hi, b.hi)); }
+	friend Float8 sqrt(Float8 a) { return Float8(sqrt(a.lo), sqrt(a.hi)); }
+
+	//Returns 1 / sqrt(a), see Math::rsqrt
+	friend Float8 rsqrt(Float8 a) { return Float8(rsqrt(a.lo), rsqrt(a.hi)); }
+#endif
+
+	Float8& operator +=(Float8 f) { return *this = *this + f; }
+	Float8& operator -=(Float8 f) { return *this = *this - f; }
+	Float8& operator *=(Float8 f) { return *this = *this * f; }
+	Float8& operator /=(Float8 f) { return *this = *this / f; }
+
+#ifdef MATH_AVX
+	__m256 v;
+#else
+	Float4 lo, hi;
+#endif
+};
+
+
+
+template<class F> class Vector3Packet;
+template<class F> class QuaternionPacket;
+template<class F> class Matrix4Packet;
+
+typedef Vector3Packet<Float4> Vector3x4;
+typedef Vector3Packet<Float8> Vector3x8;
+typedef QuaternionPacket<Float4> Quaternionx4;
+typedef QuaternionPacket<Float8> Quaternionx8;
+typedef Matrix4Packet<Float4> Matrix4x4Packet;
+typedef Matrix4Packet<Float8> Matrix4x8Packet;
+
+
+//F::WIDTH Vector3s, see Vector3
+template<class F>
+class Vector3Packet {
+public:
+
+	static const U32 WIDTH = F::WIDTH;
+
+	//Uninitialized
+	Vector3Packet() {}
+
+	Vector3Packet(F x, F y, F z) : x(x), y(y), z(z) {}
+
+	//v in all lanes
+	explicit Vector3Packet(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+
+	//Loads WIDTH consecutive Vector3s from v
+	static Vector3Packet load(const Vector3* v) {
+		Vector3Packet r;
+		F::loadTransposed3(reinterpret_cast<const F32*>(v), r.x, r.y, r.z);
+		return r;
+	}
+
+	//Stores the vectors to WIDTH consecutive Vector3s at v
+	void store(Vector3* v) const {
+		F::storeTransposed3(reinterpret_cast<F32*>(v), x, y, z);
+	}
+
+	//Loads lane i from v[idx[i]]
+	static Vector3Packet gather(const Vector3* v, const U32* idx) {
+		F32 f[3][WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) {
+			f[0][i] = v[idx[i]].x;
+			f[1][i] = v[idx[i]].y;
+			f[2][i] = v[idx[i]].z;
+		}
+
+		return Vector3Packet(F::load(f[0]), F::load(f[1]), F::load(f[2]));
+	}
+
+	//Stores lane i to v[idx[i]]. If indices repeat, the highest lane wins
+	void scatter(Vector3* v, const U32* idx) const {
+		F32 f[3][WIDTH];
+		x.store(f[0]);
+		y.store(f[1]);
+		z.store(f[2]);
+
+		for (U32 i = 0; i < WIDTH; ++i) v[idx[i]] = Vector3(f[0][i], f[1][i], f[2][i]);
+	}
+
+	//Returns the vector in lane i
+	Vector3 get(U32 i) const {
+		return Vector3(x[i], y[i], z[i]);
+	}
+
+
+	//Returns the dot products
+	F dot(const Vector3Packet& v) const {
+		return madd(x, v.x, madd(y, v.y, z * v.z));
+	}
+
+	//Returns the cross products
+	Vector3Packet cross(const Vector3Packet& v) const {
+		return Vector3Packet(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+	}
+
+	//Returns the lengths
+	F lenght() const {
+		return sqrt(lenght2());
+	}
+
+	//Returns the lengths squared
+	F lenght2() const {
+		return dot(*this);
+	}
+
+	//Returns the normalized vectors, see Vector3::normalized()
+	Vector3Packet normalized() const {
+		const F inv = rsqrt(lenght2());
+		return Vector3Packet(x * inv, y * inv, z * inv);
+	}
+
+	//Normalizes the vectors
+	void normalize() {
+		*this = normalized();
+	}
+
+
+	Vector3Packet operator +(const Vector3Packet& v) const { return Vector3Packet(x + v.x, y + v.y, z + v.z); }
+	Vector3Packet operator -(const Vector3Packet& v) const { return Vector3Packet(x - v.x, y - v.y, z - v.z); }
+	Vector3Packet operator -() const { return Vector3Packet(-x, -y, -z); }
+
+	//Scales lane i by lane i of f
+	Vector3Packet operator *(F f) const { return Vector3Packet(x * f, y * f, z * f); }
+	friend Vector3Packet operator *(F f, const Vector3Packet& v) { return v * f; }
+	Vector3Packet operator /(F f) const { return *this * (F(1.f) / f); }
+
+	Vector3Packet& operator +=(const Vector3Packet& v) { return *this = *this + v; }
+	Vector3Packet& operator -=(const Vector3Packet& v) { return *this = *this - v; }
+	Vector3Packet& operator *=(F f) { return *this = *this * f; }
+
+	F x, y, z;
+};
+
+
+//F::WIDTH Quaternions, see Quaternion
+template<class F>
+class QuaternionPacket {
+public:
+
+	static const U32 WIDTH = F::WIDTH;
+
+	//Identity in all lanes
+	QuaternionPacket() : x(0.f), y(0.f), z(0.f), w(1.f) {}
+
+	QuaternionPacket(F x, F y, F z, F w) : x(x), y(y), z(z), w(w) {}
+
+	//q in all lanes
+	explicit QuaternionPacket(const Quaternion& q) : x(q.x), y(q.y), z(q.z), w(q.w) {}
+
+	//Loads WIDTH consecutive Quaternions from q
+	static QuaternionPacket load(const Quaternion* q) {
+		const F32* p[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) p[i] = q[i].toArray();
+
+		QuaternionPacket r;
+		F::loadTransposed(p, r.x, r.y, r.z, r.w);
+		return r;
+	}
+
+	//Stores the Quaternions to WIDTH consecutive Quaternions at q
+	void store(Quaternion* q) const {
+		F32* p[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) p[i] = q[i].toArray();
+
+		F::storeTransposed(p, x, y, z, w);
+	}
+
+	//Loads lane i from q[idx[i]]
+	static QuaternionPacket gather(const Quaternion* q, const U32* idx) {
+		const F32* p[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) p[i] = q[idx[i]].toArray();
+
+		QuaternionPacket r;
+		F::loadTransposed(p, r.x, r.y, r.z, r.w);
+		return r;
+	}
+
+	//Stores lane i to q[idx[i]]. If indices repeat, the highest lane wins
+	void scatter(Quaternion* q, const U32* idx) const {
+		F32* p[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) p[i] = q[idx[i]].toArray();
+
+		F::storeTransposed(p, x, y, z, w);
+	}
+
+	//Returns the Quaternion in lane i
+	Quaternion get(U32 i) const {
+		return Quaternion(x[i], y[i], z[i], w[i]);
+	}
+
+
+	//Hamilton products, see Quaternion::operator*
+	QuaternionPacket operator *(const QuaternionPacket& q) const {
+		return QuaternionPacket(
+			madd(w, q.x, madd(x, q.w, y * q.z - z * q.y)),
+			madd(w, q.y, madd(y, q.w, z * q.x - x * q.z)),
+			madd(w, q.z, madd(z, q.w, x * q.y - y * q.x)),
+			w * q.w - madd(x, q.x, madd(y, q.y, z * q.z)));
+	}
+
+	//Rotates v by normalized Quaternions: v + w * t + cross(xyz, t), where t = 2 * cross(xyz, v)
+	Vector3Packet<F> operator *(const Vector3Packet<F>& v) const {
+		const Vector3Packet<F> u(x, y, z);
+		const Vector3Packet<F> t = u.cross(v) * F(2.f);
+		return v + t * w + u.cross(t);
+	}
+
+	QuaternionPacket operator +(const QuaternionPacket& q) const { return QuaternionPacket(x + q.x, y + q.y, z + q.z, w + q.w); }
+
+	//Scales lane i by lane i of f
+	QuaternionPacket operator *(F f) const { return QuaternionPacket(x * f, y * f, z * f, w * f); }
+	friend QuaternionPacket operator *(F f, const QuaternionPacket& q) { return q * f; }
+
+	QuaternionPacket& operator *=(const QuaternionPacket& q) { return *this = *this * q; }
+
+
+	//Returns the dot products
+	F dot(const QuaternionPacket& q) const {
+		return madd(x, q.x, madd(y, q.y, madd(z, q.z, w * q.w)));
+	}
+
+	//Returns the lengths
+	F lenght() const {
+		return sqrt(dot(*this));
+	}
+
+	//Returns the normalized Quaternions. Uses rsqrt, relative error up to 2.7e-7
+	QuaternionPacket normalized() const {
+		return *this * rsqrt(dot(*this));
+	}
+
+	//Normalizes the Quaternions
+	void normalize() {
+		*this = normalized();
+	}
+
+	//Returns the conjugates (-x, -y, -z, w)
+	QuaternionPacket conjugate() const {
+		return QuaternionPacket(-x, -y, -z, w);
+	}
+
+	//Returns the rotation matrices of normalized Quaternions, see Quaternion::toMatrix()
+	Matrix4Packet<F> toMatrix() const {
+		const F x2 = x + x, y2 = y + y, z2 = z + z;
+		const F xx = x * x2, yy = y * y2, zz = z * z2;
+		const F xy = x * y2, xz = x * z2, yz = y * z2;
+		const F xw = w * x2, yw = w * y2, zw = w * z2;
+		const F one(1.f), zero(0.f);
+
+		return Matrix4Packet<F>(
+			one - (yy + zz), xy - zw, xz + yw, zero,
+			xy + zw, one - (xx + zz), yz - xw, zero,
+			xz - yw, yz + xw, one - (xx + yy), zero,
+			zero, zero, zero, one);
+	}
+
+	F x, y, z, w;
+};
+
+
+//F::WIDTH Matrix4s, see Matrix4. m[r * 4 + c] holds row r and column c of all matrices
+template<class F>
+class Matrix4Packet {
+public:
+
+	static const U32 WIDTH = F::WIDTH;
+
+	//Identity in all lanes
+	Matrix4Packet() {
+		for (U32 i = 0; i < 16; ++i) m[i] = F(i % 5 == 0 ? 1.f : 0.f);
+	}
+
+	Matrix4Packet(F m00, F m01, F m02, F m03, F m10, F m11, F m12, F m13, F m20, F m21, F m22, F m23, F m30, F m31, F m32, F m33) {
+		m[0] = m00; m[1] = m01; m[2] = m02; m[3] = m03;
+		m[4] = m10; m[5] = m11; m[6] = m12; m[7] = m13;
+		m[8] = m20; m[9] = m21; m[10] = m22; m[11] = m23;
+		m[12] = m30; m[13] = m31; m[14] = m32; m[15] = m33;
+	}
+
+	//mat in all lanes
+	explicit Matrix4Packet(const Matrix4& mat) {
+		const F32* p = mat.toArray();
+		for (U32 i = 0; i < 16; ++i) m[i] = F(p[i]);
+	}
+
+	//Loads WIDTH consecutive matrices of 16 row-major F32s from p
+	static Matrix4Packet load(const F32* p) {
+		const F32* rows[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) rows[i] = p + i * 16;
+
+		return loadRows(rows);
+	}
+
+	//Stores the matrices to WIDTH consecutive matrices of 16 row-major F32s at p
+	void store(F32* p) const {
+		F32* rows[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) rows[i] = p + i * 16;
+
+		storeRows(rows);
+	}
+
+	//Loads lane i from mats[idx[i]]
+	static Matrix4Packet gather(const Matrix4* mats, const U32* idx) {
+		const F32* rows[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) rows[i] = mats[idx[i]].toArray();
+
+		return loadRows(rows);
+	}
+
+	//Stores lane i to mats[idx[i]]. If indices repeat, the highest lane wins
+	void scatter(Matrix4* mats, const U32* idx) const {
+		F32* rows[WIDTH];
+		for (U32 i = 0; i < WIDTH; ++i) rows[i] = mats[idx[i]].toArray();
+
+		storeRows(rows);
+	}
+
+	//Returns the matrix in lane i
+	Matrix4 get(U32 i) const {
+		Matrix4 mat;
+		F32* p = mat.toArray();
+		for (U32 e = 0; e < 16; ++e) p[e] = m[e][i];
+
+		return mat;
+	}
+
+
+	//Matrix products, see Matrix4::operator*
+	Matrix4Packet operator *(const Matrix4Packet& b) const {
+		Matrix4Packet r;
+		for (U32 row = 0; row < 4; ++row) {
+			const F* a = m + row * 4;
+			for (U32 c = 0; c < 4; ++c) r.m[row * 4 + c] = madd(a[0], b.m[c], madd(a[1], b.m[4 + c], madd(a[2], b.m[8 + c], a[3] * b.m[12 + c])));
+		}
+
+		return r;
+	}
+
+	Matrix4Packet& operator *=(const Matrix4Packet& b) { return *this = *this * b; }
+
+	//Transforms points, m * (v, 1). The last row is ignored
+	Vector3Packet<F> transformPoint(const Vector3Packet<F>& v) const {
+		return Vector3Packet<F>(
+			madd(m[0], v.x, madd(m[1], v.y, madd(m[2], v.z, m[3]))),
+			madd(m[4], v.x, madd(m[5], v.y, madd(m[6], v.z, m[7]))),
+			madd(m[8], v.x, madd(m[9], v.y, madd(m[10], v.z, m[11]))));
+	}
+
+	//Transforms directions, m * (v, 0). The last row is ignored
+	Vector3Packet<F> transformDirection(const Vector3Packet<F>& v) const {
+		return Vector3Packet<F>(
+			madd(m[0], v.x, madd(m[1], v.y, m[2] * v.z)),
+			madd(m[4], v.x, madd(m[5], v.y, m[6] * v.z)),
+			madd(m[8], v.x, madd(m[9], v.y, m[10] * v.z)));
+	}
+
+	//Returns the transposed matrices
+	Matrix4Packet transposed() const {
+		return Matrix4Packet(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	}
+
+	F m[16];
+
+private:
+
+	//Lane i is loaded from 16 row-major F32s at rows[i]
+	static Matrix4Packet loadRows(const F32* const* rows) {
+		Matrix4Packet r;
+		const F32* p[WIDTH];
+		for (U32 row = 0; row < 4; ++row) {
+			for (U32 i = 0; i < WIDTH; ++i) p[i] = rows[i] + row * 4;
+			F::loadTransposed(p, r.m[row * 4], r.m[row * 4 + 1], r.m[row * 4 + 2], r.m[row * 4 + 3]);
+		}
+
+		return r;
+	}
+
+	//Lane i is stored to 16 row-major F32s at rows[i]
+	void storeRows(F32* const* rows) const {
+		F32* p[WIDTH];
+		for (U32 row = 0; row < 4; ++row) {
+			for (U32 i = 0; i < WIDTH; ++i) p[i] = rows[i] + row * 4;
+			F::storeTransposed(p, m[row * 4], m[row * 4 + 1], m[row * 4 + 2], m[row * 4 + 3]);
+		}
+	}
+};
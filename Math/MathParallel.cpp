@@ -0,0 +1,159 @@
+#include "MathParallel.h"
+
+static inline U64 packRange(U32 first, U32 end)
+{
+	return U64(first) | (U64(end) << 32);
+}
+
+ThreadPool::ThreadPool(U32 threadCount)
+{
+	if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0) threadCount = 1;
+
+	fn = nullptr;
+	data = nullptr;
+	generation = 0;
+	active = 0;
+	stop = false;
+
+	slots.reset(new Slot[threadCount]);
+	for (U32 i = 0; i < threadCount; ++i) slots[i].range.store(0, std::memory_order_relaxed);
+
+	threads.reserve(threadCount - 1);
+	for (U32 i = 1; i < threadCount; ++i) threads.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& t : threads) t.join();
+}
+
+void ThreadPool::run(void (*fn)(void* data, U32 chunk), void* data, U32 chunkCount)
+{
+	std::unique_lock<std::mutex> runLock(running, std::try_to_lock);
+	if (!runLock.owns_lock() || threads.empty()) {
+		for (U32 c = 0; c < chunkCount; ++c) fn(data, c);
+		return;
+	}
+
+	//No started thread is active since the last run() returned, so the job and the ranges can be written.
+	//The mutex publishes them to the threads
+	this->fn = fn;
+	this->data = data;
+
+	const U32 n = size();
+	for (U32 i = 0; i < n; ++i) {
+		slots[i].range.store(packRange(U32(U64(chunkCount) * i / n), U32(U64(chunkCount) * (i + 1) / n)), std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		active = U32(threads.size());
+		++generation;
+	}
+	wake.notify_all();
+
+	runChunks(0);
+
+	//Chunks stolen by other threads may still be running. Every thread has to leave runChunks() before the
+	//next run() writes the ranges, or a late steal() could overwrite the range of its slot
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return active == 0; });
+}
+
+void ThreadPool::work(U32 self)
+{
+	U64 seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stop || generation != seen; });
+			if (stop) return;
+			seen = generation;
+		}
+
+		runChunks(self);
+
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			last = --active == 0;
+		}
+		if (last) done.notify_one();
+	}
+}
+
+void ThreadPool::runChunks(U32 self)
+{
+	U32 chunk;
+	while (pop(self, chunk) || steal(self, chunk)) {
+		fn(data, chunk);
+	}
+}
+
+bool ThreadPool::pop(U32 self, U32& chunk)
+{
+	std::atomic<U64>& range = slots[self].range;
+
+	U64 r = range.load(std::memory_order_acquire);
+	for (;;) {
+		const U32 first = U32(r), end = U32(r >> 32);
+		if (first >= end) return false;
+
+		if (range.compare_exchange_weak(r, packRange(first + 1, end), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			chunk = first;
+			return true;
+		}
+	}
+}
+
+bool ThreadPool::steal(U32 self, U32& chunk)
+{
+	const U32 n = size();
+	for (U32 i = 1; i < n; ++i) {
+		std::atomic<U64>& range = slots[(self + i) % n].range;
+
+		U64 r = range.load(std::memory_order_acquire);
+		for (;;) {
+			const U32 first = U32(r), end = U32(r >> 32);
+			if (first >= end) break;
+
+			const U32 taken = (end - first + 1) / 2;
+			if (range.compare_exchange_weak(r, packRange(first, end - taken), std::memory_order_acq_rel, std::memory_order_acquire)) {
+				chunk = end - taken;
+				slots[self].range.store(packRange(chunk + 1, end), std::memory_order_release);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+
+namespace Math {
+
+	static std::atomic<Executor*> userExecutor(nullptr);
+
+	void setExecutor(Executor* e)
+	{
+		userExecutor.store(e, std::memory_order_release);
+	}
+
+	Executor& getExecutor()
+	{
+		Executor* e = userExecutor.load(std::memory_order_acquire);
+		if (e) return *e;
+
+		static ThreadPool defaultPool;
+		return defaultPool;
+	}
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DataTypedefs.h"
+
+//Runs the chunks of a parallel loop. Implement it to run the parallel batch operations on another job system,
+//and pass it to Math::setExecutor.
+class Executor {
+public:
+	virtual ~Executor() {}
+
+	//Calls fn(data, c) once for every chunk c from 0 to chunkCount - 1, in any order and on any threads,
+	//and returns when all calls have returned. Chunks are independent of each other
+	virtual void run(void (*fn)(void* data, U32 chunk), void* data, U32 chunkCount) = 0;
+};
+
+
+//Work-stealing thread pool. The chunks of a run() are split into a contiguous range per thread. A thread takes chunks
+//from the front of its own range, and when it runs out, steals half of the rest of another thread's range.
+//The calling thread works too, and run() returns when every thread has left the job, so no thread of one run()
+//can take chunks of the next. run() is not reentrant: a run() on a pool that is already running,
+//e.g. from inside a chunk, runs its chunks on the calling thread.
+class ThreadPool : public Executor {
+public:
+
+	//Pool that uses threadCount threads including the calling one, so it starts threadCount - 1 threads.
+	//0 uses one thread per hardware thread
+	explicit ThreadPool(U32 threadCount = 0);
+
+	//Stops and joins the threads
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//Returns the amount of threads, including the calling one
+	inline U32 size() const { return U32(threads.size()) + 1; }
+
+	void run(void (*fn)(void* data, U32 chunk), void* data, U32 chunkCount) override;
+
+private:
+
+	//Range of chunks of one thread, first chunk in the low 32 bits and end in the high 32 bits.
+	//Padded to a cache line, so that threads taking chunks do not slow down each other. Padding instead of alignas,
+	//since new only aligns over-aligned types from C++17
+	struct Slot {
+		std::atomic<U64> range;
+		U8 padding[64 - sizeof(std::atomic<U64>)];
+	};
+
+	//Thread function of the started threads
+	void work(U32 self);
+
+	//Runs chunks from the own range and stolen ones until all ranges are empty
+	void runChunks(U32 self);
+
+	//Takes a chunk from the front of the range of slot self
+	bool pop(U32 self, U32& chunk);
+
+	//Steals half of the range of another thread, runs its first chunk and keeps the rest in slot self
+	bool steal(U32 self, U32& chunk);
+
+
+	std::vector<std::thread> threads;
+	std::unique_ptr<Slot[]> slots;
+
+	//The job of the current run(), only written while no started thread is active
+	void (*fn)(void* data, U32 chunk);
+	void* data;
+
+	//Threads sleep on wake until generation changes. run() sets active to the amount of started threads,
+	//each of them decrements it when it runs out of chunks, and run() sleeps on done until it is 0
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	U64 generation;
+	U32 active;
+	bool stop;
+
+	//Held during run()
+	std::mutex running;
+};
+
+
+namespace Math {
+
+	//Default amount of elements per chunk of the parallel batch operations
+	const U32 PARALLEL_CHUNK = 4096;
+
+	//Sets the executor of parallelFor. Null selects the default, a ThreadPool with one thread per hardware thread
+	//that is created on first use. e must outlive its use
+	void setExecutor(Executor* e);
+
+	//Returns the executor of parallelFor
+	Executor& getExecutor();
+
+
+	//Splits elements 0 to count - 1 into chunks of chunkSize elements and calls body(first, n) for each chunk in parallel.
+	//chunkSize is rounded up to a multiple of 16, so every chunk starts where the serial SIMD kernels would start a block.
+	//Chunks depend only on count and chunkSize, not on the executor or the amount of threads, so the results are bitwise
+	//the same as from the serial batch operations. A single chunk runs on the calling thread
+	template<class Body>
+	void parallelFor(U32 count, U32 chunkSize, const Body& body)
+	{
+		if (count == 0) return;
+
+		chunkSize = chunkSize < 16 ? 16 : (chunkSize + 15) & ~15u;
+		const U32 chunks = (count - 1) / chunkSize + 1;
+		if (chunks == 1) {
+			body(0u, count);
+			return;
+		}
+
+		struct Job {
+			const Body* body;
+			U32 count, chunkSize;
+
+			static void run(void* data, U32 chunk) {
+				const Job* job = static_cast<const Job*>(data);
+				const U32 first = chunk * job->chunkSize;
+				const U32 n = job->count - first < job->chunkSize ? job->count - first : job->chunkSize;
+				(*job->body)(first, n);
+			}
+		};
+
+		Job job = { &body, count, chunkSize };
+		getExecutor().run(&Job::run, &job, chunks);
+	}
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "MathConfig.h"
+#include "DataTypedefs.h"
+
+//Detects which SIMD instruction sets the compiler targets, and includes their intrinsics.
+//MATH_SSE2: SSE2 (always on x64), MATH_AVX: AVX, MATH_FMA: fused multiply-add.
+//MSVC has no FMA define, /arch:AVX2 implies it.
+
+#ifndef MATH_NO_SIMD
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MATH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(MATH_SSE2) && defined(__AVX__)
+#define MATH_AVX
+#include <immintrin.h>
+#endif
+
+#if defined(MATH_AVX) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MATH_FMA
+#endif
+
+#endif
+
+//Marks a function to be compiled for instruction sets the rest of the build does not target.
+//Call such functions only after checking the CPU, see MathDispatch.h. MSVC allows all intrinsics anywhere, so it needs nothing.
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MATH_TARGET(isa)
+#endif
+
+#if defined(MATH_SIMD_VECTORS) && !defined(MATH_SSE2)
+#undef MATH_SIMD_VECTORS
+#endif
+
+
+#ifdef MATH_SSE2
+
+namespace Math {
+	namespace simd {
+
+		//Returns a * b + c, fused when FMA is available
+		inline __m128 madd(__m128 a, __m128 b, __m128 c)
+		{
+#ifdef MATH_FMA
+			return _mm_fmadd_ps(a, b, c);
+#else
+			return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+		}
+
+		//Returns vector with element i of v in all lanes
+		template<int i>
+		inline __m128 splat(__m128 v)
+		{
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+		}
+
+		//Returns (a[x], a[y], b[z], b[w])
+		template<int x, int y, int z, int w>
+		inline __m128 shuffle(__m128 a, __m128 b)
+		{
+			return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+		}
+
+		//Returns the dot product of a and b in all lanes
+		inline __m128 dot4(__m128 a, __m128 b)
+		{
+			__m128 m = _mm_mul_ps(a, b);
+			m = _mm_add_ps(m, shuffle<1, 0, 3, 2>(m, m));
+			return _mm_add_ps(m, shuffle<2, 3, 0, 1>(m, m));
+		}
+
+		//Returns 1 / sqrt(x): the estimate of rsqrtps (12 bits) refined with one Newton-Raphson step,
+		//y * (1.5 - 0.5 * x * y * y). Relative error up to 2.7e-7, NaN for 0 and infinity
+		inline __m128 rsqrt(__m128 x)
+		{
+			const __m128 y = _mm_rsqrt_ps(x);
+			const __m128 hxy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), y);
+			return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(hxy, y)));
+		}
+
+		//Returns true if all lanes of a and b are equal
+		inline bool equal4(__m128 a, __m128 b)
+		{
+			return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xF;
+		}
+
+		//Returns Hamilton product a * b of Quaternions stored as (x, y, z, w):
+		//b.w * (ax, ay, az, aw) + b.x * (aw, az, -ay, -ax) + b.y * (-az, aw, ax, -ay) + b.z * (ay, -ax, aw, -az)
+		inline __m128 quatMul(__m128 a, __m128 b)
+		{
+			const __m128 sign1 = _mm_setr_ps(0.f, 0.f, -0.f, -0.f);
+			const __m128 sign2 = _mm_setr_ps(-0.f, 0.f, 0.f, -0.f);
+			const __m128 sign3 = _mm_setr_ps(0.f, -0.f, 0.f, -0.f);
+
+			__m128 r = _mm_mul_ps(splat<3>(b), a);
+			r = madd(splat<0>(b), _mm_xor_ps(shuffle<3, 2, 1, 0>(a, a), sign1), r);
+			r = madd(splat<1>(b), _mm_xor_ps(shuffle<2, 3, 0, 1>(a, a), sign2), r);
+			r = madd(splat<2>(b), _mm_xor_ps(shuffle<1, 0, 3, 2>(a, a), sign3), r);
+			return r;
+		}
+
+#ifdef MATH_AVX
+		//Returns a * b + c, fused when FMA is available
+		inline __m256 madd(__m256 a, __m256 b, __m256 c)
+		{
+#ifdef MATH_FMA
+			return _mm256_fmadd_ps(a, b, c);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+		}
+
+		//Returns vector with element i of each 128-bit half of v in all lanes of that half
+		template<int i>
+		inline __m256 splat(__m256 v)
+		{
+			return _mm256_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+		}
+
+		//Returns 1 / sqrt(x) of 8 floats, see rsqrt(__m128)
+		inline __m256 rsqrt(__m256 x)
+		{
+			const __m256 y = _mm256_rsqrt_ps(x);
+			const __m256 hxy = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), y);
+			return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(hxy, y)));
+		}
+
+		//Returns 4 floats from p in both halves
+		inline __m256 loadBoth(const F32* p)
+		{
+			const __m128 v = _mm_loadu_ps(p);
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+		}
+#endif
+
+	}
+}
+
+#endif
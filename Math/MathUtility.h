@@ -1,5 +1,8 @@
 #pragma once
 #include "DataTypedefs.h"
+#include "MathSIMD.h"
+#include <cmath>
+#include <cstring>
 #define PI 3.14159265358979323846f
 #define TAU 6.283185307179586f
 #undef min
@@ -22,22 +25,35 @@ namespace Math {
 	//Clamps val between min and max
 	inline F32 clamp(F32 val, F32 min, F32 max) { return val < min ? min : val > max ? max : val; }
 
+	//Returns an approximation of 1 / sqrt(number) with the bit trick of Quake III and two Newton-Raphson steps.
+	//Relative error up to 5e-6, use rsqrt() instead, it is both faster and more accurate where SSE is available
 	inline F32 isqrt(F32 number) {
-		long i;
+		I32 i;
 		F32 x2, y;
 		const F32 threehalfs = 1.5F;
 
 		x2 = number * 0.5F;
 		y = number;
-		i = *(long *)&y;  // evil F32ing point bit level hacking
-		i = 0x5f3759df - (i >> 1); // what the fuck?
-		y = *(F32 *)&i;
+		memcpy(&i, &y, sizeof(i));
+		i = 0x5f3759df - (i >> 1);
+		memcpy(&y, &i, sizeof(y));
 		y = y * (threehalfs - (x2 * y * y)); // 1st iteration
-		y = y * (threehalfs - (x2 * y * y));   // 2nd iteration, this can be removed
+		y = y * (threehalfs - (x2 * y * y)); // 2nd iteration
 
 		return y;
 	}
 
+	//Returns 1 / sqrt(x). With SSE the hardware estimate (rsqrtss) is refined with one Newton-Raphson step,
+	//relative error up to 2.7e-7. Only for positive finite x, 0 and infinity give NaN with SSE
+	inline F32 rsqrt(F32 x)
+	{
+#ifdef MATH_SSE2
+		return _mm_cvtss_f32(simd::rsqrt(_mm_set_ss(x)));
+#else
+		return 1.f / sqrtf(x);
+#endif
+	}
+
 
 
 }
\ No newline at end of file
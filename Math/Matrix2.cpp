@@ -1,5 +1,6 @@
 #include "Matrix2.h"
 #include "Vector2.h"
+#include "MathFast.h"
 
 
 const F32 Matrix2::identityMatrix[4] = { 1,0,1,0 };
@@ -222,8 +223,11 @@ void Matrix2::scale(F32 f)
 
 void Matrix2::rotate(F32 angle)
 {
-	Matrix2 m(cosf(angle), -sinf(angle),
-		sinf(angle), cosf(angle));
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
+	Matrix2 m(c, -s,
+		s, c);
 
 
 	this->operator*=(m);
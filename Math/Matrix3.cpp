@@ -1,13 +1,15 @@
 #include "Matrix3.h"
 #include "Vector3.h"
 #include "MathMemoryManager.h"
+#include "MathFast.h"
 const F32 Matrix3::identityMatrix[9] = { 1,0,0,0,1,0,0,0,1 };
 const F32 Matrix3::zeroArray[9] = { 0 };
 
 
 Matrix3::Matrix3()
 {
-#ifdef MATH_CUSTOM_MEMORY
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
 	elements = MathMemoryManager::newMat3();
 #else
 	elements = new F32[9];
@@ -20,7 +22,8 @@ Matrix3::Matrix3()
 
 Matrix3::Matrix3(F32 f0, F32 f1, F32 f2, F32 f3, F32 f4, F32 f5, F32 f6, F32 f7, F32 f8)
 {
-#ifdef MATH_CUSTOM_MEMORY
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
 	elements = MathMemoryManager::newMat3();
 #else
 	elements = new F32[9];
@@ -39,6 +42,8 @@ Matrix3::Matrix3(F32 f0, F32 f1, F32 f2, F32 f3, F32 f4, F32 f5, F32 f6, F32 f7,
 
 }
 
+#ifndef MATH_INLINE_MATRICES
+
 Matrix3::Matrix3(const Matrix3& m)
 {
 	
@@ -54,6 +59,15 @@ Matrix3::Matrix3(const Matrix3& m)
 Matrix3::Matrix3(Matrix3&& m)
 {
 
+#ifdef MATH_CUSTOM_MEMORY
+	//The new matrix may outlive the arena (v.push_back(a * b) inside a scope), so copy to pool memory,
+	//which newMat3() would not give while a scope is alive
+	if (MathMemoryManager::isArenaBlock(m.elements)) {
+		elements = MathMemoryManager::newPoolMat3();
+		memcpy(elements, m.elements, sizeof(F32) * 9);
+		return;
+	}
+#endif
 	elements = m.elements;
 	m.elements = nullptr;
 }
@@ -68,8 +82,20 @@ Matrix3& Matrix3::operator=(const Matrix3& m)
 Matrix3& Matrix3::operator=(Matrix3&& m)
 {
 
+#ifdef MATH_CUSTOM_MEMORY
+	//Swapping would hand arena memory to a matrix that may outlive the arena, or pool memory to an arena matrix
+	if (MathMemoryManager::isArenaBlock(elements) || MathMemoryManager::isArenaBlock(m.elements)) {
+		//A moved-from matrix has no elements. It may have been created outside the scope, so it gets pool memory
+		if (!elements) elements = MathMemoryManager::newPoolMat3();
+		memcpy(elements, m.elements, sizeof(F32) * 9);
+		return *this;
+	}
+#endif
+
+	//Swap, so the old elements get released by m
+	F32* old = elements;
 	elements = m.elements;
-	m.elements = nullptr;
+	m.elements = old;
 	return *this;
 }
 
@@ -82,6 +108,8 @@ Matrix3::~Matrix3() {
 #endif
 }
 
+#endif
+
 
 
 Matrix3 Matrix3::operator*(const Matrix3& m) const
@@ -314,10 +342,12 @@ void Matrix3::rotate(const Vector3& axis, F32 angle)
 
 	F32 hAng = angle / 2.0f;
 
-	F32 x = axis.x * sinf(hAng);
-	F32 y = axis.y * sinf(hAng);
-	F32 z = axis.z * sinf(hAng);
-	F32 w = cosf(hAng);
+	F32 s, w;
+	Math::trig::sincos(hAng, s, w);
+
+	F32 x = axis.x * s;
+	F32 y = axis.y * s;
+	F32 z = axis.z * s;
 
 
 	m.setElement(0, 0, 1 - 2 * (y * y) - 2 * (z * z)); m.setElement(0, 1, 2 * x * y - 2 * z * w); m.setElement(0, 2, 2 * x * z + 2 * y * w);
@@ -331,24 +361,33 @@ void Matrix3::rotate(const Vector3& axis, F32 angle)
 
 void Matrix3::rotateX(F32 angle)
 {
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
 	this->operator*=(Matrix3(1, 0, 0,
-		0, cosf(angle), -sinf(angle),
-		0, sinf(angle), cosf(angle)
+		0, c, -s,
+		0, s, c
 		));
 }
 
 void Matrix3::rotateY(F32 angle)
 {
-	this->operator*=(Matrix3(cosf(angle), 0, sinf(angle),
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
+	this->operator*=(Matrix3(c, 0, s,
 		0, 1, 0,
-		-sinf(angle), 0, cosf(angle)
+		-s, 0, c
 		));
 }
 
 void Matrix3::rotateZ(F32 angle)
 {
-	this->operator*=(Matrix3(cosf(angle), -sinf(angle), 0,
-		sinf(angle), cosf(angle), 0,
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
+	this->operator*=(Matrix3(c, -s, 0,
+		s, c, 0,
 		0, 0, 1
 		));
 }
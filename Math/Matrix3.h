@@ -1,6 +1,7 @@
 #pragma once
 #include <iostream>
 #include "DataTypedefs.h"
+#include "MathConfig.h"
 
 class Vector3;
 
@@ -8,6 +9,7 @@ class Vector3;
 //Because deals with non-homogeneous coordinates, no translation.
 //If you want to use matrixes with 2D homogeneous coordinates, look to Math::homogeneous2D namespace inside Math.h
 //No own variables nor references
+//With MATH_INLINE_MATRICES the elements are stored inside the object(tightly packed, 36 bytes), otherwise behind a pointer
 class Matrix3 {
 public:
 
@@ -17,6 +19,22 @@ public:
 	//Constructs matrix from 9 elements(row-major)
 	Matrix3(F32, F32, F32, F32, F32, F32, F32, F32, F32);
 
+#ifdef MATH_INLINE_MATRICES
+	//Copy constructor
+	Matrix3(const Matrix3& m) = default;
+
+	//Move constructor
+	Matrix3(Matrix3&& m) = default;
+
+	//Assignment operator
+	Matrix3& operator =(const Matrix3& m) = default;
+
+	//Assignment operator
+	Matrix3& operator =(Matrix3&& m) = default;
+
+	//Destructor
+	~Matrix3() = default;
+#else
 	//Copy constructor
 	Matrix3(const Matrix3& m);
 		
@@ -33,6 +51,7 @@ public:
 
 	//Destructor
 	~Matrix3();
+#endif
 
 
 	//Matrix multiplication
@@ -71,7 +90,10 @@ public:
 	bool operator !=(const Matrix3& m) const;
 
 	//Returns a pointer to start of row i
-	F32* operator [](U32 i) const { return elements + (i * 3); }
+	F32* operator [](U32 i) { return elements + (i * 3); }
+
+	//Returns a pointer to start of row i
+	const F32* operator [](U32 i) const { return elements + (i * 3); }
 
 	//Matrix-vector multiplication
 	Vector3 operator *(const Vector3& v) const;
@@ -149,7 +171,11 @@ public:
 
 
 private:
+#ifdef MATH_INLINE_MATRICES
+	F32 elements[9];
+#else
 	F32* elements;
+#endif
 
 	static const F32 zeroArray[9];
 
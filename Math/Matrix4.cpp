@@ -3,6 +3,9 @@
 #include "Vector4.h"
 #include "Quaternion.h"
 #include "MathMemoryManager.h"
+#include "MathDispatch.h"
+#include "MathFast.h"
+#include "MathKernels.h"
 
 const F32 Matrix4::identityMatrix[16] = { 1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1 };
 const F32 Matrix4::zeroArray[16] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
@@ -10,7 +13,8 @@ const F32 Matrix4::zeroArray[16] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
 
 Matrix4::Matrix4()
 {
-#ifdef MATH_CUSTOM_MEMORY
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
 	elements = MathMemoryManager::newMat4();
 #else
 	elements = new F32[16];
@@ -19,9 +23,20 @@ Matrix4::Matrix4()
 
 }
 
+Matrix4::Matrix4(NoInit)
+{
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
+	elements = MathMemoryManager::newMat4();
+#else
+	elements = new F32[16];
+#endif
+}
+
 Matrix4::Matrix4(F32 f0, F32 f1, F32 f2, F32 f3, F32 f4, F32 f5, F32 f6, F32 f7, F32 f8, F32 f9, F32 f10, F32 f11, F32 f12, F32 f13, F32 f14, F32 f15)
 {
-#ifdef MATH_CUSTOM_MEMORY
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
 	elements = MathMemoryManager::newMat4();
 #else
 	elements = new F32[16];
@@ -46,37 +61,58 @@ Matrix4::Matrix4(F32 f0, F32 f1, F32 f2, F32 f3, F32 f4, F32 f5, F32 f6, F32 f7,
 
 }
 
-Matrix4::Matrix4(const Matrix4& m)
+Matrix4::Matrix4(F32* f)
 {
-
-#ifdef MATH_CUSTOM_MEMORY
+#if defined(MATH_INLINE_MATRICES)
+#elif defined(MATH_CUSTOM_MEMORY)
 	elements = MathMemoryManager::newMat4();
 #else
 	elements = new F32[16];
 #endif
-	memcpy(elements, m.elements,sizeof(F32) * 16);
+		memcpy(elements, f, sizeof(F32) * 16);
 }
 
-Matrix4::Matrix4(Matrix4&& m) {
-
-	elements = m.elements;
-	m.elements = nullptr;
+Matrix4::Matrix4(F32** f)
+{
+#if defined(MATH_INLINE_MATRICES) || defined(MATH_CUSTOM_MEMORY)
+	//Storage doesn't come from new[], so copy the array and free it here
+#ifndef MATH_INLINE_MATRICES
+	elements = MathMemoryManager::newMat4();
+#endif
+	memcpy(elements, *f, sizeof(F32) * 16);
+	delete[] *f;
+#else
+	elements = *f;
+#endif
+	*f = nullptr;
 }
 
-Matrix4::Matrix4(F32* f)
+#ifndef MATH_INLINE_MATRICES
+
+Matrix4::Matrix4(const Matrix4& m)
 {
+
 #ifdef MATH_CUSTOM_MEMORY
 	elements = MathMemoryManager::newMat4();
 #else
 	elements = new F32[16];
 #endif
-		memcpy(elements, f, sizeof(F32) * 16);
+	memcpy(elements, m.elements,sizeof(F32) * 16);
 }
 
-Matrix4::Matrix4(F32** f)
-{
-	elements = *f;
-	*f = nullptr;
+Matrix4::Matrix4(Matrix4&& m) {
+
+#ifdef MATH_CUSTOM_MEMORY
+	//The new matrix may outlive the arena (v.push_back(a * b) inside a scope), so copy to pool memory,
+	//which newMat4() would not give while a scope is alive
+	if (MathMemoryManager::isArenaBlock(m.elements)) {
+		elements = MathMemoryManager::newPoolMat4();
+		memcpy(elements, m.elements, sizeof(F32) * 16);
+		return;
+	}
+#endif
+	elements = m.elements;
+	m.elements = nullptr;
 }
 
 Matrix4& Matrix4::operator=(const Matrix4& m) {
@@ -88,8 +124,20 @@ Matrix4& Matrix4::operator=(const Matrix4& m) {
 
 Matrix4& Matrix4::operator=(Matrix4&& m) {
 
+#ifdef MATH_CUSTOM_MEMORY
+	//Swapping would hand arena memory to a matrix that may outlive the arena, or pool memory to an arena matrix
+	if (MathMemoryManager::isArenaBlock(elements) || MathMemoryManager::isArenaBlock(m.elements)) {
+		//A moved-from matrix has no elements. It may have been created outside the scope, so it gets pool memory
+		if (!elements) elements = MathMemoryManager::newPoolMat4();
+		memcpy(elements, m.elements, sizeof(F32) * 16);
+		return *this;
+	}
+#endif
+
+	//Swap, so the old elements get released by m
+	F32* old = elements;
 	elements = m.elements;
-	m.elements = nullptr;
+	m.elements = old;
 	return *this;
 }
 
@@ -105,6 +153,8 @@ Matrix4::~Matrix4()
 #endif
 }
 
+#endif
+
 Vector4 Matrix4::operator*(const Vector4& v) const
 {
 	Vector4 res;
@@ -220,10 +270,12 @@ void Matrix4::rotate(const Vector3& axis, F32 angle)
 
 	F32 hAng = angle / 2.0f;
 
-	F32 x = axis.x * sinf(hAng);
-	F32 y = axis.y * sinf(hAng);
-	F32 z = axis.z * sinf(hAng);
-	F32 w = cosf(hAng);
+	F32 s, w;
+	Math::trig::sincos(hAng, s, w);
+
+	F32 x = axis.x * s;
+	F32 y = axis.y * s;
+	F32 z = axis.z * s;
 
 
 	m.setElement(0, 0, 1 - 2 * (y * y) - 2 * (z * z)); m.setElement(0, 1, 2 * x * y - 2 * z * w); m.setElement(0, 2, 2 * x * z + 2 * y * w); m.setElement(0, 3, 0);
@@ -238,26 +290,35 @@ void Matrix4::rotate(const Vector3& axis, F32 angle)
 
 void Matrix4::rotateX(F32 angle)
 {
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
 	this->operator*=(Matrix4(1, 0, 0, 0,
-		0, cosf(angle), -sinf(angle), 0,
-		0, sinf(angle), cosf(angle), 0,
+		0, c, -s, 0,
+		0, s, c, 0,
 		0, 0, 0, 1
 		));
 }
 
 void Matrix4::rotateY(F32 angle)
 {
-	this->operator*=(Matrix4(cosf(angle), 0, sinf(angle), 0,
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
+	this->operator*=(Matrix4(c, 0, s, 0,
 		0, 1, 0, 0,
-		-sinf(angle), 0, cosf(angle), 0,
+		-s, 0, c, 0,
 		0, 0, 0, 1
 		));
 }
 
 void Matrix4::rotateZ(F32 angle)
 {
-	this->operator*=(Matrix4(cosf(angle), -sinf(angle), 0, 0,
-		sinf(angle), cosf(angle), 0, 0,
+	F32 s, c;
+	Math::trig::sincos(angle, s, c);
+
+	this->operator*=(Matrix4(c, -s, 0, 0,
+		s, c, 0, 0,
 		0, 0, 1, 0,
 		0, 0, 0, 1
 		));
@@ -338,7 +399,7 @@ void Matrix4::operator*=(F32 f)
 
 void Matrix4::operator*=(const Matrix4& m)
 {
-	*this = *this * m;
+	Math::dispatch::kernels().mat4Mul(elements, m.elements, elements);
 }
 
 Matrix4 Matrix4::operator-() const
@@ -371,175 +432,88 @@ Matrix4 Matrix4::operator*(F32 f) const
 
 Matrix4 Matrix4::operator*(const Matrix4& m) const
 {
-	if (m.isIdentity()) return *this;
-	Matrix4 res;
+	Matrix4 res(NO_INIT);
+	Math::dispatch::kernels().mat4Mul(elements, m.elements, res.elements);
+	return res;
+}
 
-	res.setElement(0, 0, getElement(0, 0) * m[0][0] + getElement(0, 1) * m[1][0] + getElement(0, 2) * m[2][0] + getElement(0, 3) * m[3][0]);
-	res.setElement(1, 0, getElement(1, 0) * m[0][0] + getElement(1, 1) * m[1][0] + getElement(1, 2) * m[2][0] + getElement(1, 3) * m[3][0]);
-	res.setElement(2, 0, getElement(2, 0) * m[0][0] + getElement(2, 1) * m[1][0] + getElement(2, 2) * m[2][0] + getElement(2, 3) * m[3][0]);
-	res.setElement(3, 0, getElement(3, 0) * m[0][0] + getElement(3, 1) * m[1][0] + getElement(3, 2) * m[2][0] + getElement(3, 3) * m[3][0]);
 
-	res.setElement(0, 1, getElement(0, 0) * m[0][1] + getElement(0, 1) * m[1][1] + getElement(0, 2) * m[2][1] + getElement(0, 3) * m[3][1]);
-	res.setElement(1, 1, getElement(1, 0) * m[0][1] + getElement(1, 1) * m[1][1] + getElement(1, 2) * m[2][1] + getElement(1, 3) * m[3][1]);
-	res.setElement(2, 1, getElement(2, 0) * m[0][1] + getElement(2, 1) * m[1][1] + getElement(2, 2) * m[2][1] + getElement(2, 3) * m[3][1]);
-	res.setElement(3, 1, getElement(3, 0) * m[0][1] + getElement(3, 1) * m[1][1] + getElement(3, 2) * m[2][1] + getElement(3, 3) * m[3][1]);
 
-	res.setElement(0, 2, getElement(0, 0) * m[0][2] + getElement(0, 1) * m[1][2] + getElement(0, 2) * m[2][2] + getElement(0, 3) * m[3][2]);
-	res.setElement(1, 2, getElement(1, 0) * m[0][2] + getElement(1, 1) * m[1][2] + getElement(1, 2) * m[2][2] + getElement(1, 3) * m[3][2]);
-	res.setElement(2, 2, getElement(2, 0) * m[0][2] + getElement(2, 1) * m[1][2] + getElement(2, 2) * m[2][2] + getElement(2, 3) * m[3][2]);
-	res.setElement(3, 2, getElement(3, 0) * m[0][2] + getElement(3, 1) * m[1][2] + getElement(3, 2) * m[2][2] + getElement(3, 3) * m[3][2]);
 
-	res.setElement(0, 3, getElement(0, 0) * m[0][3] + getElement(0, 1) * m[1][3] + getElement(0, 2) * m[2][3] + getElement(0, 3) * m[3][3]);
-	res.setElement(1, 3, getElement(1, 0) * m[0][3] + getElement(1, 1) * m[1][3] + getElement(1, 2) * m[2][3] + getElement(1, 3) * m[3][3]);
-	res.setElement(2, 3, getElement(2, 0) * m[0][3] + getElement(2, 1) * m[1][3] + getElement(2, 2) * m[2][3] + getElement(2, 3) * m[3][3]);
-	res.setElement(3, 3, getElement(3, 0) * m[0][3] + getElement(3, 1) * m[1][3] + getElement(3, 2) * m[2][3] + getElement(3, 3) * m[3][3]);
+void Matrix4::invert()
+{
+	*this = inverse();
+}
 
+Matrix4 Matrix4::inverse() const
+{
+	Matrix4 res(NO_INIT);
 
+	if (!Math::dispatch::kernels().mat4Inverse(elements, res.elements)) {
+		Math::mathError("ERROR: Tried to invert singular Matrix4\n");
+		return Matrix4();
+	}
 
 	return res;
+}
 
-
+void Matrix4::invertAffine()
+{
+	*this = inverseAffine();
 }
 
+Matrix4 Matrix4::inverseAffine() const
+{
+	Matrix4 res(NO_INIT);
 
+	if (!Math::kernels::affineInverse(elements, res.elements)) {
+		Math::mathError("ERROR: Tried to invert singular Matrix4\n");
+		return Matrix4();
+	}
 
+	res.elements[12] = 0.f;
+	res.elements[13] = 0.f;
+	res.elements[14] = 0.f;
+	res.elements[15] = 1.f;
 
-void Matrix4::invert()
+	return res;
+}
+
+void Matrix4::invertRigid()
 {
-	*this = inverse();
+	*this = inverseRigid();
 }
 
-Matrix4 Matrix4::inverse() const
+Matrix4 Matrix4::inverseRigid() const
 {
-	F32* inv = new F32[16];
-	F32 det;
-
-
-	inv[0] = elements[5] * elements[10] * elements[15] -
-		elements[5] * elements[11] * elements[14] -
-		elements[9] * elements[6] * elements[15] +
-		elements[9] * elements[7] * elements[14] +
-		elements[13] * elements[6] * elements[11] -
-		elements[13] * elements[7] * elements[10];
-
-	inv[4] = -elements[4] * elements[10] * elements[15] +
-		elements[4] * elements[11] * elements[14] +
-		elements[8] * elements[6] * elements[15] -
-		elements[8] * elements[7] * elements[14] -
-		elements[12] * elements[6] * elements[11] +
-		elements[12] * elements[7] * elements[10];
-
-	inv[8] = elements[4] * elements[9] * elements[15] -
-		elements[4] * elements[11] * elements[13] -
-		elements[8] * elements[5] * elements[15] +
-		elements[8] * elements[7] * elements[13] +
-		elements[12] * elements[5] * elements[11] -
-		elements[12] * elements[7] * elements[9];
-
-	inv[12] = -elements[4] * elements[9] * elements[14] +
-		elements[4] * elements[10] * elements[13] +
-		elements[8] * elements[5] * elements[14] -
-		elements[8] * elements[6] * elements[13] -
-		elements[12] * elements[5] * elements[10] +
-		elements[12] * elements[6] * elements[9];
-
-	inv[1] = -elements[1] * elements[10] * elements[15] +
-		elements[1] * elements[11] * elements[14] +
-		elements[9] * elements[2] * elements[15] -
-		elements[9] * elements[3] * elements[14] -
-		elements[13] * elements[2] * elements[11] +
-		elements[13] * elements[3] * elements[10];
-
-	inv[5] = elements[0] * elements[10] * elements[15] -
-		elements[0] * elements[11] * elements[14] -
-		elements[8] * elements[2] * elements[15] +
-		elements[8] * elements[3] * elements[14] +
-		elements[12] * elements[2] * elements[11] -
-		elements[12] * elements[3] * elements[10];
-
-	inv[9] = -elements[0] * elements[9] * elements[15] +
-		elements[0] * elements[11] * elements[13] +
-		elements[8] * elements[1] * elements[15] -
-		elements[8] * elements[3] * elements[13] -
-		elements[12] * elements[1] * elements[11] +
-		elements[12] * elements[3] * elements[9];
-
-	inv[13] = elements[0] * elements[9] * elements[14] -
-		elements[0] * elements[10] * elements[13] -
-		elements[8] * elements[1] * elements[14] +
-		elements[8] * elements[2] * elements[13] +
-		elements[12] * elements[1] * elements[10] -
-		elements[12] * elements[2] * elements[9];
-
-	inv[2] = elements[1] * elements[6] * elements[15] -
-		elements[1] * elements[7] * elements[14] -
-		elements[5] * elements[2] * elements[15] +
-		elements[5] * elements[3] * elements[14] +
-		elements[13] * elements[2] * elements[7] -
-		elements[13] * elements[3] * elements[6];
-
-	inv[6] = -elements[0] * elements[6] * elements[15] +
-		elements[0] * elements[7] * elements[14] +
-		elements[4] * elements[2] * elements[15] -
-		elements[4] * elements[3] * elements[14] -
-		elements[12] * elements[2] * elements[7] +
-		elements[12] * elements[3] * elements[6];
-
-	inv[10] = elements[0] * elements[5] * elements[15] -
-		elements[0] * elements[7] * elements[13] -
-		elements[4] * elements[1] * elements[15] +
-		elements[4] * elements[3] * elements[13] +
-		elements[12] * elements[1] * elements[7] -
-		elements[12] * elements[3] * elements[5];
-
-	inv[14] = -elements[0] * elements[5] * elements[14] +
-		elements[0] * elements[6] * elements[13] +
-		elements[4] * elements[1] * elements[14] -
-		elements[4] * elements[2] * elements[13] -
-		elements[12] * elements[1] * elements[6] +
-		elements[12] * elements[2] * elements[5];
-
-	inv[3] = -elements[1] * elements[6] * elements[11] +
-		elements[1] * elements[7] * elements[10] +
-		elements[5] * elements[2] * elements[11] -
-		elements[5] * elements[3] * elements[10] -
-		elements[9] * elements[2] * elements[7] +
-		elements[9] * elements[3] * elements[6];
-
-	inv[7] = elements[0] * elements[6] * elements[11] -
-		elements[0] * elements[7] * elements[10] -
-		elements[4] * elements[2] * elements[11] +
-		elements[4] * elements[3] * elements[10] +
-		elements[8] * elements[2] * elements[7] -
-		elements[8] * elements[3] * elements[6];
-
-	inv[11] = -elements[0] * elements[5] * elements[11] +
-		elements[0] * elements[7] * elements[9] +
-		elements[4] * elements[1] * elements[11] -
-		elements[4] * elements[3] * elements[9] -
-		elements[8] * elements[1] * elements[7] +
-		elements[8] * elements[3] * elements[5];
-
-	inv[15] = elements[0] * elements[5] * elements[10] -
-		elements[0] * elements[6] * elements[9] -
-		elements[4] * elements[1] * elements[10] +
-		elements[4] * elements[2] * elements[9] +
-		elements[8] * elements[1] * elements[6] -
-		elements[8] * elements[2] * elements[5];
-
-	det = elements[0] * inv[0] + elements[1] * inv[4] + elements[2] * inv[8] + elements[3] * inv[12];
-
-
-	det = 1.0 / det;
-
-	int i;
-	for (i = 0; i < 16; i++)
-		inv[i] *= det;
-
-	return Matrix4(&inv);
+	const F32* m = elements;
 
+	Matrix4 res(NO_INIT);
+	F32* inv = res.elements;
 
-	
+	//Inverse of a rotation is its transpose
+	inv[0] = m[0];
+	inv[1] = m[4];
+	inv[2] = m[8];
+
+	inv[4] = m[1];
+	inv[5] = m[5];
+	inv[6] = m[9];
+
+	inv[8] = m[2];
+	inv[9] = m[6];
+	inv[10] = m[10];
+
+	inv[3] = -(m[0] * m[3] + m[4] * m[7] + m[8] * m[11]);
+	inv[7] = -(m[1] * m[3] + m[5] * m[7] + m[9] * m[11]);
+	inv[11] = -(m[2] * m[3] + m[6] * m[7] + m[10] * m[11]);
+
+	inv[12] = 0.f;
+	inv[13] = 0.f;
+	inv[14] = 0.f;
+	inv[15] = 1.f;
+
+	return res;
 }
 
 void Matrix4::transpose()
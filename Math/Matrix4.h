@@ -1,6 +1,7 @@
 #pragma once
 #include "MathError.h"
 #include "DataTypedefs.h"
+#include "MathConfig.h"
 
 //Forward-declarations
 
@@ -9,7 +10,7 @@ class Vector3;
 
 //Class that represents 4x4 matrix. All fuctions expect to be used with homogeneous 3d vectors(So you wont be scaling Vector4 with scale()).
 //No own variables nor references
-//TODO: Optimized(private?) constructor that doesn't init to identity. Use for operators where all values will be set
+//With MATH_INLINE_MATRICES the elements are stored inside the object(16-byte aligned), otherwise behind a pointer
 class Matrix4 {
 public:
 	//Inits matrix to identity
@@ -21,9 +22,25 @@ public:
 	//Constructs matrix from F32 array. Copies the array
 	Matrix4(F32* f);
 
-	//Constructs matrix from F32 array. Takes ownership of the pointer, assigns it to null
+	//Constructs matrix from F32 array allocated with new[]. Takes ownership of the pointer, assigns it to null
 	Matrix4(F32** f);
 
+#ifdef MATH_INLINE_MATRICES
+	//Copy constructor
+	Matrix4(const Matrix4& m) = default;
+
+	//Move constructor
+	Matrix4(Matrix4&& m) = default;
+
+	//Assignment operator
+	Matrix4& operator =(const Matrix4& m) = default;
+
+	//Assignment operator
+	Matrix4& operator =(Matrix4&& m) = default;
+
+	//Destructor
+	~Matrix4() = default;
+#else
 	//Copy constructor
 	Matrix4(const Matrix4& m);
 
@@ -38,6 +55,7 @@ public:
 
 	//Destructor
 	~Matrix4();
+#endif
 
 
 	//Matrix multiplication
@@ -76,7 +94,10 @@ public:
 	bool operator !=(const Matrix4& m) const;
 
 	//Returns a pointer to start of row i
-	F32* operator [](U32 i) const { return elements + (i * 4); }
+	F32* operator [](U32 i) { return elements + (i * 4); }
+
+	//Returns a pointer to start of row i
+	const F32* operator [](U32 i) const { return elements + (i * 4); }
 
 	//Matrix-vector multiplication
 	Vector4 operator *(const Vector4& v) const;
@@ -134,9 +155,22 @@ public:
 	//Inverts this matrix
 	void invert();
 
-	//Returns an inverse of this matrix
+	//Returns an inverse of this matrix. Returns identity if the matrix is singular
 	Matrix4 inverse() const;
 
+	//Inverts this matrix, that must have a bottom row of (0, 0, 0, 1)
+	void invertAffine();
+
+	//Returns an inverse of this matrix, that must have a bottom row of (0, 0, 0, 1). Cheaper than inverse().
+	//Returns identity if the matrix is singular
+	Matrix4 inverseAffine() const;
+
+	//Inverts this matrix, that must only rotate and translate
+	void invertRigid();
+
+	//Returns an inverse of this matrix, that must only rotate and translate. Transposes the rotation instead of inverting it
+	Matrix4 inverseRigid() const;
+
 	//Transposes this matrix(Flips rows and columns)
 	void transpose();
 
@@ -162,7 +196,17 @@ public:
 
 
 private:
+	//Tag for the constructor that leaves elements uninitialized
+	enum NoInit { NO_INIT };
+
+	//Allocates elements without initializing them. For operators that set every element
+	explicit Matrix4(NoInit);
+
+#ifdef MATH_INLINE_MATRICES
+	alignas(16) F32 elements[16];
+#else
 	F32* elements;
+#endif
 
 	static const F32 zeroArray[16];
 
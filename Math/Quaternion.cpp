@@ -1,6 +1,8 @@
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Matrix4.h"
+#include "MathFast.h"
+#include "MathKernels.h"
 
 
 void Quaternion::axisAngle(const Vector3& axis, F32 angle)
@@ -8,10 +10,11 @@ void Quaternion::axisAngle(const Vector3& axis, F32 angle)
 
 
 	F32 hAng = angle / 2.f;
-	x = axis.x * sinf(hAng);
-	y = axis.y * sinf(hAng);
-	z = axis.z * sinf(hAng);
-	w = cosf(hAng);
+	F32 s;
+	Math::trig::sincos(hAng, s, w);
+	x = axis.x * s;
+	y = axis.y * s;
+	z = axis.z * s;
 
 
 
@@ -30,8 +33,21 @@ Vector3 Quaternion::operator*(const Vector3& q) const
 	return (res * this->conjugate()).axis();
 }
 
+//v + 2 * qv x (qv x v + w * v), with vector part qv
+Vector3 Quaternion::rotate(const Vector3& v) const
+{
+	const Vector3 qv(x, y, z);
+
+	return v + qv.cross(qv.cross(v) + v * w) * 2.f;
+}
+
 
 
+Quaternion::Quaternion(const Matrix4& m)
+{
+	Math::kernels::mat4ToQuatScalar(m.toArray(), this, 1);
+}
+
 Matrix4 Quaternion::toMatrix() const
 {
 	return Matrix4(1 - 2 * (y * y) - 2 * (z * z), 2 * x * y - 2 * z * w, 2 * x * z + 2 * y * w, 0,
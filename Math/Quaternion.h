@@ -2,6 +2,7 @@
 #include <math.h>
 #include <iostream>
 #include "MathError.h"
+#include "MathSIMD.h"
 #include "DataTypedefs.h"
 
 class Vector3;
@@ -9,9 +10,30 @@ class Matrix4;
 
 //Class that represent Quaternion. It includes 4 F32s, and is intended to represent 3D rotations.
 //Is not child nor has child classes.
+//With MATH_SIMD_VECTORS the F32s share storage with an SSE register, and the arithmetic is done with SIMD instructions.
 class Quaternion {
 public:
 
+#ifdef MATH_SIMD_VECTORS
+	//Constructs an identity Quaternion
+	Quaternion() : xmm(_mm_setr_ps(0.f, 0.f, 0.f, 1.f)) {}
+	Quaternion(F32 x, F32 y, F32 z, F32 w) : xmm(_mm_setr_ps(x, y, z, w)) {}
+
+	//Constructs a Quaternion from an SSE register holding (x, y, z, w)
+	explicit Quaternion(__m128 xmm) : xmm(xmm) {}
+
+	//Constructs a Quaternion that represents rotation of angle around axis
+	Quaternion(const Vector3& axis, F32 angle) : xmm(_mm_setr_ps(0.f, 0.f, 0.f, 1.f)) { axisAngle(axis, angle); }
+
+	//Copy constructor
+	Quaternion(const Quaternion& q) : xmm(q.xmm) {}
+
+	//Assignment operator
+	Quaternion& operator =(const Quaternion& q) {
+		xmm = q.xmm;
+		return *this;
+	}
+#else
 	//Constructs an identity Quaternion
 	Quaternion() { x = y = z = 0; w = 1; }
 	Quaternion(F32 x, F32 y, F32 z, F32 w) { this->x = x; this->y = y; this->z = z; this->w = w; }
@@ -32,6 +54,10 @@ public:
 
 		return *this;
 	}
+#endif
+
+	//Constructs a Quaternion that represents the rotation of m. m must not have scale or shear
+	explicit Quaternion(const Matrix4& m);
 
 	//Destructor
 	~Quaternion() {
@@ -41,12 +67,20 @@ public:
 
 	//Addon operator
 	Quaternion operator +(const Quaternion& q) const {
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(_mm_add_ps(xmm, q.xmm));
+#else
 		return Quaternion(x + q.x, y + q.y, z + q.z, w + q.w);
+#endif
 	}
 
 	//Scaling operator
 	friend Quaternion operator*(F32 f, const Quaternion& q) {
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(_mm_mul_ps(_mm_set1_ps(f), q.xmm));
+#else
 		return Quaternion(f * q.x, f * q.y, f * q.z, f * q.w);
+#endif
 	}
 
 	//Scaling operator
@@ -55,11 +89,18 @@ public:
 			Math::mathError("ERROR: Tried to divide a Quaternion by 0");
 			return Quaternion();
 		}
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(_mm_div_ps(xmm, _mm_set1_ps(f)));
+#else
 		return Quaternion(x / f, y / f, z / f, w / f);
+#endif
 	}
 
 	//Multiplication operator.
 	Quaternion operator *(const Quaternion& q) const {
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(Math::simd::quatMul(xmm, q.xmm));
+#else
 		Quaternion res;
 
 		res.w = q.w * w - q.x * x - q.y * y - q.z * z;
@@ -71,13 +112,16 @@ public:
 		res.z = q.w * z - q.x * y + q.y * x + q.z * w;
 
 		return res;
-
+#endif
 
 	}
 
 	//Multiplication operator, that takes in a vector. Returns a Vector3
 	Vector3 operator *(const Vector3& v) const;
 
+	//Returns v rotated by this Quaternion, which must be normalized. Faster than operator *(const Vector3&)
+	Vector3 rotate(const Vector3& v) const;
+
 	//Multiplication assignment operator
 	void operator *=(const Quaternion& q) {
 		*this = this->operator*(q);
@@ -85,7 +129,11 @@ public:
 
 	//Equality operator. Nothing special here.
 	bool operator ==(const Quaternion& q) const {
+#ifdef MATH_SIMD_VECTORS
+		return Math::simd::equal4(xmm, q.xmm);
+#else
 		return x == q.x && y == q.y && z == q.z && w == q.w;
+#endif
 	}
 
 	//Inverted equality operator. Just what did you expect?
@@ -100,42 +148,59 @@ public:
 
 
 	//Returns the dot product of Quaternion
-	F32 dot(const Quaternion& q) const { return x * q.x + y * q.y + z * q.z + w * q.w; }
+	F32 dot(const Quaternion& q) const {
+#ifdef MATH_SIMD_VECTORS
+		return _mm_cvtss_f32(Math::simd::dot4(xmm, q.xmm));
+#else
+		return x * q.x + y * q.y + z * q.z + w * q.w;
+#endif
+	}
 
 	//Sets Quaternion to represent rotation of angle around axis. Wipes out old values.
 	void axisAngle(const Vector3& axis, F32 angle);
 
 	//Returns the lenght of quaternion. Don't try to think about it too much...
-	inline F32 lenght() const { return sqrtf(x*x + y*y + z*z + w*w); }
+	inline F32 lenght() const { return sqrtf(dot(*this)); }
 
 	//Normalizes Quaternion (divides it's components by it's lenght)
 	inline void normalize() {
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_div_ps(xmm, _mm_sqrt_ps(Math::simd::dot4(xmm, xmm)));
+#else
 		F32 l = lenght();
 
 		x /= l;
 		y /= l;
 		z /= l;
 		w /= l;
-
-
+#endif
 	}
 
 	//Returns normalized version of this Quaternion
 	inline Quaternion normalized() const {
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(_mm_div_ps(xmm, _mm_sqrt_ps(Math::simd::dot4(xmm, xmm))));
+#else
 		F32 l = lenght();
 		return Quaternion(x / l, y / l, z / l, w / l);
+#endif
 	}
 
 	//Returns Vector3(x,y,z)
 	Vector3 axis() const;
 
 	//Returns Conjugate of this Quaternion
-	inline Quaternion conjugate() const { return Quaternion(-x, -y, -z, w); }
+	inline Quaternion conjugate() const {
+#ifdef MATH_SIMD_VECTORS
+		return Quaternion(_mm_xor_ps(xmm, _mm_setr_ps(-0.f, -0.f, -0.f, 0.f)));
+#else
+		return Quaternion(-x, -y, -z, w);
+#endif
+	}
 
 	//Returns the inverse of this Quaternion
 	inline Quaternion inverse() const {
-		F32 len = lenght();
-		return conjugate() / (x*x + y*y + z*z + w*w);
+		return conjugate() / dot(*this);
 	}
 
 	//Returns Quaternions variables as an array
@@ -160,7 +225,14 @@ public:
 	Vector3 getForw() const;
 	Vector3 getBack() const;
 
+#ifdef MATH_SIMD_VECTORS
+	union {
+		struct { F32 x, y, z, w; };
+		__m128 xmm;
+	};
+#else
 	F32 x, y, z, w;
+#endif
 
 
 
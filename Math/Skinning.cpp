@@ -0,0 +1,137 @@
+#include "Skinning.h"
+#include "MathDispatch.h"
+#include "MathParallel.h"
+#include "MathError.h"
+#include <cstring>
+
+static const F32 identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+SkinPalette::SkinPalette()
+{
+
+}
+
+SkinPalette::SkinPalette(U32 boneCount)
+{
+	resize(boneCount);
+}
+
+SkinPalette::SkinPalette(const Matrix4* matrices, U32 count)
+{
+	assign(matrices, count);
+}
+
+void SkinPalette::resize(U32 boneCount)
+{
+	const U32 old = size();
+	columns.resize(size_t(boneCount) * 16);
+
+	for (U32 i = old; i < boneCount; ++i) memcpy(&columns[i * 16], identity, sizeof(F32) * 16);
+}
+
+void SkinPalette::set(U32 bone, const Matrix4& m)
+{
+	set(bone, m.toArray());
+}
+
+void SkinPalette::set(U32 bone, const F32* m)
+{
+	if (bone >= size()) {
+		Math::mathError("ERROR: Tried to set bone outside of SkinPalette\n");
+		return;
+	}
+
+	F32* c = &columns[bone * 16];
+	for (U32 r = 0; r < 4; ++r) {
+		for (U32 col = 0; col < 4; ++col) c[col * 4 + r] = m[r * 4 + col];
+	}
+}
+
+void SkinPalette::assign(const Matrix4* matrices, U32 count)
+{
+	columns.resize(size_t(count) * 16);
+	for (U32 i = 0; i < count; ++i) set(i, matrices[i]);
+}
+
+
+
+namespace Math {
+
+	//Returns false and reports an error if the range or the influences of v are invalid
+	static bool checkSkin(const SkinVertices& v, U32 first, U32 count)
+	{
+		if (v.influences == 0 || v.influences > MAX_SKIN_INFLUENCES) {
+			mathError("ERROR: Skinning needs 1 to 8 influences per vertex\n");
+			return false;
+		}
+
+		if (first > v.count || count > v.count - first) {
+			mathError("ERROR: Skinning range outside of the vertices\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	void skin(const SkinPalette& palette, const SkinVertices& v)
+	{
+		skin(palette, v, 0, v.count);
+	}
+
+	void skin(const SkinPalette& palette, const SkinVertices& v, U32 first, U32 count)
+	{
+		if (!checkSkin(v, first, count) || count == 0) return;
+
+		if (palette.size() == 0) {
+			mathError("ERROR: Skinning with an empty SkinPalette\n");
+			return;
+		}
+
+		const bool normals = v.normals && v.outNormals;
+
+		dispatch::kernels().skin(palette.data(), v.positions + first, normals ? v.normals + first : nullptr,
+			v.bones + size_t(first) * v.influences, v.weights + size_t(first) * v.influences, v.influences,
+			v.outPositions + first, normals ? v.outNormals + first : nullptr, count);
+	}
+
+	void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v)
+	{
+		skin(palette, boneCount, v, 0, v.count);
+	}
+
+	void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v, U32 first, U32 count)
+	{
+		if (!checkSkin(v, first, count) || count == 0) return;
+
+		if (boneCount == 0) {
+			mathError("ERROR: Skinning with an empty palette\n");
+			return;
+		}
+
+		const bool normals = v.normals && v.outNormals;
+
+		dispatch::kernels().skinDualQuat(palette->toArray(), v.positions + first, normals ? v.normals + first : nullptr,
+			v.bones + size_t(first) * v.influences, v.weights + size_t(first) * v.influences, v.influences,
+			v.outPositions + first, normals ? v.outNormals + first : nullptr, count);
+	}
+
+
+	namespace parallel {
+
+		void skin(const SkinPalette& palette, const SkinVertices& v)
+		{
+			if (!checkSkin(v, 0, v.count)) return;
+
+			parallelFor(v.count, SKIN_CHUNK, [&](U32 first, U32 n) { Math::skin(palette, v, first, n); });
+		}
+
+		void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v)
+		{
+			if (!checkSkin(v, 0, v.count)) return;
+
+			parallelFor(v.count, SKIN_CHUNK, [&](U32 first, U32 n) { Math::skin(palette, boneCount, v, first, n); });
+		}
+
+	}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include "DataTypedefs.h"
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "DualQuaternion.h"
+
+//Bone matrices for Math::skin. The matrices are stored transposed, 16 F32s per bone back to back,
+//which is the layout the skinning kernels blend in registers. Fill it once per frame, then skin any amount of vertices.
+class SkinPalette {
+public:
+
+	//Empty palette
+	SkinPalette();
+
+	//Palette of boneCount identity matrices
+	explicit SkinPalette(U32 boneCount);
+
+	//Palette of count bones from matrices
+	SkinPalette(const Matrix4* matrices, U32 count);
+
+
+	//Returns the amount of bones
+	inline U32 size() const { return U32(columns.size() / 16); }
+
+	//Changes the amount of bones. New bones are identity
+	void resize(U32 boneCount);
+
+	//Sets the matrix of bone
+	void set(U32 bone, const Matrix4& m);
+
+	//Sets the matrix of bone from 16 row-major F32s
+	void set(U32 bone, const F32* m);
+
+	//Replaces the bones with count matrices
+	void assign(const Matrix4* matrices, U32 count);
+
+	//Returns the transposed matrices, 16 F32s per bone
+	inline const F32* data() const { return columns.data(); }
+
+private:
+	std::vector<F32> columns;
+};
+
+
+//Vertices to skin and where to write them. Vertex i is influenced by bones bones[i * influences + k] with weights
+//weights[i * influences + k], for k from 0 to influences - 1. Weights of a vertex should sum to 1, unused influences
+//can have weight 0. normals and outNormals may be null if there are no normals.
+//The outputs may be the inputs.
+struct SkinVertices {
+	const Vector3* positions;
+	const Vector3* normals;
+	const U16* bones;
+	const F32* weights;
+	U32 influences;
+
+	Vector3* outPositions;
+	Vector3* outNormals;
+
+	U32 count;
+};
+
+
+namespace Math {
+
+	//Maximum amount of influences per vertex
+	const U32 MAX_SKIN_INFLUENCES = 8;
+
+	//Vertices per chunk of parallel::skin
+	const U32 SKIN_CHUNK = 2048;
+
+	//Linear blend skinning: each vertex is transformed by the weighted sum of its bone matrices.
+	//Normals are transformed by the same matrix without translation and normalized, so bones should not have
+	//non-uniform scale. Bone indices must be less than palette.size()
+	void skin(const SkinPalette& palette, const SkinVertices& v);
+
+	//Skins count vertices of v from first on. Different ranges can be skinned on different threads at the same time
+	void skin(const SkinPalette& palette, const SkinVertices& v, U32 first, U32 count);
+
+	//Dual quaternion skinning: each vertex is transformed by the normalized weighted sum of its bone DualQuaternions.
+	//Unlike blended matrices, the blend stays a rigid transform, so joints twisted far do not collapse. Bones need
+	//no transposed copy, palette holds boneCount normalized DualQuaternions, 8 F32s each. Bone indices must be less than boneCount
+	void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v);
+
+	//Skins count vertices of v from first on with dual quaternions. Different ranges can be skinned on different threads at the same time
+	void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v, U32 first, U32 count);
+
+
+	namespace parallel {
+
+		//Math::skin split into chunks of SKIN_CHUNK vertices on the executor of Math::parallelFor
+		void skin(const SkinPalette& palette, const SkinVertices& v);
+
+		//Math::skin with dual quaternions split into chunks of SKIN_CHUNK vertices on the executor of Math::parallelFor
+		void skin(const DualQuaternion* palette, U32 boneCount, const SkinVertices& v);
+
+	}
+
+}
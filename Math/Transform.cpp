@@ -0,0 +1,85 @@
+#include "Transform.h"
+#include "Matrix4.h"
+#include "MathKernels.h"
+#include <math.h>
+
+static inline Vector3 mulPerAxis(const Vector3& a, const Vector3& b)
+{
+	return Vector3(a.x * b.x, a.y * b.y, a.z * b.z);
+}
+
+
+Transform::Transform(const Matrix4& m)
+{
+	decompose(m.toArray());
+}
+
+Transform::Transform(const Affine3x4& m)
+{
+	decompose(m.toArray());
+}
+
+//The columns of the 3x3 part are the rotated axes scaled by scale. Their lengths give the scale, and the columns divided
+//by them give a rotation matrix. A negative determinant means a mirror, which a rotation can not represent
+void Transform::decompose(const F32* m)
+{
+	translation = Vector3(m[3], m[7], m[11]);
+
+	scale.x = sqrtf(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+	scale.y = sqrtf(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+	scale.z = sqrtf(m[2] * m[2] + m[6] * m[6] + m[10] * m[10]);
+
+	if (scale.x == 0.f || scale.y == 0.f || scale.z == 0.f) {
+		Math::mathError("ERROR: Tried to make a Transform from a matrix with zero scale\n");
+		rotation = Quaternion();
+		return;
+	}
+
+	const F32 det = m[0] * (m[5] * m[10] - m[6] * m[9]) + m[1] * (m[6] * m[8] - m[4] * m[10]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+	if (det < 0.f) scale.x = -scale.x;
+
+	const F32 ix = 1.f / scale.x, iy = 1.f / scale.y, iz = 1.f / scale.z;
+	const F32 r[16] = {
+		m[0] * ix, m[1] * iy, m[2] * iz, 0.f,
+		m[4] * ix, m[5] * iy, m[6] * iz, 0.f,
+		m[8] * ix, m[9] * iy, m[10] * iz, 0.f,
+		0.f, 0.f, 0.f, 1.f
+	};
+
+	Math::kernels::mat4ToQuatScalar(r, &rotation, 1);
+}
+
+Transform Transform::operator *(const Transform& t) const
+{
+	return Transform(rotation * t.rotation, rotation.rotate(mulPerAxis(scale, t.translation)) + translation, mulPerAxis(scale, t.scale));
+}
+
+Transform Transform::inverse() const
+{
+	if (scale.x == 0.f || scale.y == 0.f || scale.z == 0.f) {
+		Math::mathError("ERROR: Tried to invert Transform with zero scale\n");
+		return Transform();
+	}
+
+	const Quaternion r = rotation.conjugate();
+	const Vector3 s(1.f / scale.x, 1.f / scale.y, 1.f / scale.z);
+
+	return Transform(r, mulPerAxis(s, r.rotate(-translation)), s);
+}
+
+Vector3 Transform::transformPoint(const Vector3& p) const
+{
+	return rotation.rotate(mulPerAxis(scale, p)) + translation;
+}
+
+Vector3 Transform::transformDirection(const Vector3& v) const
+{
+	return rotation.rotate(mulPerAxis(scale, v));
+}
+
+Matrix4 Transform::toMatrix() const
+{
+	Matrix4 m;
+	Math::kernels::quatToMat4Scalar(&rotation, &translation, &scale, m.toArray(), 1);
+	return m;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <iostream>
+#include "DataTypedefs.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "Affine3x4.h"
+
+class Matrix4;
+
+//Class that represents an affine transform as its parts: scale, then rotation, then translation.
+//Takes 10 F32s (12 with MATH_SIMD_VECTORS padding), and stays readable and interpolable where a matrix would not.
+//Convert to Affine3x4 or Matrix4 to transform many points.
+class Transform {
+public:
+
+	//Identity
+	Transform() : scale(1.f, 1.f, 1.f) {}
+
+	//Constructs a Transform that scales by scale, then rotates by normalized rotation, then translates by translation
+	Transform(const Quaternion& rotation, const Vector3& translation, const Vector3& scale = Vector3(1.f, 1.f, 1.f))
+		: rotation(rotation), translation(translation), scale(scale) {}
+
+	//Constructs a Transform from the top 3 rows of m. m must not have shear, the bottom row of m is ignored.
+	//A mirroring m gets a negative scale.x
+	explicit Transform(const Matrix4& m);
+
+	//Constructs a Transform from m. m must not have shear. A mirroring m gets a negative scale.x
+	explicit Transform(const Affine3x4& m);
+
+
+	//Composition, applies t first and then this. Exact when the scale of this is uniform,
+	//otherwise the scales are multiplied per axis and the shear a matrix product would have is dropped
+	Transform operator *(const Transform& t) const;
+
+	//Compound composition
+	void operator *=(const Transform& t) {
+		*this = this->operator*(t);
+	}
+
+	//Equality operator
+	bool operator ==(const Transform& t) const {
+		return rotation == t.rotation && translation == t.translation && scale == t.scale;
+	}
+
+	//Inverted equality operator
+	bool operator !=(const Transform& t) const {
+		return !(this->operator==(t));
+	}
+
+
+	//Returns the inverse. Exact when scale is uniform. Returns identity if a component of scale is zero
+	Transform inverse() const;
+
+	//Scales, rotates and translates p
+	Vector3 transformPoint(const Vector3& p) const;
+
+	//Scales and rotates v, translation is ignored
+	Vector3 transformDirection(const Vector3& v) const;
+
+
+	//Returns Affine3x4 that represents the same transform
+	Affine3x4 toAffine() const { return Affine3x4(rotation, translation, scale); }
+
+	//Returns Matrix4 that represents the same transform
+	Matrix4 toMatrix() const;
+
+
+	//Operator for printing Transforms
+	friend std::ostream& operator <<(std::ostream& os, const Transform& t) {
+		os << std::fixed << "Transform: rotation (" << t.rotation.x << ", " << t.rotation.y << ", " << t.rotation.z << ", " << t.rotation.w
+			<< "), translation (" << t.translation.x << ", " << t.translation.y << ", " << t.translation.z
+			<< "), scale (" << t.scale.x << ", " << t.scale.y << ", " << t.scale.z << ")" << std::endl;
+		return os;
+	}
+
+
+	Quaternion rotation;
+	Vector3 translation;
+	Vector3 scale;
+
+private:
+
+	//Sets the parts from 12 row-major F32s, the top 3 rows of a matrix
+	void decompose(const F32* m);
+};
@@ -0,0 +1,279 @@
+#include "TransformHierarchy.h"
+#include "MathDispatch.h"
+#include "MathError.h"
+#include <cstring>
+
+const TransformHierarchy::Node TransformHierarchy::NONE;
+
+static const F32 identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+TransformHierarchy::TransformHierarchy()
+{
+	sorted = true;
+}
+
+TransformHierarchy::TransformHierarchy(U32 capacity)
+{
+	sorted = true;
+	reserve(capacity);
+}
+
+void TransformHierarchy::reserve(U32 capacity)
+{
+	locals.reserve(size_t(capacity) * 16);
+	worlds.reserve(size_t(capacity) * 16);
+	parents.reserve(capacity);
+	depths.reserve(capacity);
+	dirty.reserve(capacity);
+	handles.reserve(capacity);
+	indices.reserve(capacity);
+}
+
+U32 TransformHierarchy::indexOf(Node node) const
+{
+	if (node < indices.size() && indices[node] != NONE) return indices[node];
+
+	Math::mathError("ERROR: Invalid TransformHierarchy node\n");
+	return NONE;
+}
+
+bool TransformHierarchy::contains(Node node) const
+{
+	return node < indices.size() && indices[node] != NONE;
+}
+
+TransformHierarchy::Node TransformHierarchy::add(Node parent)
+{
+	U32 parentIdx = NONE;
+	if (parent != NONE) {
+		parentIdx = indexOf(parent);
+		if (parentIdx == NONE) return NONE;
+	}
+
+	Node node;
+	if (!freeHandles.empty()) {
+		node = freeHandles.back();
+		freeHandles.pop_back();
+	}
+	else {
+		node = Node(indices.size());
+		indices.push_back(NONE);
+	}
+
+	const U32 depth = parentIdx == NONE ? 0 : depths[parentIdx] + 1;
+	if (!depths.empty() && depth < depths.back()) sorted = false;
+
+	indices[node] = size();
+	locals.insert(locals.end(), identity, identity + 16);
+	worlds.insert(worlds.end(), identity, identity + 16);
+	parents.push_back(parentIdx);
+	depths.push_back(depth);
+	dirty.push_back(1);
+	handles.push_back(node);
+
+	return node;
+}
+
+void TransformHierarchy::remove(Node node)
+{
+	const U32 idx = indexOf(node);
+	if (idx == NONE) return;
+
+	//Descendants come after their ancestors only in sorted arrays
+	if (!sorted) sort();
+	const U32 first = indices[node];
+
+	//Walk the nodes from the removed one on, keeping the rest packed. remap[i] is the new index of node i
+	std::vector<U32> remap(size(), NONE);
+	for (U32 i = 0; i < first; ++i) remap[i] = i;
+
+	U32 n = first;
+	for (U32 i = first; i < size(); ++i) {
+		if (i == first || (parents[i] != NONE && remap[parents[i]] == NONE && parents[i] >= first)) {
+			indices[handles[i]] = NONE;
+			freeHandles.push_back(handles[i]);
+			continue;
+		}
+
+		remap[i] = n;
+		memcpy(&locals[n * 16], &locals[i * 16], sizeof(F32) * 16);
+		memcpy(&worlds[n * 16], &worlds[i * 16], sizeof(F32) * 16);
+		parents[n] = parents[i] == NONE ? NONE : remap[parents[i]];
+		depths[n] = depths[i];
+		dirty[n] = dirty[i];
+		handles[n] = handles[i];
+		indices[handles[n]] = n;
+		++n;
+	}
+
+	locals.resize(size_t(n) * 16);
+	worlds.resize(size_t(n) * 16);
+	parents.resize(n);
+	depths.resize(n);
+	dirty.resize(n);
+	handles.resize(n);
+}
+
+void TransformHierarchy::setParent(Node node, Node parent)
+{
+	const U32 idx = indexOf(node);
+	if (idx == NONE) return;
+
+	U32 parentIdx = NONE;
+	if (parent != NONE) {
+		parentIdx = indexOf(parent);
+		if (parentIdx == NONE) return;
+
+		for (U32 p = parentIdx; p != NONE; p = parents[p]) {
+			if (p == idx) {
+				Math::mathError("ERROR: Tried to parent TransformHierarchy node to its own descendant\n");
+				return;
+			}
+		}
+	}
+
+	parents[idx] = parentIdx;
+	dirty[idx] = 1;
+	sorted = false;
+}
+
+TransformHierarchy::Node TransformHierarchy::getParent(Node node) const
+{
+	const U32 idx = indexOf(node);
+	if (idx == NONE || parents[idx] == NONE) return NONE;
+
+	return handles[parents[idx]];
+}
+
+void TransformHierarchy::setLocal(Node node, const Matrix4& m)
+{
+	setLocal(node, m.toArray());
+}
+
+void TransformHierarchy::setLocal(Node node, const F32* m)
+{
+	const U32 idx = indexOf(node);
+	if (idx == NONE) return;
+
+	memcpy(&locals[idx * 16], m, sizeof(F32) * 16);
+	dirty[idx] = 1;
+}
+
+Matrix4 TransformHierarchy::getLocal(Node node) const
+{
+	Matrix4 m;
+
+	const U32 idx = indexOf(node);
+	if (idx != NONE) memcpy(m.toArray(), &locals[idx * 16], sizeof(F32) * 16);
+
+	return m;
+}
+
+Matrix4 TransformHierarchy::getWorld(Node node) const
+{
+	Matrix4 m;
+
+	const U32 idx = indexOf(node);
+	if (idx != NONE) memcpy(m.toArray(), &worlds[idx * 16], sizeof(F32) * 16);
+
+	return m;
+}
+
+const F32* TransformHierarchy::world(Node node) const
+{
+	const U32 idx = indexOf(node);
+	return idx == NONE ? identity : &worlds[idx * 16];
+}
+
+//Depths are recomputed from the parents, then the nodes are counting sorted by depth. The sort is stable,
+//so nodes of the same depth keep their order and the arrays change as little as possible
+void TransformHierarchy::sort()
+{
+	const U32 n = size();
+
+	//Walk up from each node until a node with known depth, then assign depths on the way back down
+	const U32 UNKNOWN = NONE;
+	for (U32 i = 0; i < n; ++i) depths[i] = UNKNOWN;
+
+	std::vector<U32> path;
+	U32 maxDepth = 0;
+	for (U32 i = 0; i < n; ++i) {
+		U32 p = i;
+		while (p != NONE && depths[p] == UNKNOWN) {
+			path.push_back(p);
+			p = parents[p];
+		}
+
+		U32 d = p == NONE ? 0 : depths[p] + 1;
+		while (!path.empty()) {
+			depths[path.back()] = d++;
+			path.pop_back();
+		}
+
+		if (depths[i] > maxDepth) maxDepth = depths[i];
+	}
+
+	std::vector<U32> offsets(maxDepth + 2, 0);
+	for (U32 i = 0; i < n; ++i) ++offsets[depths[i] + 1];
+	for (U32 d = 1; d < offsets.size(); ++d) offsets[d] += offsets[d - 1];
+
+	std::vector<U32> remap(n);
+	for (U32 i = 0; i < n; ++i) remap[i] = offsets[depths[i]]++;
+
+	std::vector<F32> newLocals(locals.size()), newWorlds(worlds.size());
+	std::vector<U32> newParents(n), newDepths(n);
+	std::vector<U8> newDirty(n);
+	std::vector<Node> newHandles(n);
+
+	for (U32 i = 0; i < n; ++i) {
+		const U32 j = remap[i];
+		memcpy(&newLocals[j * 16], &locals[i * 16], sizeof(F32) * 16);
+		memcpy(&newWorlds[j * 16], &worlds[i * 16], sizeof(F32) * 16);
+		newParents[j] = parents[i] == NONE ? NONE : remap[parents[i]];
+		newDepths[j] = depths[i];
+		newDirty[j] = dirty[i];
+		newHandles[j] = handles[i];
+		indices[handles[i]] = j;
+	}
+
+	locals.swap(newLocals);
+	worlds.swap(newWorlds);
+	parents.swap(newParents);
+	depths.swap(newDepths);
+	dirty.swap(newDirty);
+	handles.swap(newHandles);
+
+	sorted = true;
+}
+
+//Roots come first and copy their local matrices. After them, every run of consecutive nodes that are dirty or have
+//a dirty parent is multiplied in one kernel call. A node's dirty flag is set before its children are checked,
+//so changes spread down the tree in one pass
+void TransformHierarchy::update()
+{
+	if (!sorted) sort();
+
+	const U32 n = size();
+	if (n == 0) return;
+
+	U32 i = 0;
+	for (; i < n && parents[i] == NONE; ++i) {
+		if (dirty[i]) memcpy(&worlds[i * 16], &locals[i * 16], sizeof(F32) * 16);
+	}
+
+	const Math::dispatch::Kernels& k = Math::dispatch::kernels();
+
+	while (i < n) {
+		if (!dirty[i] && !dirty[parents[i]]) {
+			++i;
+			continue;
+		}
+
+		const U32 start = i;
+		for (; i < n && (dirty[i] || dirty[parents[i]]); ++i) dirty[i] = 1;
+
+		k.mat4MulIndexed(worlds.data(), &parents[start], &locals[start * 16], &worlds[start * 16], i - start);
+	}
+
+	memset(dirty.data(), 0, n);
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include "DataTypedefs.h"
+#include "Matrix4.h"
+
+//Tree of transforms that computes world matrices from local ones, world = parent world * local.
+//Nodes are stored in flat arrays sorted by depth, so parents always come before their children and one pass
+//in array order updates the whole tree. Only nodes whose local matrix changed, and their descendants, are recomputed.
+//Nodes are referred to by handles, which stay the same when the arrays are reordered.
+class TransformHierarchy {
+public:
+
+	//Handle of a node
+	typedef U32 Node;
+
+	//Parent of root nodes, and the handle add() returns on failure
+	static const Node NONE = 0xFFFFFFFF;
+
+	//Empty hierarchy
+	TransformHierarchy();
+
+	//Empty hierarchy with room for capacity nodes
+	explicit TransformHierarchy(U32 capacity);
+
+
+	//Adds a node with identity local matrix under parent, or a root if parent is NONE. Returns its handle.
+	//Adding in breadth-first order keeps the arrays sorted, otherwise the next update() sorts them
+	Node add(Node parent = NONE);
+
+	//Removes node and all of its descendants. Their handles can be reused by add()
+	void remove(Node node);
+
+	//Moves node and its subtree under parent, or makes it a root if parent is NONE. The arrays are sorted on the next update()
+	void setParent(Node node, Node parent);
+
+	//Returns the parent of node, NONE for roots
+	Node getParent(Node node) const;
+
+	//Returns true if node is a handle of an existing node
+	bool contains(Node node) const;
+
+	//Returns the amount of nodes
+	inline U32 size() const { return U32(parents.size()); }
+
+	//Makes room for capacity nodes
+	void reserve(U32 capacity);
+
+
+	//Sets the local matrix of node
+	void setLocal(Node node, const Matrix4& m);
+
+	//Sets the local matrix of node from 16 row-major F32s
+	void setLocal(Node node, const F32* m);
+
+	//Returns the local matrix of node
+	Matrix4 getLocal(Node node) const;
+
+	//Returns the world matrix of node, as of the last update()
+	Matrix4 getWorld(Node node) const;
+
+	//Returns the world matrix of node as 16 row-major F32s, as of the last update(). Valid until the next update()
+	const F32* world(Node node) const;
+
+
+	//Sorts the arrays if the tree changed, and recomputes the world matrices of changed nodes and their descendants
+	void update();
+
+private:
+
+	//Returns the index of node in the arrays, NONE and a reported error for invalid handles
+	U32 indexOf(Node node) const;
+
+	//Sorts the arrays by depth
+	void sort();
+
+
+	//Per node, in array order. Matrices are 16 row-major F32s each
+	std::vector<F32> locals, worlds;
+
+	//Index of the parent, NONE for roots
+	std::vector<U32> parents;
+
+	//Depth in the tree, 0 for roots
+	std::vector<U32> depths;
+
+	//1 if the local matrix or the parent changed since the last update()
+	std::vector<U8> dirty;
+
+	//Handle of the node
+	std::vector<Node> handles;
+
+
+	//Index of the node of each handle, NONE for free handles
+	std::vector<U32> indices;
+
+	//Handles of removed nodes
+	std::vector<Node> freeHandles;
+
+	//False if the arrays are not sorted by depth
+	bool sorted;
+};
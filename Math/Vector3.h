@@ -2,6 +2,7 @@
 #include "MathError.h"
 #include <iostream>
 #include "DataTypedefs.h"
+#include "MathUtility.h"
 
 //Forward-declarations
 
@@ -77,19 +78,19 @@ public:
 	//Returns the normalized version of this vector
 	inline Vector3 normalized() const
 	{
-		F32 len = sqrtf(x*x + y*y + z*z);
+		F32 inv = Math::rsqrt(x*x + y*y + z*z);
 
-		return Vector3(x * len, y * len, z * len);
+		return Vector3(x * inv, y * inv, z * inv);
 
 	}
 
 	//Normalizes this vector
 	inline void normalize()
 	{
-		F32 len = sqrtf(x*x + y*y + z*z);
-		x /= len;
-		y /= len;
-		z /= len;
+		F32 inv = Math::rsqrt(x*x + y*y + z*z);
+		x *= inv;
+		y *= inv;
+		z *= inv;
 
 	}
 
@@ -0,0 +1,257 @@
+#include "Vector3Stream.h"
+#include "MathDispatch.h"
+#include "MathError.h"
+#include "MathAligned.h"
+#include <cstring>
+
+static F32* allocStream(U32 cap)
+{
+	void* p = Math::alignedMalloc(sizeof(F32) * 3 * size_t(cap), Vector3Stream::ALIGNMENT);
+	if (!p) Math::mathError("ERROR: Out of memory in Vector3Stream\n");
+	return static_cast<F32*>(p);
+}
+
+//Rounds n up to a multiple of 16 F32s (64 bytes)
+static U32 roundCapacity(U32 n)
+{
+	return (n + 15) & ~15u;
+}
+
+
+Vector3Stream::Vector3Stream()
+{
+	data = nullptr;
+	count = cap = 0;
+}
+
+Vector3Stream::Vector3Stream(U32 size)
+{
+	data = nullptr;
+	count = cap = 0;
+	resize(size);
+}
+
+Vector3Stream::Vector3Stream(const Vector3* v, U32 count)
+{
+	data = nullptr;
+	this->count = cap = 0;
+	assign(v, count);
+}
+
+Vector3Stream::Vector3Stream(const std::vector<Vector3>& v)
+{
+	data = nullptr;
+	count = cap = 0;
+	assign(v.data(), U32(v.size()));
+}
+
+Vector3Stream::Vector3Stream(const Vector3Stream& s)
+{
+	data = nullptr;
+	count = cap = 0;
+	*this = s;
+}
+
+Vector3Stream::Vector3Stream(Vector3Stream&& s)
+{
+	data = s.data;
+	count = s.count;
+	cap = s.cap;
+
+	s.data = nullptr;
+	s.count = s.cap = 0;
+}
+
+Vector3Stream::~Vector3Stream()
+{
+	Math::alignedFree(data);
+}
+
+Vector3Stream& Vector3Stream::operator=(const Vector3Stream& s)
+{
+	if (this == &s) return *this;
+
+	count = 0;
+	reserve(s.count);
+	if (s.count > cap) return *this;
+
+	memcpy(x(), s.x(), sizeof(F32) * s.count);
+	memcpy(y(), s.y(), sizeof(F32) * s.count);
+	memcpy(z(), s.z(), sizeof(F32) * s.count);
+	count = s.count;
+
+	return *this;
+}
+
+Vector3Stream& Vector3Stream::operator=(Vector3Stream&& s)
+{
+	if (this == &s) return *this;
+
+	Math::alignedFree(data);
+
+	data = s.data;
+	count = s.count;
+	cap = s.cap;
+
+	s.data = nullptr;
+	s.count = s.cap = 0;
+
+	return *this;
+}
+
+void Vector3Stream::reserve(U32 capacity)
+{
+	if (capacity <= cap) return;
+
+	const U32 newCap = roundCapacity(capacity);
+	F32* newData = allocStream(newCap);
+	if (!newData) return;
+
+	if (count > 0) {
+		memcpy(newData, x(), sizeof(F32) * count);
+		memcpy(newData + newCap, y(), sizeof(F32) * count);
+		memcpy(newData + 2 * newCap, z(), sizeof(F32) * count);
+	}
+
+	Math::alignedFree(data);
+	data = newData;
+	cap = newCap;
+}
+
+void Vector3Stream::resize(U32 size)
+{
+	reserve(size);
+	if (size > cap) return;
+
+	if (size > count) {
+		memset(x() + count, 0, sizeof(F32) * (size - count));
+		memset(y() + count, 0, sizeof(F32) * (size - count));
+		memset(z() + count, 0, sizeof(F32) * (size - count));
+	}
+
+	count = size;
+}
+
+void Vector3Stream::push_back(const Vector3& v)
+{
+	if (count == cap) {
+		reserve(cap < 16 ? 16 : cap * 2);
+		if (count == cap) return;
+	}
+
+	set(count++, v);
+}
+
+void Vector3Stream::assign(const Vector3* v, U32 count)
+{
+	this->count = 0;
+	reserve(count);
+	if (count > cap) return;
+
+	F32* px = x();
+	F32* py = y();
+	F32* pz = z();
+
+	for (U32 i = 0; i < count; ++i) {
+		px[i] = v[i].x;
+		py[i] = v[i].y;
+		pz[i] = v[i].z;
+	}
+
+	this->count = count;
+}
+
+void Vector3Stream::toArray(Vector3* out) const
+{
+	const F32* px = x();
+	const F32* py = y();
+	const F32* pz = z();
+
+	for (U32 i = 0; i < count; ++i) {
+		out[i].x = px[i];
+		out[i].y = py[i];
+		out[i].z = pz[i];
+	}
+}
+
+std::vector<Vector3> Vector3Stream::toVector() const
+{
+	std::vector<Vector3> v(count);
+	toArray(v.data());
+	return v;
+}
+
+
+
+namespace Math {
+
+	//Returns false and reports an error if a and b have different sizes
+	static bool sameSize(const Vector3Stream& a, const Vector3Stream& b)
+	{
+		if (a.size() == b.size()) return true;
+
+		mathError("ERROR: Vector3Streams of different sizes\n");
+		return false;
+	}
+
+	void add(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out)
+	{
+		if (!sameSize(a, b)) return;
+
+		out.resize(a.size());
+
+		const dispatch::Kernels& k = dispatch::kernels();
+		k.soaAdd(a.x(), b.x(), out.x(), a.size());
+		k.soaAdd(a.y(), b.y(), out.y(), a.size());
+		k.soaAdd(a.z(), b.z(), out.z(), a.size());
+	}
+
+	void scale(const Vector3Stream& a, F32 s, Vector3Stream& out)
+	{
+		out.resize(a.size());
+
+		const dispatch::Kernels& k = dispatch::kernels();
+		k.soaScale(a.x(), s, out.x(), a.size());
+		k.soaScale(a.y(), s, out.y(), a.size());
+		k.soaScale(a.z(), s, out.z(), a.size());
+	}
+
+	void lerp(const Vector3Stream& a, const Vector3Stream& b, F32 t, Vector3Stream& out)
+	{
+		if (!sameSize(a, b)) return;
+
+		out.resize(a.size());
+		t = clamp(t, 0.f, 1.f);
+
+		const dispatch::Kernels& k = dispatch::kernels();
+		k.soaLerp(a.x(), b.x(), t, out.x(), a.size());
+		k.soaLerp(a.y(), b.y(), t, out.y(), a.size());
+		k.soaLerp(a.z(), b.z(), t, out.z(), a.size());
+	}
+
+	void cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out)
+	{
+		if (!sameSize(a, b)) return;
+
+		out.resize(a.size());
+		dispatch::kernels().soaCross3(a.x(), a.y(), a.z(), b.x(), b.y(), b.z(), out.x(), out.y(), out.z(), a.size());
+	}
+
+	void dot(const Vector3Stream& a, const Vector3Stream& b, F32* out)
+	{
+		if (!sameSize(a, b)) return;
+
+		dispatch::kernels().soaDot3(a.x(), a.y(), a.z(), b.x(), b.y(), b.z(), out, a.size());
+	}
+
+	void lenght2(const Vector3Stream& v, F32* out)
+	{
+		dispatch::kernels().soaDot3(v.x(), v.y(), v.z(), v.x(), v.y(), v.z(), out, v.size());
+	}
+
+	void normalize(Vector3Stream& v)
+	{
+		dispatch::kernels().soaNormalize3(v.x(), v.y(), v.z(), v.size());
+	}
+
+}
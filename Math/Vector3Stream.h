@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include "DataTypedefs.h"
+#include "Vector3.h"
+
+//Growable array of Vector3s stored as structure of arrays: x, y and z are separate arrays of F32s, each 64-byte aligned.
+//The batch operations below work on whole streams and run 8 vectors at a time on AVX2 CPUs (see MathDispatch.h).
+//Growing the stream reallocates, which invalidates the pointers returned by x(), y() and z().
+class Vector3Stream {
+public:
+
+	//Alignment of the x, y and z arrays in bytes
+	static const U32 ALIGNMENT = 64;
+
+	//Empty stream
+	Vector3Stream();
+
+	//Stream of size zero vectors
+	explicit Vector3Stream(U32 size);
+
+	//Copies count Vector3s from v
+	Vector3Stream(const Vector3* v, U32 count);
+
+	//Copies the Vector3s of v
+	explicit Vector3Stream(const std::vector<Vector3>& v);
+
+	//Copy constructor
+	Vector3Stream(const Vector3Stream& s);
+
+	//Move constructor
+	Vector3Stream(Vector3Stream&& s);
+
+	~Vector3Stream();
+
+	//Copy assignment operator
+	Vector3Stream& operator=(const Vector3Stream& s);
+
+	//Move assignment operator
+	Vector3Stream& operator=(Vector3Stream&& s);
+
+
+	//Returns the amount of vectors
+	inline U32 size() const { return count; }
+
+	//Returns the amount of vectors that fit without reallocating
+	inline U32 capacity() const { return cap; }
+
+	//Returns true if there are no vectors
+	inline bool empty() const { return count == 0; }
+
+	//Makes room for at least capacity vectors
+	void reserve(U32 capacity);
+
+	//Changes the amount of vectors. New vectors are zero
+	void resize(U32 size);
+
+	//Removes all vectors, keeps the memory
+	inline void clear() { count = 0; }
+
+	//Adds v to the end
+	void push_back(const Vector3& v);
+
+
+	//Returns vector i
+	inline Vector3 get(U32 i) const { return Vector3(data[i], data[cap + i], data[2 * cap + i]); }
+
+	//Sets vector i to v
+	inline void set(U32 i, const Vector3& v) { data[i] = v.x; data[cap + i] = v.y; data[2 * cap + i] = v.z; }
+
+	//Returns the x, y or z components of all vectors. Null if the stream has never held vectors
+	inline F32* x() { return data; }
+	inline F32* y() { return data + cap; }
+	inline F32* z() { return data + 2 * cap; }
+	inline const F32* x() const { return data; }
+	inline const F32* y() const { return data + cap; }
+	inline const F32* z() const { return data + 2 * cap; }
+
+
+	//Replaces the contents with count Vector3s from v
+	void assign(const Vector3* v, U32 count);
+
+	//Writes the vectors to out, which must have room for size() Vector3s
+	void toArray(Vector3* out) const;
+
+	//Returns the vectors as std::vector
+	std::vector<Vector3> toVector() const;
+
+private:
+	//x, y and z arrays of cap F32s back to back in one block. cap is a multiple of 16, so all three stay 64-byte aligned
+	F32* data;
+	U32 count, cap;
+};
+
+
+//Batch operations on Vector3Streams. Element i of the result is computed from elements i of the inputs.
+//Inputs must have the same size, out is resized to it and may be one of the inputs.
+namespace Math {
+
+	//out[i] = a[i] + b[i]
+	void add(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out);
+
+	//out[i] = a[i] * s
+	void scale(const Vector3Stream& a, F32 s, Vector3Stream& out);
+
+	//out[i] = lerp(a[i], b[i], t), t is clamped between 0 and 1
+	void lerp(const Vector3Stream& a, const Vector3Stream& b, F32 t, Vector3Stream& out);
+
+	//Cross products, out[i] = a[i].cross(b[i])
+	void cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out);
+
+	//Dot products to out, which must have room for a.size() F32s
+	void dot(const Vector3Stream& a, const Vector3Stream& b, F32* out);
+
+	//Lengths squared to out, which must have room for v.size() F32s
+	void lenght2(const Vector3Stream& v, F32* out);
+
+	//Normalizes all vectors of v. Uses Math::rsqrt, relative error up to 2.7e-7
+	void normalize(Vector3Stream& v);
+
+}
@@ -6,17 +6,29 @@
 
 Vector4::Vector4()
 {
-
+#ifdef MATH_SIMD_VECTORS
+	xmm = _mm_setzero_ps();
+#else
+	x = y = z = w = 0;
+#endif
 }
 
 Vector4::Vector4(F32 defValue)
 {
+#ifdef MATH_SIMD_VECTORS
+	xmm = _mm_set1_ps(defValue);
+#else
 	x = y = z = w = defValue;
+#endif
 }
 
 Vector4::Vector4(F32 x, F32 y, F32 z, F32 w)
 {
+#ifdef MATH_SIMD_VECTORS
+	xmm = _mm_setr_ps(x, y, z, w);
+#else
 	this->x = x; this->y = y; this->z = z; this->w = w;
+#endif
 }
 
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "MathError.h"
+#include "MathSIMD.h"
 #include "DataTypedefs.h"
 
 //Forward-declarations
@@ -9,9 +10,20 @@ class Vector3;
 
 
 //Class that represents 4-dimensional vector. Contains 4 F32s.
+//With MATH_SIMD_VECTORS the F32s share storage with an SSE register, and the arithmetic is done with SIMD instructions.
 class Vector4 {
 public:
+#ifdef MATH_SIMD_VECTORS
+	union {
+		struct { F32 x, y, z, w; };
+		__m128 xmm;
+	};
+
+	//Constructs vector from an SSE register holding (x, y, z, w)
+	explicit Vector4(__m128 xmm) : xmm(xmm) {}
+#else
 	F32 x, y, z, w;
+#endif
 
 	//Inits zero vector
 	Vector4();
@@ -59,63 +71,95 @@ public:
 	//Returns the dot product between two vectors
 	inline F32 dot(const Vector4& v) const
 	{
+#ifdef MATH_SIMD_VECTORS
+		return _mm_cvtss_f32(Math::simd::dot4(xmm, v.xmm));
+#else
 		return x*v.x + y*v.y + z*v.z + w*v.w;
+#endif
 	}
 
 	//Returns the length of the vector. Has square root in it, use lenght2 when possible
 	inline F32 lenght() const
 	{
-		return sqrtf(x*x + y*y + z*z + w*w);
+		return sqrtf(lenght2());
 	}
 
 	//Returns the length squared. Cheaper that lenght()
 	inline F32 lenght2() const
 	{
+#ifdef MATH_SIMD_VECTORS
+		return _mm_cvtss_f32(Math::simd::dot4(xmm, xmm));
+#else
 		return x*x + y*y + z*z + w*w;
+#endif
 	}
 
 	//Returns the normalized version of this vector
 	inline Vector4 normalized() const
 	{
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_div_ps(xmm, _mm_sqrt_ps(Math::simd::dot4(xmm, xmm))));
+#else
 		F32 len = lenght();
 
 		return Vector4(x / len, y / len, z / len, w / len);
+#endif
 	}
 
 	//Normalizes this vector
 	inline void normalize()
 	{
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_div_ps(xmm, _mm_sqrt_ps(Math::simd::dot4(xmm, xmm)));
+#else
 		F32 len = lenght();
 
 		x /= len;
 		y /= len;
 		z /= len;
 		w /= len;
+#endif
 	}
 
 	//Returns true if all elements in this vector are 0
 	inline bool isZero() const
 	{
+#ifdef MATH_SIMD_VECTORS
+		return Math::simd::equal4(xmm, _mm_setzero_ps());
+#else
 		return w == 0 && x == 0 && y == 0 && z == 0;
+#endif
 	}
 
 
 	//Addition operator
 	inline Vector4 operator +(const Vector4& v) const
 	{
-		Vector4(x + v.x, y + v.y, z + v.z, w + v.w);
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_add_ps(xmm, v.xmm));
+#else
+		return Vector4(x + v.x, y + v.y, z + v.z, w + v.w);
+#endif
 	}
 
 	//Subtraction operator
 	inline Vector4 operator -(const Vector4& v) const
 	{
-		Vector4(x - v.x, y - v.y, z - v.z, w - v.w);
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_sub_ps(xmm, v.xmm));
+#else
+		return Vector4(x - v.x, y - v.y, z - v.z, w - v.w);
+#endif
 	}
 
 	//Scaling operator
 	inline Vector4 operator *(F32 f) const
 	{
-		Vector4(x * f, y * f, z * f, w * f);
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_mul_ps(xmm, _mm_set1_ps(f)));
+#else
+		return Vector4(x * f, y * f, z * f, w * f);
+#endif
 	}
 
 	//Scaling with division
@@ -125,34 +169,50 @@ public:
 			Math::mathError("ERROR: Tried to divide Vector4 by 0\n");
 			return Vector4();
 		}
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_div_ps(xmm, _mm_set1_ps(f)));
+#else
 		return Vector4(x / f, y / f, z / f, w / f);
+#endif
 	}
 
 	//Compound addition
 	inline void operator +=(const Vector4& v)
 	{
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_add_ps(xmm, v.xmm);
+#else
 		x += v.x;
 		y += v.y;
 		z += v.z;
 		w += v.w;
+#endif
 	}
 
 	//Compound subtraction
 	inline void operator -=(const Vector4& v)
 	{
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_sub_ps(xmm, v.xmm);
+#else
 		x -= v.x;
 		y -= v.y;
 		z -= v.z;
 		w -= v.w;
+#endif
 	}
 
 	//Compound scaling
 	inline void operator *=(F32 f)
 	{
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_mul_ps(xmm, _mm_set1_ps(f));
+#else
 		x *= f;
 		y *= f;
 		z *= f;
 		w *= f;
+#endif
 	}
 
 	//Compound scaling with division
@@ -163,22 +223,30 @@ public:
 			return;
 		}
 
+#ifdef MATH_SIMD_VECTORS
+		xmm = _mm_div_ps(xmm, _mm_set1_ps(f));
+#else
 		x /= f;
 		y /= f;
 		z /= f;
 		w /= f;
+#endif
 	}
 
 	//Comparison operator
 	inline bool operator ==(const Vector4& v) const
 	{
-		return x == v.x && y == v.z && z == v.z && w == v.w;
+#ifdef MATH_SIMD_VECTORS
+		return Math::simd::equal4(xmm, v.xmm);
+#else
+		return x == v.x && y == v.y && z == v.z && w == v.w;
+#endif
 	}
 
 	//Inverted comparison operator
 	inline bool operator !=(const Vector4& v) const
 	{
-		return x != v.x || y != v.y || z != v.z || w != v.w;
+		return !(*this == v);
 	}
 
 	//Returns a reference to the specified element
@@ -199,7 +267,11 @@ public:
 
 	//Inversion operator
 	inline Vector4 operator -() const {
+#ifdef MATH_SIMD_VECTORS
+		return Vector4(_mm_xor_ps(xmm, _mm_set1_ps(-0.f)));
+#else
 		return Vector4(-x, -y, -z, -w);
+#endif
 	}
 
 	//Returns an array containing all the elements
@@ -1,21 +1,53 @@
 #pragma once
 
+#include <cstring>
 #include "MathError.h"
 #include "DataTypedefs.h"
 
+//Class that represents t-dimensional vector. Contains t F32s stored inside the object, so it is trivially copyable and never allocates.
+//Loops work on the raw array with fixed trip counts, so the compiler unrolls and vectorizes them.
 template<U32 t>
 class VectorT {
 private:
-	F32* elements;
+	F32 elements[t];
 
-public:
+	//Amount of partial sums in reductions. Independent sums let dot() and lenght2() run in SIMD lanes.
+	static const U32 LANES = 8;
+
+	//Returns sum of a[i] * b[i]
+	static F32 sumOfProducts(const F32* a, const F32* b)
+	{
+		F32 sums[LANES] = {};
+
+		U32 i = 0;
+		for (; i + LANES <= t; i += LANES) {
+			for (U32 l = 0; l < LANES; ++l) {
+				sums[l] += a[i + l] * b[i + l];
+			}
+		}
 
-	VectorT() {
-		elements = new F32[t];
+		for (; i < t; ++i) {
+			sums[0] += a[i] * b[i];
+		}
+
+		F32 sum = 0.f;
+		for (U32 l = 0; l < LANES; ++l) {
+			sum += sums[l];
+		}
+		return sum;
 	}
 
-	~VectorT() {
-		delete[] elements;
+public:
+
+	//Elements are left uninitialized
+	VectorT() = default;
+
+	//Inits all elements to default value
+	explicit VectorT(F32 defValue)
+	{
+		for (U32 i = 0; i < t; ++i) {
+			elements[i] = defValue;
+		}
 	}
 
 	F32 getElement(U32 i) const
@@ -43,50 +75,35 @@ public:
 
 	F32 dot(const VectorT<t>& v) const
 	{
-		F32 dot = 0.f;
-		for (U32 i = 0; i < t; ++i) {
-			dot += getElement(i) * v.getElement(i);
-		}
-
-		return dot;
+		return sumOfProducts(elements, v.elements);
 	}
 
 	F32 lenght() const
 	{
-		F32 l2 = 0.f;
-
-		for (U32 i = 0; i < t; ++i) {
-			l2 += getElement(i) * getElement(i);
-		}
-		return sqrtf(l2);
+		return sqrtf(sumOfProducts(elements, elements));
 	}
 
 	F32 lenght2() const
 	{
-		F32 l2 = 0.f;
-
-		for (U32 i = 0; i < t; ++i) {
-			l2 += getElement(i) * getElement(i);
-		}
-		return l2;
+		return sumOfProducts(elements, elements);
 	}
 
 	VectorT<t> normalized() const
 	{
-		const F32 len = lenght();
+		const F32 inv = 1.f / lenght();
 		VectorT<t> res;
 		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, getElement(i) / len);
+			res.elements[i] = elements[i] * inv;
 		}
 		return res;
 	}
 
 	void normalize()
 	{
-		const F32 len = lenght();
-		
+		const F32 inv = 1.f / lenght();
+
 		for (U32 i = 0; i < t; ++i) {
-			setElement(i, getElement(i) / len);
+			elements[i] *= inv;
 		}
 
 	}
@@ -94,7 +111,7 @@ public:
 	bool isZero() const
 	{
 		for (U32 i = 0; i < t; ++i) {
-			if (getElement(i) != 0) return false;
+			if (elements[i] != 0) return false;
 		}
 		return true;
 	}
@@ -103,7 +120,7 @@ public:
 	{
 		VectorT<t> res;
 		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, getElement(i) + v.getElement());
+			res.elements[i] = elements[i] + v.elements[i];
 		}
 		return res;
 
@@ -115,7 +132,7 @@ public:
 
 		VectorT<t> res;
 		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, getElement(i) - v.getElement());
+			res.elements[i] = elements[i] - v.elements[i];
 		}
 		return res;
 	}
@@ -124,7 +141,7 @@ public:
 	{
 		VectorT<t> res;
 		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, getElement(i) * f);
+			res.elements[i] = elements[i] * f;
 		}
 		return res;
 	}
@@ -134,21 +151,17 @@ public:
 
 		if (f == 0.f) {
 			Math::mathError("ERROR: Tried to divide VectorT by 0\n");
-			return VectorT<t>();
+			return VectorT<t>(0.f);
 		}
 
-		VectorT<t> res;
-		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, getElement(i) * f);
-		}
-		return res;
+		return *this * (1.f / f);
 	}
 
 	VectorT<t> operator -() const
 	{
 		VectorT<t> res;
 		for (U32 i = 0; i < t; ++i) {
-			res.setElement(i, -getElement(i));
+			res.elements[i] = -elements[i];
 		}
 		return res;
 	}
@@ -156,21 +169,21 @@ public:
 	void operator +=(const VectorT<t>& v)
 	{
 		for (U32 i = 0; i < t; ++i) {
-			setElement(i, getElement(i) + v.getElement(i));
+			elements[i] += v.elements[i];
 		}
 	}
 
 	void operator -=(const VectorT<t>& v)
 	{
 		for (U32 i = 0; i < t; ++i) {
-			setElement(i, getElement(i) - v.getElement(i));
+			elements[i] -= v.elements[i];
 		}
 	}
 
 	void operator *=(F32 f)
 	{
 		for (U32 i = 0; i < t; ++i) {
-			setElement(i, getElement(i) * f);
+			elements[i] *= f;
 		}
 	}
 
@@ -182,9 +195,7 @@ public:
 			return;
 		}
 
-		for (U32 i = 0; i < t; ++i) {
-			setElement(i, getElement(i) / f);
-		}
+		*this *= 1.f / f;
 	}
 
 	bool operator ==(const VectorT<t>& v) const
@@ -194,19 +205,26 @@ public:
 
 	bool operator !=(const VectorT<t>& v) const
 	{
-		return return memcmp(elements, v.elements, t * sizeof(F32)) != 0;;
+		return memcmp(elements, v.elements, t * sizeof(F32)) != 0;
 	}
 
 	F32& operator [](U32 i)
 	{
 		if (i >= t) {
 			Math::mathError("ERROR: Tried to get reference to element greater than t in VectorT\n");
-			return 0.f;
+			static F32 invalid;
+			invalid = 0.f;
+			return invalid;
 		}
 
 		return elements[i];
 	}
 
+	F32 operator [](U32 i) const
+	{
+		return getElement(i);
+	}
+
 	const F32* toArray() const
 	{
 		return elements;
@@ -222,9 +240,9 @@ public:
 
 	}
 
-	friend std::ostream& operator <<(std::ostream& os, const Vector4& v) {
+	friend std::ostream& operator <<(std::ostream& os, const VectorT<t>& v) {
 		os << std::fixed << "VectorT" << "<" << v.getNumElements() << ">: (";
-		for (int i = 0; i < (v.getNumElements() - 1); ++i) {
+		for (U32 i = 0; i < (v.getNumElements() - 1); ++i) {
 			os << v.elements[i] << ", ";
 		}
 
@@ -0,0 +1,10 @@
+#pragma once
+#include "DataTypedefs.h"
+
+//Test groups run by main.cpp. Each prints its checks and returns the amount that failed
+
+U32 rsqrtTests();
+
+U32 arenaTests();
+
+U32 expressionTests();
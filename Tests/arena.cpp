@@ -0,0 +1,126 @@
+#include "Tests.h"
+#include "Matrix4.h"
+#include "Matrix3.h"
+#include "MathMemoryManager.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//Matrices that get the elements of arena matrices by assignment, move or swap must keep them after the arena is reset
+//and its memory reused.
+
+static U32 failures = 0;
+
+static void check(const char* name, bool ok)
+{
+	if (!ok) ++failures;
+
+	printf("%-4s %s\n", ok ? "ok" : "FAIL", name);
+}
+
+#ifdef MATH_CUSTOM_MEMORY
+
+static Matrix4 testMatrix4(F32 first)
+{
+	Matrix4 m;
+	for (U32 i = 0; i < 16; ++i) m.toArray()[i] = first + F32(i);
+	return m;
+}
+
+static Matrix3 testMatrix3(F32 first)
+{
+	Matrix3 m;
+	for (U32 i = 0; i < 9; ++i) m.toArray()[i] = first + F32(i);
+	return m;
+}
+
+//Resets the arena and overwrites its memory with new matrices
+static void reuse(MathArena& arena)
+{
+	arena.reset();
+
+	MathArenaScope scope(arena);
+	for (U32 i = 0; i < 8; ++i) {
+		Matrix4 m4 = testMatrix4(-100.f);
+		Matrix3 m3 = testMatrix3(-100.f);
+	}
+}
+
+static bool equal(const Matrix4& a, const Matrix4& b)
+{
+	return memcmp(a.toArray(), b.toArray(), sizeof(F32) * 16) == 0;
+}
+
+static bool equal(const Matrix3& a, const Matrix3& b)
+{
+	return memcmp(a.toArray(), b.toArray(), sizeof(F32) * 9) == 0;
+}
+
+U32 arenaTests()
+{
+	MathArena arena;
+
+	const Matrix4 a = testMatrix4(1.f);
+	const Matrix4 b = testMatrix4(20.f);
+	const Matrix4 product = a * b;
+
+	{
+		Matrix4 keep;
+		{
+			MathArenaScope scope(arena);
+			keep = a * b;
+		}
+		reuse(arena);
+		check("Matrix4 move-assigned inside a scope", equal(keep, product) && !MathMemoryManager::isArenaBlock(keep.toArray()));
+	}
+
+	{
+		std::vector<Matrix4> kept;
+		{
+			MathArenaScope scope(arena);
+			kept.push_back(a * b);
+		}
+		reuse(arena);
+		check("Matrix4 moved into a vector inside a scope", equal(kept[0], product) && !MathMemoryManager::isArenaBlock(kept[0].toArray()));
+	}
+
+	{
+		//std::swap move-constructs a temporary from pooled, leaving it without elements, then move-assigns scratch to it
+		Matrix4 pooled = a;
+		{
+			MathArenaScope scope(arena);
+			Matrix4 scratch = b;
+			std::swap(pooled, scratch);
+			check("Matrix4 swapped with an arena matrix", equal(pooled, b) && equal(scratch, a));
+		}
+		reuse(arena);
+		check("Matrix4 swapped inside a scope", equal(pooled, b) && !MathMemoryManager::isArenaBlock(pooled.toArray()));
+	}
+
+	{
+		const Matrix3 c = testMatrix3(1.f);
+		const Matrix3 d = testMatrix3(20.f);
+
+		Matrix3 pooled = c;
+		{
+			MathArenaScope scope(arena);
+			Matrix3 scratch = d;
+			std::swap(pooled, scratch);
+			check("Matrix3 swapped with an arena matrix", equal(pooled, d) && equal(scratch, c));
+		}
+		reuse(arena);
+		check("Matrix3 swapped inside a scope", equal(pooled, d) && !MathMemoryManager::isArenaBlock(pooled.toArray()));
+	}
+
+	return failures;
+}
+
+#else
+
+U32 arenaTests()
+{
+	return failures;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "Tests.h"
+#include "MathExpression.h"
+#include <cstdio>
+
+//Matrix products of expressions must match the eager operators, also when assigned to one of their operands.
+
+static U32 failures = 0;
+
+static void check(const char* name, const F32* value, const F32* expected, U32 size)
+{
+	F32 worst = 0.f;
+	for (U32 i = 0; i < size; ++i) {
+		const F32 e = fabsf(value[i] - expected[i]) / fmaxf(1.f, fabsf(expected[i]));
+		if (e > worst) worst = e;
+	}
+
+	//Kernels may use FMA and a different order of additions
+	const bool ok = worst <= 1e-5f;
+	if (!ok) ++failures;
+
+	printf("%-4s %-34s max relative error %.3g\n", ok ? "ok" : "FAIL", name, worst);
+}
+
+template<class T>
+static T testMatrix(F32 first)
+{
+	T m;
+	for (U32 i = 0; i < Math::expression::Traits<T>::SIZE; ++i) m.toArray()[i] = first + F32(i) * 0.25f - F32(i * i) * 0.03f;
+	return m;
+}
+
+template<class T>
+static void testProducts(const char* type)
+{
+	const U32 size = Math::expression::Traits<T>::SIZE;
+	char name[64];
+
+	const T a = testMatrix<T>(1.f);
+	const T b = testMatrix<T>(-2.f);
+
+	const T ab = a * b;
+	const T aba = ab * a;
+
+	T c;
+	(Math::expr(a) * b).assignTo(c);
+	snprintf(name, sizeof(name), "%s a * b", type);
+	check(name, c.toArray(), ab.toArray(), size);
+
+	c = Math::expr(a) * b * a;
+	snprintf(name, sizeof(name), "%s a * b * a", type);
+	check(name, c.toArray(), aba.toArray(), size);
+
+	c = a;
+	(Math::expr(c) * b).assignTo(c);
+	snprintf(name, sizeof(name), "%s c = c * b", type);
+	check(name, c.toArray(), ab.toArray(), size);
+
+	c = b;
+	(Math::expr(a) * c).assignTo(c);
+	snprintf(name, sizeof(name), "%s c = a * c", type);
+	check(name, c.toArray(), ab.toArray(), size);
+
+	const T sum = (a + b) * (a - b);
+	c = (Math::expr(a) + b) * (Math::expr(a) - b);
+	snprintf(name, sizeof(name), "%s (a + b) * (a - b)", type);
+	check(name, c.toArray(), sum.toArray(), size);
+}
+
+U32 expressionTests()
+{
+	using namespace Math::dispatch;
+
+	for (U32 t = SCALAR; t <= U32(detectedTier()); ++t) {
+		setTier(Tier(t));
+
+		char type[32];
+		snprintf(type, sizeof(type), "%s Matrix4", tierName(Tier(t)));
+		testProducts<Matrix4>(type);
+	}
+
+	testProducts<Matrix3>("Matrix3");
+
+	return failures;
+}
@@ -0,0 +1,23 @@
+#include "Tests.h"
+#include "MathMemoryManager.h"
+#include <cstdio>
+
+//Runs all test groups. Returns 0 if every check passed, otherwise 1
+int main()
+{
+#ifdef MATH_CUSTOM_MEMORY
+	MathMemoryManager::init(64, 64, 64, 64);
+#endif
+
+	U32 failures = 0;
+	failures += rsqrtTests();
+	failures += arenaTests();
+	failures += expressionTests();
+
+#ifdef MATH_CUSTOM_MEMORY
+	MathMemoryManager::free();
+#endif
+
+	if (failures) printf("%u checks failed\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include "Tests.h"
+#include "MathUtility.h"
+#include "MathSIMD.h"
+#include "MathBatch.h"
+#include "MathDispatch.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//Accuracy of Math::rsqrt, simd::rsqrt and the batch normalize kernels of every tier against 1 / sqrt in double.
+//Inputs sweep from FLT_MIN (next to the subnormals) to FLT_MAX. Everything must be within the documented
+//relative error of 2.7e-7.
+
+static const F64 bound = 2.7e-7;
+
+static U32 failures = 0;
+
+//Checks that the worst error of a test is within bound, prints the result
+static void check(const char* name, F64 worstError, F64 worstInput)
+{
+	const bool ok = worstError <= bound;
+	if (!ok) ++failures;
+
+	printf("%-4s %-28s max relative error %.3g (input %g)\n", ok ? "ok" : "FAIL", name, worstError, worstInput);
+}
+
+static F64 relativeError(F64 value, F64 reference)
+{
+	return fabs(value - reference) / fabs(reference);
+}
+
+//Inputs from FLT_MIN to FLT_MAX, about 400 per power of two
+static std::vector<F32> sweepInputs()
+{
+	std::vector<F32> inputs;
+
+	for (F32 x = FLT_MIN; x < FLT_MAX / 1.0017f; x *= 1.0017f) inputs.push_back(x);
+	inputs.push_back(FLT_MIN);
+	inputs.push_back(1.f);
+	inputs.push_back(FLT_MAX);
+
+	return inputs;
+}
+
+static void testRsqrt(const std::vector<F32>& inputs)
+{
+	F64 worst = 0.0, worstInput = 0.0;
+
+	for (F32 x : inputs) {
+		const F64 e = relativeError(Math::rsqrt(x), 1.0 / sqrt(F64(x)));
+		if (e > worst) { worst = e; worstInput = x; }
+	}
+
+	check("Math::rsqrt", worst, worstInput);
+
+#ifdef MATH_SSE2
+	worst = 0.0;
+	worstInput = 0.0;
+
+	for (size_t i = 0; i + 4 <= inputs.size(); i += 4) {
+		F32 out[4];
+		_mm_storeu_ps(out, Math::simd::rsqrt(_mm_loadu_ps(&inputs[i])));
+
+		for (U32 j = 0; j < 4; ++j) {
+			const F64 e = relativeError(out[j], 1.0 / sqrt(F64(inputs[i + j])));
+			if (e > worst) { worst = e; worstInput = inputs[i + j]; }
+		}
+	}
+
+	check("simd::rsqrt", worst, worstInput);
+#endif
+}
+
+//Random value in [-1, 1]
+static F32 randomUnit()
+{
+	return F32(rand()) / RAND_MAX * 2.f - 1.f;
+}
+
+//Lengths from 1e-18 to 1e18, so squared lengths stay normal floats. The input printed for these is the length.
+//Error is relative to the length of the result, as small components can't be more accurate than that
+static void testNormalize(const char* tier)
+{
+	std::vector<Vector3> vectors;
+	std::vector<Quaternion> quaternions;
+	std::vector<F64> lengths;
+
+	srand(1);
+	for (F64 length = 1e-18; length < 1e18; length *= 1.01) {
+		for (U32 i = 0; i < 4; ++i) {
+			const F32 s = F32(length);
+			vectors.push_back(Vector3(randomUnit() * s, randomUnit() * s, randomUnit() * s));
+			quaternions.push_back(Quaternion(randomUnit() * s, randomUnit() * s, randomUnit() * s, randomUnit() * s));
+			lengths.push_back(length);
+		}
+	}
+
+	std::vector<Vector3> normalizedVectors(vectors);
+	std::vector<Quaternion> normalizedQuaternions(quaternions);
+	Math::normalize(normalizedVectors.data(), U32(normalizedVectors.size()));
+	Math::normalize(normalizedQuaternions.data(), U32(normalizedQuaternions.size()));
+
+	F64 worstVector = 0.0, worstVectorLength = 0.0, worstQuaternion = 0.0, worstQuaternionLength = 0.0;
+
+	for (size_t i = 0; i < vectors.size(); ++i) {
+		const Vector3& v = vectors[i];
+		const Vector3& n = normalizedVectors[i];
+		const F64 inv = 1.0 / sqrt(F64(v.x) * v.x + F64(v.y) * v.y + F64(v.z) * v.z);
+
+		const F64 e = fmax(fabs(n.x - v.x * inv), fmax(fabs(n.y - v.y * inv), fabs(n.z - v.z * inv)));
+		if (e > worstVector) { worstVector = e; worstVectorLength = lengths[i]; }
+
+		const Quaternion& q = quaternions[i];
+		const Quaternion& r = normalizedQuaternions[i];
+		const F64 qInv = 1.0 / sqrt(F64(q.x) * q.x + F64(q.y) * q.y + F64(q.z) * q.z + F64(q.w) * q.w);
+
+		const F64 qe = fmax(fmax(fabs(r.x - q.x * qInv), fabs(r.y - q.y * qInv)), fmax(fabs(r.z - q.z * qInv), fabs(r.w - q.w * qInv)));
+		if (qe > worstQuaternion) { worstQuaternion = qe; worstQuaternionLength = lengths[i]; }
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s vec3Normalize", tier);
+	check(name, worstVector, worstVectorLength);
+	snprintf(name, sizeof(name), "%s quatNormalize", tier);
+	check(name, worstQuaternion, worstQuaternionLength);
+}
+
+U32 rsqrtTests()
+{
+	using namespace Math::dispatch;
+
+	const std::vector<F32> inputs = sweepInputs();
+	testRsqrt(inputs);
+
+	for (U32 t = SCALAR; t <= U32(detectedTier()); ++t) {
+		setTier(Tier(t));
+		testNormalize(tierName(Tier(t)));
+	}
+
+	return failures;
+}